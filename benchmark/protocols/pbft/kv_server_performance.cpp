@@ -25,6 +25,7 @@
 
 #include <glog/logging.h>
 
+#include "benchmark/workload/kv_workload.h"
 #include "chain/state/chain_state.h"
 #include "executor/kv/kv_executor.h"
 #include "platform/config/resdb_config_utils.h"
@@ -36,13 +37,9 @@
 using namespace resdb;
 
 void ShowUsage() {
-  printf("<config> <private_key> <cert_file> [logging_dir]\n");
-}
-
-std::string GetRandomKey() {
-  int num1 = rand() % 10;
-  int num2 = rand() % 10;
-  return std::to_string(num1) + std::to_string(num2);
+  printf(
+      "<config> <private_key> <cert_file> [prometheus_address] "
+      "[workload_config]\n");
 }
 
 int main(int argc, char** argv) {
@@ -58,27 +55,27 @@ int main(int argc, char** argv) {
   char* private_key_file = argv[2];
   char* cert_file = argv[3];
 
-  if (argc >= 5) {
+  std::unique_ptr<ResDBConfig> config =
+      GenerateResDBConfig(config_file, private_key_file, cert_file);
+
+  if (argc >= 5 && argv[4][0] != '\0') {
     auto monitor_port = Stats::GetGlobalStats(5);
-    monitor_port->SetPrometheus(argv[4]);
+    monitor_port->SetPrometheus(
+        argv[4], {{"replica", std::to_string(config->GetSelfInfo().id())}});
   }
 
-  std::unique_ptr<ResDBConfig> config =
-      GenerateResDBConfig(config_file, private_key_file, cert_file);
+  std::unique_ptr<KVWorkload> workload =
+      KVWorkload::Create(argc >= 6 ? argv[5] : "");
+  if (workload == nullptr) {
+    exit(1);
+  }
 
   config->RunningPerformance(true);
 
   auto performance_consens = std::make_unique<ConsensusManagerPBFT>(
       *config, std::make_unique<KVExecutor>(std::make_unique<ChainState>()));
-  performance_consens->SetupPerformanceDataFunc([]() {
-    KVRequest request;
-    request.set_cmd(KVRequest::SET);
-    request.set_key(GetRandomKey());
-    request.set_value("helloworld");
-    std::string request_data;
-    request.SerializeToString(&request_data);
-    return request_data;
-  });
+  performance_consens->SetupPerformanceDataFunc(
+      [&workload]() { return workload->NextData(); });
 
   auto server =
       std::make_unique<ServiceNetwork>(*config, std::move(performance_consens));
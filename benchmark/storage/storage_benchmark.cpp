@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "benchmark/storage/storage_benchmark.h"
+
+#include <glog/logging.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace resdb {
+
+namespace {
+
+constexpr uint64_t kDefaultRecordNum = 100000;
+constexpr uint32_t kDefaultKeySize = 16;
+constexpr uint32_t kDefaultValueSize = 100;
+constexpr uint64_t kDefaultGetNum = 100000;
+constexpr uint64_t kDefaultRangeNum = 1000;
+constexpr uint32_t kDefaultRangeLength = 100;
+constexpr uint64_t kDefaultGetAllNum = 3;
+// The prefix of the keys.
+const std::string kKeyPrefix = "key";
+
+uint64_t GetNanoTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+double StorageBenchmark::Result::GetOpsPerSecond() const {
+  return seconds > 0 ? num / seconds : 0;
+}
+
+StorageBenchmark::StorageBenchmark(const StorageBenchmarkConfig& config)
+    : config_(config), gen_(config.seed()) {
+  if (config_.record_num() == 0) {
+    config_.set_record_num(kDefaultRecordNum);
+  }
+  if (config_.key_size() == 0) {
+    config_.set_key_size(kDefaultKeySize);
+  }
+  // Every key has the same size so that they sort in the order of the ids.
+  uint32_t min_key_size =
+      kKeyPrefix.size() + std::to_string(config_.record_num() - 1).size();
+  config_.set_key_size(std::max(config_.key_size(), min_key_size));
+  if (config_.value_size() == 0) {
+    config_.set_value_size(kDefaultValueSize);
+  }
+  if (config_.get_num() == 0) {
+    config_.set_get_num(kDefaultGetNum);
+  }
+  if (config_.range_num() == 0) {
+    config_.set_range_num(kDefaultRangeNum);
+  }
+  if (config_.range_length() == 0) {
+    config_.set_range_length(kDefaultRangeLength);
+  }
+  config_.set_range_length(
+      std::min<uint64_t>(config_.range_length(), config_.record_num()));
+  if (config_.get_all_num() == 0) {
+    config_.set_get_all_num(kDefaultGetAllNum);
+  }
+
+  // Twice the value size so that the values start anywhere in the first
+  // half.
+  value_data_.resize(2 * config_.value_size());
+  for (char& c : value_data_) {
+    c = 'a' + gen_() % 26;
+  }
+}
+
+std::unique_ptr<StorageBenchmark> StorageBenchmark::Create(
+    const std::string& config_file) {
+  StorageBenchmarkConfig config;
+  if (!config_file.empty()) {
+    std::stringstream json_data;
+    std::ifstream infile(config_file.c_str());
+    json_data << infile.rdbuf();
+    auto status =
+        google::protobuf::util::JsonStringToMessage(json_data.str(), &config);
+    if (!status.ok()) {
+      LOG(ERROR) << "parse storage benchmark :" << config_file
+                 << " fail:" << status.message();
+      return nullptr;
+    }
+  }
+  return std::make_unique<StorageBenchmark>(config);
+}
+
+const StorageBenchmarkConfig& StorageBenchmark::GetConfig() const {
+  return config_;
+}
+
+std::string StorageBenchmark::GetKey(uint64_t id) const {
+  std::string key = std::to_string(id);
+  size_t size = kKeyPrefix.size() + key.size();
+  return kKeyPrefix +
+         std::string(config_.key_size() > size ? config_.key_size() - size : 0,
+                     '0') +
+         key;
+}
+
+std::string StorageBenchmark::GetValue() {
+  return value_data_.substr(gen_() % (config_.value_size() + 1),
+                            config_.value_size());
+}
+
+std::vector<StorageBenchmark::Result> StorageBenchmark::Run(Storage* storage) {
+  return RunPhases(storage, [storage]() { storage->Flush(); });
+}
+
+std::vector<StorageBenchmark::Result> StorageBenchmark::Run(
+    ChainState* state) {
+  return RunPhases(state, []() {});
+}
+
+template <typename DB>
+std::vector<StorageBenchmark::Result> StorageBenchmark::RunPhases(
+    DB* db, const std::function<void()>& flush) {
+  std::vector<Result> results;
+  // Run num calls of func and time each of them.
+  auto run_phase = [&](const std::string& name, uint64_t num,
+                       const std::function<void()>& func,
+                       const std::function<void()>& done) {
+    LatencyHistogram latency;
+    uint64_t start_time = GetNanoTime();
+    for (uint64_t i = 0; i < num; ++i) {
+      uint64_t call_time = GetNanoTime();
+      func();
+      latency.Record(GetNanoTime() - call_time);
+    }
+    done();
+
+    Result result;
+    result.name = name;
+    result.num = num;
+    result.seconds = (GetNanoTime() - start_time) / 1e9;
+    result.latency = latency.GetSnapshot();
+    results.push_back(std::move(result));
+  };
+
+  std::vector<uint64_t> ids(config_.record_num());
+  std::iota(ids.begin(), ids.end(), 0);
+  std::shuffle(ids.begin(), ids.end(), gen_);
+  // Generate the records before the phase so that only the storage is
+  // timed.
+  std::vector<std::pair<std::string, std::string>> records;
+  records.reserve(ids.size());
+  for (uint64_t id : ids) {
+    records.push_back(std::make_pair(GetKey(id), GetValue()));
+  }
+  ids.clear();
+  ids.shrink_to_fit();
+
+  auto record = records.begin();
+  run_phase(
+      "set", records.size(),
+      [&]() {
+        if (db->SetValue(record->first, record->second) < 0) {
+          LOG(ERROR) << "set value fail, key:" << record->first;
+        }
+        ++record;
+      },
+      flush);
+  records.clear();
+  records.shrink_to_fit();
+
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < config_.get_num(); ++i) {
+    keys.push_back(GetKey(gen_() % config_.record_num()));
+  }
+  auto key = keys.begin();
+  run_phase(
+      "get", keys.size(),
+      [&]() {
+        if (db->GetValue(*key).empty()) {
+          LOG(ERROR) << "get value fail, key:" << *key;
+        }
+        ++key;
+      },
+      []() {});
+
+  uint64_t range_start_num = config_.record_num() - config_.range_length() + 1;
+  std::vector<std::pair<std::string, std::string>> ranges;
+  for (uint64_t i = 0; i < config_.range_num(); ++i) {
+    uint64_t start = gen_() % range_start_num;
+    ranges.push_back(std::make_pair(
+        GetKey(start), GetKey(start + config_.range_length() - 1)));
+  }
+  auto range = ranges.begin();
+  run_phase(
+      "get_range", ranges.size(),
+      [&]() {
+        db->GetRange(range->first, range->second);
+        ++range;
+      },
+      []() {});
+
+  run_phase(
+      "get_all", config_.get_all_num(), [&]() { db->GetAllValues(); },
+      []() {});
+  return results;
+}
+
+}  // namespace resdb
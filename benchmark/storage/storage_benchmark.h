@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/storage/storage_benchmark.pb.h"
+#include "chain/state/chain_state.h"
+#include "chain/storage/storage.h"
+#include "platform/statistic/latency_histogram.h"
+
+namespace resdb {
+
+// StorageBenchmark measures a storage alone, without the consensus, in
+// phases:
+//   set:       SetValue of record_num records in a random order, then Flush.
+//   get:       GetValue of get_num random records.
+//   get_range: GetRange of range_num random runs of range_length records.
+//   get_all:   GetAllValues, get_all_num times.
+class StorageBenchmark {
+ public:
+  struct Result {
+    std::string name;
+    uint64_t num = 0;
+    // The time of the whole phase, including the flush of the set phase.
+    double seconds = 0;
+    // The time of each call in nanoseconds.
+    LatencyHistogram::Snapshot latency;
+
+    double GetOpsPerSecond() const;
+  };
+
+  explicit StorageBenchmark(
+      const StorageBenchmarkConfig& config = StorageBenchmarkConfig());
+
+  // Read the config from a json file. An empty path uses the defaults.
+  // Return nullptr if the file can not be parsed.
+  static std::unique_ptr<StorageBenchmark> Create(
+      const std::string& config_file);
+
+  // The key of the record id, at least key_size bytes. The keys sort in the
+  // order of the ids.
+  std::string GetKey(uint64_t id) const;
+
+  // Run the phases on an empty storage.
+  std::vector<Result> Run(Storage* storage);
+  // Run the phases on the in-memory map of a ChainState without storage,
+  // including its Merkle tree updates.
+  std::vector<Result> Run(ChainState* state);
+
+  const StorageBenchmarkConfig& GetConfig() const;
+
+ private:
+  template <typename DB>
+  std::vector<Result> RunPhases(DB* db, const std::function<void()>& flush);
+  std::string GetValue();
+
+ private:
+  StorageBenchmarkConfig config_;
+  std::mt19937_64 gen_;
+  // Values are cut from it.
+  std::string value_data_;
+};
+
+}  // namespace resdb
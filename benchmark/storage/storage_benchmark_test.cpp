@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "benchmark/storage/storage_benchmark.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "chain/storage/mock_storage.h"
+
+namespace resdb {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+StorageBenchmarkConfig GetConfig() {
+  StorageBenchmarkConfig config;
+  config.set_record_num(200);
+  config.set_value_size(10);
+  config.set_get_num(50);
+  config.set_range_num(20);
+  config.set_range_length(5);
+  config.set_get_all_num(2);
+  return config;
+}
+
+TEST(StorageBenchmarkTest, Keys) {
+  StorageBenchmark benchmark(GetConfig());
+  EXPECT_EQ(benchmark.GetKey(7), "key0000000000007");
+  EXPECT_LT(benchmark.GetKey(9), benchmark.GetKey(10));
+
+  // The keys grow to fit the ids of all the records.
+  StorageBenchmarkConfig config = GetConfig();
+  config.set_key_size(1);
+  StorageBenchmark short_key_benchmark(config);
+  EXPECT_EQ(short_key_benchmark.GetConfig().key_size(), 6);
+  EXPECT_EQ(short_key_benchmark.GetKey(7), "key007");
+}
+
+TEST(StorageBenchmarkTest, RunStorage) {
+  StorageBenchmark benchmark(GetConfig());
+  MockStorage storage;
+  EXPECT_CALL(storage, SetValue(_, _)).Times(200).WillRepeatedly(Return(0));
+  EXPECT_CALL(storage, Flush).Times(1).WillOnce(Return(true));
+  EXPECT_CALL(storage, GetValue).Times(50).WillRepeatedly(Return("value"));
+  EXPECT_CALL(storage, GetRange)
+      .Times(20)
+      .WillRepeatedly([&](const std::string& min_key,
+                          const std::string& max_key) {
+        EXPECT_LT(min_key, max_key);
+        EXPECT_LE(max_key, benchmark.GetKey(199));
+        return "[]";
+      });
+  EXPECT_CALL(storage, GetAllValues).Times(2).WillRepeatedly(Return("[]"));
+
+  std::vector<StorageBenchmark::Result> results = benchmark.Run(&storage);
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_EQ(results[0].name, "set");
+  EXPECT_EQ(results[0].num, 200);
+  EXPECT_EQ(results[0].latency.count, 200);
+  EXPECT_EQ(results[1].name, "get");
+  EXPECT_EQ(results[1].num, 50);
+  EXPECT_EQ(results[2].name, "get_range");
+  EXPECT_EQ(results[2].num, 20);
+  EXPECT_EQ(results[3].name, "get_all");
+  EXPECT_EQ(results[3].num, 2);
+}
+
+TEST(StorageBenchmarkTest, RunChainState) {
+  StorageBenchmark benchmark(GetConfig());
+  ChainState state;
+  std::vector<StorageBenchmark::Result> results = benchmark.Run(&state);
+  ASSERT_EQ(results.size(), 4);
+  for (const StorageBenchmark::Result& result : results) {
+    EXPECT_GT(result.GetOpsPerSecond(), 0);
+  }
+  EXPECT_EQ(state.GetValue(benchmark.GetKey(0)).size(), 10);
+  EXPECT_EQ(state.GetValue(benchmark.GetKey(199)).size(), 10);
+  EXPECT_EQ(state.GetValue(benchmark.GetKey(200)), "");
+}
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <glog/logging.h>
+
+#include <filesystem>
+
+#include "benchmark/storage/storage_benchmark.h"
+#include "chain/storage/res_leveldb.h"
+#ifdef ENABLE_ROCKSDB
+#include "chain/storage/res_rocksdb.h"
+#endif
+
+using namespace resdb;
+
+void ShowUsage() { printf("<leveldb|rocksdb|memory> [benchmark_config]\n"); }
+
+// Return the path of the db, which must not hold other data.
+std::string GetPath(const std::string& engine, const std::string& path) {
+  if (path.empty()) {
+    std::string default_path = "/tmp/storage_benchmark_" + engine;
+    std::filesystem::remove_all(default_path);
+    return default_path;
+  }
+  if (std::filesystem::exists(path)) {
+    return "";
+  }
+  return path;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    ShowUsage();
+    exit(0);
+  }
+
+  std::string engine = argv[1];
+  std::unique_ptr<StorageBenchmark> benchmark =
+      StorageBenchmark::Create(argc >= 3 ? argv[2] : "");
+  if (benchmark == nullptr) {
+    exit(1);
+  }
+  StorageBenchmarkConfig config = benchmark->GetConfig();
+
+  std::vector<StorageBenchmark::Result> results;
+  std::string path;
+  if (engine == "memory") {
+    ChainState state;
+    results = benchmark->Run(&state);
+  } else if (engine == "leveldb") {
+    path = GetPath(engine, config.leveldb_info().path());
+    if (path.empty()) {
+      LOG(ERROR) << "path exists:" << config.leveldb_info().path();
+      exit(1);
+    }
+    ResConfigData config_data;
+    *config_data.mutable_leveldb_info() = config.leveldb_info();
+    config_data.mutable_leveldb_info()->set_path(path);
+    results = benchmark->Run(NewResLevelDB(nullptr, config_data).get());
+  } else if (engine == "rocksdb") {
+#ifdef ENABLE_ROCKSDB
+    path = GetPath(engine, config.rocksdb_info().path());
+    if (path.empty()) {
+      LOG(ERROR) << "path exists:" << config.rocksdb_info().path();
+      exit(1);
+    }
+    ResConfigData config_data;
+    *config_data.mutable_rocksdb_info() = config.rocksdb_info();
+    config_data.mutable_rocksdb_info()->set_path(path);
+    results = benchmark->Run(NewResRocksDB(nullptr, config_data).get());
+#else
+    LOG(ERROR) << "build with --define enable_rocksdb=True to run rocksdb";
+    exit(1);
+#endif
+  } else {
+    ShowUsage();
+    exit(1);
+  }
+  if (!path.empty()) {
+    std::filesystem::remove_all(path);
+  }
+
+  printf("engine:%s config:%s\n", engine.c_str(),
+         config.ShortDebugString().c_str());
+  for (const StorageBenchmark::Result& result : results) {
+    // The latencies are recorded in nanoseconds.
+    printf(
+        "%s latency(us) num:%lu mean:%.3f p50:%.3f p90:%.3f p99:%.3f "
+        "p999:%.3f ops/s:%.1f\n",
+        result.name.c_str(), result.num, result.latency.GetMean() / 1e3,
+        result.latency.GetPercentile(50) / 1e3,
+        result.latency.GetPercentile(90) / 1e3,
+        result.latency.GetPercentile(99) / 1e3,
+        result.latency.GetPercentile(99.9) / 1e3, result.GetOpsPerSecond());
+  }
+}
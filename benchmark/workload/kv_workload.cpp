@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "benchmark/workload/kv_workload.h"
+
+#include <glog/logging.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace resdb {
+
+namespace {
+
+constexpr uint64_t kDefaultRecordCount = 1000;
+constexpr double kDefaultZipfianConstant = 0.99;
+constexpr uint32_t kDefaultValueSize = 100;
+constexpr uint32_t kDefaultMaxScanLength = 100;
+
+// FNV-1a, to spread the popular zipfian ranks over the key space.
+uint64_t Hash(uint64_t value) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (int i = 0; i < 8; ++i) {
+    hash ^= value & 0xff;
+    hash *= 0x100000001b3ULL;
+    value >>= 8;
+  }
+  return hash;
+}
+
+}  // namespace
+
+KVWorkload::KVWorkload(const KVWorkloadConfig& config)
+    : config_(config), gen_(config.seed()) {
+  if (config_.read_proportion() + config_.update_proportion() +
+          config_.insert_proportion() + config_.scan_proportion() <=
+      0) {
+    config_.set_read_proportion(0.5);
+    config_.set_update_proportion(0.5);
+  }
+  if (config_.record_count() == 0) {
+    config_.set_record_count(kDefaultRecordCount);
+  }
+  if (config_.zipfian_constant() <= 0 || config_.zipfian_constant() >= 1) {
+    config_.set_zipfian_constant(kDefaultZipfianConstant);
+  }
+  if (config_.min_value_size() == 0) {
+    config_.set_min_value_size(kDefaultValueSize);
+  }
+  if (config_.max_value_size() < config_.min_value_size()) {
+    config_.set_max_value_size(config_.min_value_size());
+  }
+  if (config_.max_scan_length() == 0) {
+    config_.set_max_scan_length(kDefaultMaxScanLength);
+  }
+
+  if (config_.skip_load()) {
+    record_num_ = config_.record_count();
+  }
+  if (config_.request_distribution() != KVWorkloadConfig::UNIFORM) {
+    record_zipfian_ = std::make_unique<ZipfianGenerator>(
+        config_.record_count(), config_.zipfian_constant());
+  }
+  if (config_.value_size_distribution() == KVWorkloadConfig::ZIPFIAN_SIZE) {
+    value_size_zipfian_ = std::make_unique<ZipfianGenerator>(
+        config_.max_value_size() - config_.min_value_size() + 1,
+        config_.zipfian_constant());
+  }
+
+  // Twice the max value size so that the values start anywhere in the
+  // first half.
+  value_data_.resize(2 * config_.max_value_size());
+  for (char& c : value_data_) {
+    c = 'a' + gen_() % 26;
+  }
+}
+
+std::unique_ptr<KVWorkload> KVWorkload::Create(
+    const std::string& config_file) {
+  KVWorkloadConfig config;
+  if (!config_file.empty()) {
+    std::stringstream json_data;
+    std::ifstream infile(config_file.c_str());
+    json_data << infile.rdbuf();
+    auto status =
+        google::protobuf::util::JsonStringToMessage(json_data.str(), &config);
+    if (!status.ok()) {
+      LOG(ERROR) << "parse workload :" << config_file
+                 << " fail:" << status.message();
+      return nullptr;
+    }
+  }
+  auto workload = std::make_unique<KVWorkload>(config);
+  LOG(INFO) << "kv workload:" << workload->GetConfig().DebugString();
+  return workload;
+}
+
+std::string KVWorkload::GetKey(uint64_t id) {
+  std::string key = std::to_string(id);
+  return "user" + std::string(key.size() < 12 ? 12 - key.size() : 0, '0') +
+         key;
+}
+
+const KVWorkloadConfig& KVWorkload::GetConfig() const { return config_; }
+
+double KVWorkload::NextUniform() {
+  return std::uniform_real_distribution<double>(0, 1)(gen_);
+}
+
+KVRequest::CMD KVWorkload::NextCmd() {
+  double total = config_.read_proportion() + config_.update_proportion() +
+                 config_.insert_proportion() + config_.scan_proportion();
+  double u = NextUniform() * total;
+  if ((u -= config_.read_proportion()) < 0) {
+    return KVRequest::GET;
+  }
+  if ((u -= config_.update_proportion()) < 0) {
+    return KVRequest::SET;
+  }
+  if ((u -= config_.insert_proportion()) < 0) {
+    return KVRequest::NONE;
+  }
+  return KVRequest::GETRANGE;
+}
+
+uint64_t KVWorkload::NextRecord() {
+  switch (config_.request_distribution()) {
+    case KVWorkloadConfig::ZIPFIAN:
+      return Hash(record_zipfian_->Next(NextUniform())) % record_num_;
+    case KVWorkloadConfig::LATEST:
+      record_zipfian_->SetItemNum(record_num_);
+      return record_num_ - 1 - record_zipfian_->Next(NextUniform());
+    default:
+      return gen_() % record_num_;
+  }
+}
+
+std::string KVWorkload::NextValue() {
+  uint32_t size = config_.min_value_size();
+  uint32_t range = config_.max_value_size() - config_.min_value_size() + 1;
+  if (config_.value_size_distribution() == KVWorkloadConfig::UNIFORM_SIZE) {
+    size += gen_() % range;
+  } else if (value_size_zipfian_) {
+    size += value_size_zipfian_->Next(NextUniform());
+  }
+  return value_data_.substr(gen_() % config_.max_value_size(), size);
+}
+
+KVRequest KVWorkload::Next() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  KVRequest request;
+  // Load the records first.
+  KVRequest::CMD cmd = KVRequest::NONE;
+  if (record_num_ >= config_.record_count()) {
+    cmd = NextCmd();
+  }
+  if (cmd == KVRequest::NONE) {
+    request.set_cmd(KVRequest::SET);
+    request.set_key(GetKey(record_num_++));
+    request.set_value(NextValue());
+    return request;
+  }
+
+  uint64_t record = NextRecord();
+  request.set_cmd(cmd);
+  request.set_key(GetKey(record));
+  if (cmd == KVRequest::SET) {
+    request.set_value(NextValue());
+  } else if (cmd == KVRequest::GETRANGE) {
+    uint64_t length = 1 + gen_() % config_.max_scan_length();
+    request.set_value(GetKey(record + length - 1));
+  }
+  return request;
+}
+
+std::string KVWorkload::NextData() {
+  std::string data;
+  Next().SerializeToString(&data);
+  return data;
+}
+
+}  // namespace resdb
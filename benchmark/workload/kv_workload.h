@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "benchmark/workload/kv_workload.pb.h"
+#include "benchmark/workload/zipfian_generator.h"
+#include "proto/kv/kv.pb.h"
+
+namespace resdb {
+
+// KVWorkload generates the KV requests of a YCSB-style workload for the
+// performance data func: it first inserts record_count records, then
+// reads, updates, inserts and scans records picked by the request
+// distribution.
+class KVWorkload {
+ public:
+  explicit KVWorkload(const KVWorkloadConfig& config = KVWorkloadConfig());
+
+  // Read the config from a json file. An empty path uses the defaults.
+  // Return nullptr if the file can not be parsed.
+  static std::unique_ptr<KVWorkload> Create(const std::string& config_file);
+
+  // The key of the record id. The keys sort in the order of the ids.
+  static std::string GetKey(uint64_t id);
+
+  // Thread safe.
+  KVRequest Next();
+  // Next() serialized, which is the data of a performance request.
+  std::string NextData();
+
+  const KVWorkloadConfig& GetConfig() const;
+
+ private:
+  // Return NONE for an insert.
+  KVRequest::CMD NextCmd();
+  uint64_t NextRecord();
+  std::string NextValue();
+  double NextUniform();
+
+ private:
+  KVWorkloadConfig config_;
+  std::mutex mutex_;
+  std::mt19937_64 gen_;
+  // The number of records inserted by the load and the inserts.
+  uint64_t record_num_ = 0;
+  std::unique_ptr<ZipfianGenerator> record_zipfian_, value_size_zipfian_;
+  // Values are cut from it.
+  std::string value_data_;
+};
+
+}  // namespace resdb
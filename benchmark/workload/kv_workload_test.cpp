@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "benchmark/workload/kv_workload.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+namespace resdb {
+namespace {
+
+TEST(KVWorkloadTest, LoadRecordsFirst) {
+  KVWorkloadConfig config;
+  config.set_record_count(10);
+  config.set_read_proportion(1);
+  KVWorkload workload(config);
+
+  for (int i = 0; i < 10; ++i) {
+    KVRequest request = workload.Next();
+    EXPECT_EQ(request.cmd(), KVRequest::SET);
+    EXPECT_EQ(request.key(), KVWorkload::GetKey(i));
+    EXPECT_EQ(request.value().size(), 100);
+  }
+  for (int i = 0; i < 100; ++i) {
+    KVRequest request = workload.Next();
+    EXPECT_EQ(request.cmd(), KVRequest::GET);
+    EXPECT_LT(request.key(), KVWorkload::GetKey(10));
+  }
+}
+
+TEST(KVWorkloadTest, InsertAndScan) {
+  KVWorkloadConfig config;
+  config.set_record_count(10);
+  config.set_skip_load(true);
+  config.set_insert_proportion(1);
+  config.set_scan_proportion(1);
+  config.set_max_scan_length(5);
+  config.set_value_size_distribution(KVWorkloadConfig::UNIFORM_SIZE);
+  config.set_min_value_size(10);
+  config.set_max_value_size(20);
+  KVWorkload workload(config);
+
+  int insert_num = 0, scan_num = 0;
+  for (int i = 0; i < 1000; ++i) {
+    KVRequest request = workload.Next();
+    if (request.cmd() == KVRequest::SET) {
+      EXPECT_EQ(request.key(), KVWorkload::GetKey(10 + insert_num));
+      EXPECT_GE(request.value().size(), 10);
+      EXPECT_LE(request.value().size(), 20);
+      insert_num++;
+    } else {
+      ASSERT_EQ(request.cmd(), KVRequest::GETRANGE);
+      EXPECT_LE(request.key(), request.value());
+      uint64_t min_id = std::stoull(request.key().substr(4));
+      uint64_t max_id = std::stoull(request.value().substr(4));
+      EXPECT_LT(max_id - min_id, 5);
+      EXPECT_LT(min_id, 10 + insert_num);
+      scan_num++;
+    }
+  }
+  EXPECT_GT(insert_num, 400);
+  EXPECT_GT(scan_num, 400);
+}
+
+TEST(KVWorkloadTest, Distributions) {
+  KVWorkloadConfig config;
+  config.set_record_count(1000);
+  config.set_skip_load(true);
+  config.set_read_proportion(1);
+
+  auto get_max_count = [&](KVWorkloadConfig::Distribution distribution,
+                           uint64_t* max_record) {
+    config.set_request_distribution(distribution);
+    KVWorkload workload(config);
+    std::map<std::string, int> count;
+    for (int i = 0; i < 10000; ++i) {
+      count[workload.Next().key()]++;
+    }
+    int max_count = 0;
+    for (auto& it : count) {
+      if (it.second > max_count) {
+        max_count = it.second;
+        *max_record = std::stoull(it.first.substr(4));
+      }
+    }
+    return max_count;
+  };
+
+  uint64_t max_record = 0;
+  // About 10 for each record.
+  EXPECT_LT(get_max_count(KVWorkloadConfig::UNIFORM, &max_record), 40);
+  // About 1 / zeta(1000, 0.99) of the requests go to the hottest record.
+  EXPECT_GT(get_max_count(KVWorkloadConfig::ZIPFIAN, &max_record), 1000);
+  EXPECT_GT(get_max_count(KVWorkloadConfig::LATEST, &max_record), 1000);
+  EXPECT_EQ(max_record, 999);
+}
+
+TEST(ZipfianGeneratorTest, GrowItems) {
+  ZipfianGenerator zipfian(10, 0.99);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_LT(zipfian.Next(i / 100.0), 10);
+  }
+  EXPECT_EQ(zipfian.Next(0), 0);
+  zipfian.SetItemNum(100);
+  EXPECT_EQ(zipfian.GetItemNum(), 100);
+  EXPECT_EQ(zipfian.Next(0.999999), 99);
+}
+
+}  // namespace
+}  // namespace resdb
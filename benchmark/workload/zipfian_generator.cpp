@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "benchmark/workload/zipfian_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace resdb {
+
+namespace {
+
+// The sum of 1 / i^theta for i in (from, to].
+double Zeta(uint64_t from, uint64_t to, double theta) {
+  double sum = 0;
+  for (uint64_t i = from + 1; i <= to; ++i) {
+    sum += 1 / std::pow(static_cast<double>(i), theta);
+  }
+  return sum;
+}
+
+}  // namespace
+
+ZipfianGenerator::ZipfianGenerator(uint64_t n, double theta)
+    : n_(std::max<uint64_t>(n, 1)),
+      theta_(theta),
+      alpha_(1 / (1 - theta)),
+      zeta2_(Zeta(0, 2, theta)),
+      zetan_(Zeta(0, n_, theta)) {
+  UpdateEta();
+}
+
+void ZipfianGenerator::UpdateEta() {
+  eta_ = (1 - std::pow(2.0 / n_, 1 - theta_)) / (1 - zeta2_ / zetan_);
+}
+
+uint64_t ZipfianGenerator::Next(double u) const {
+  double uz = u * zetan_;
+  if (uz < 1) {
+    return 0;
+  }
+  if (n_ > 1 && uz < 1 + std::pow(0.5, theta_)) {
+    return 1;
+  }
+  uint64_t rank = n_ * std::pow(eta_ * u - eta_ + 1, alpha_);
+  return std::min(rank, n_ - 1);
+}
+
+void ZipfianGenerator::SetItemNum(uint64_t n) {
+  if (n <= n_) {
+    return;
+  }
+  zetan_ += Zeta(n_, n, theta_);
+  n_ = n;
+  UpdateEta();
+}
+
+uint64_t ZipfianGenerator::GetItemNum() const { return n_; }
+
+}  // namespace resdb
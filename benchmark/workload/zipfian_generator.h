@@ -25,52 +25,32 @@
 
 #pragma once
 
-#include <iostream>
-#include <mutex>
-#include <set>
+#include <cstdint>
 
 namespace resdb {
 
-template <class _type>
-class SpinLockSet {
+// ZipfianGenerator draws ranks in [0, n) where rank i has a probability
+// proportional to 1 / (i + 1)^theta, using the method of Gray et al.,
+// "Quickly Generating Billion-Record Synthetic Databases", as YCSB does.
+// Rank 0 is the most popular one.
+class ZipfianGenerator {
  public:
-  SpinLockSet(){};
-  ~SpinLockSet() { set_.clear(); }
+  // theta must be in (0, 1). It takes O(n) to set up.
+  ZipfianGenerator(uint64_t n, double theta);
 
-  int exists(_type key) {
-    bool result = false;
-    lock_.lock();
-    result = set_.count(key);
-    lock_.unlock();
-    return result;
-  }
-  void add(_type key) {
-    lock_.lock();
-    set_.insert(key);
-    lock_.unlock();
-  };
-  int check_and_add(_type key) {
-    bool result = false;
-    lock_.lock();
-    result = set_.count(key);
-    set_.insert(key);
-    lock_.unlock();
-    return result;
-  }
-  int remove(_type key) {
-    lock_.lock();
+  // Map u, uniformly drawn from [0, 1), to a rank.
+  uint64_t Next(double u) const;
 
-    int result = set_.erase(key);
+  // Grow the number of ranks. It takes O(new ranks).
+  void SetItemNum(uint64_t n);
+  uint64_t GetItemNum() const;
 
-    lock_.unlock();
-    return result;
-  }
-
-  int size() { return set_.size(); }
+ private:
+  void UpdateEta();
 
  private:
-  std::set<_type> set_;
-  std::mutex lock_;
+  uint64_t n_;
+  double theta_, alpha_, zeta2_, zetan_, eta_;
 };
 
-}  // namespace resdb
\ No newline at end of file
+}  // namespace resdb
@@ -27,20 +27,104 @@
 
 #include <glog/logging.h>
 
+#include <limits>
+
 namespace resdb {
 
+namespace {
+
+// Reads without a snapshot see the latest version.
+constexpr uint64_t kLatestVersion = std::numeric_limits<uint64_t>::max();
+
+}  // namespace
+
+ChainState::Snapshot::Snapshot(
+    ChainState* state, uint64_t seq, uint64_t version,
+    std::unique_ptr<Storage::Snapshot> storage_snapshot)
+    : state_(state),
+      seq_(seq),
+      version_(version),
+      storage_snapshot_(std::move(storage_snapshot)) {}
+
+ChainState::Snapshot::~Snapshot() {
+  if (storage_snapshot_ == nullptr) {
+    state_->ReleaseSnapshot(version_);
+  }
+}
+
+uint64_t ChainState::Snapshot::GetSeq() const { return seq_; }
+
+std::string ChainState::Snapshot::GetValue(const std::string& key) {
+  if (storage_snapshot_) {
+    return storage_snapshot_->GetValue(key);
+  }
+  return state_->GetValue(key, version_);
+}
+
+std::string ChainState::Snapshot::GetAllValues(void) {
+  if (storage_snapshot_) {
+    return storage_snapshot_->GetAllValues();
+  }
+  return state_->GetAllValues(version_);
+}
+
+std::string ChainState::Snapshot::GetRange(const std::string& min_key,
+                                           const std::string& max_key) {
+  if (storage_snapshot_) {
+    return storage_snapshot_->GetRange(min_key, max_key);
+  }
+  return state_->GetRange(min_key, max_key, version_);
+}
+
 ChainState::ChainState(std::unique_ptr<Storage> storage)
-    : storage_(std::move(storage)) {}
+    : storage_(std::move(storage)) {
+  if (storage_) {
+    if (storage_->ForEachValue(
+            [&](const std::string& key, const std::string& value) {
+              merkle_tree_.Update(key, value);
+            }) < 0) {
+      LOG(ERROR) << "fail to rebuild the state merkle tree from the storage";
+    }
+  }
+}
 
 Storage* ChainState::GetStorage() {
   return storage_ ? storage_.get() : nullptr;
 }
 
 int ChainState::SetValue(const std::string& key, const std::string& value) {
+  std::lock_guard<std::mutex> write_lk(write_mutex_);
   if (storage_) {
-    return storage_->SetValue(key, value);
+    int ret = storage_->SetValue(key, value);
+    if (ret >= 0) {
+      merkle_tree_.Update(key, value);
+    }
+    return ret;
+  }
+  merkle_tree_.Update(key, value);
+  // Values set before the next commit belong to the next version.
+  uint64_t version = commit_version_ + 1;
+  std::optional<uint64_t> min_snapshot_version = GetMinSnapshotVersion();
+
+  std::unique_lock<std::shared_mutex> lk(kv_mutex_);
+  std::vector<Version>& versions = kv_map_[key];
+  if (!versions.empty() && versions.back().version == version) {
+    versions.back().value = value;
+    return 0;
+  }
+
+  // Drop the versions that are not visible to any snapshot.
+  if (!min_snapshot_version.has_value()) {
+    versions.clear();
+  } else {
+    size_t first = 0;
+    while (first + 1 < versions.size() &&
+           versions[first + 1].version <= *min_snapshot_version) {
+      ++first;
+    }
+    versions.erase(versions.begin(), versions.begin() + first);
   }
-  kv_map_[key] = value;
+  versions.push_back(Version{version, value});
   return 0;
 }
 
@@ -48,45 +132,189 @@ std::string ChainState::GetValue(const std::string& key) {
   if (storage_) {
     return storage_->GetValue(key);
   }
-  auto search = kv_map_.find(key);
-  if (search != kv_map_.end())
-    return search->second;
-  else {
-    return "";
-  }
+  return GetValue(key, kLatestVersion);
 }
 
 std::string ChainState::GetAllValues(void) {
   if (storage_) {
     return storage_->GetAllValues();
   }
+  return GetAllValues(kLatestVersion);
+}
+
+std::string ChainState::GetRange(const std::string& min_key,
+                                 const std::string& max_key) {
+  if (storage_) {
+    return storage_->GetRange(min_key, max_key);
+  }
+  return GetRange(min_key, max_key, kLatestVersion);
+}
+
+const ChainState::Version* ChainState::GetVersion(
+    const std::vector<Version>& versions, uint64_t version) {
+  for (auto it = versions.rbegin(); it != versions.rend(); ++it) {
+    if (it->version <= version) {
+      return &(*it);
+    }
+  }
+  return nullptr;
+}
+
+std::string ChainState::GetValue(const std::string& key, uint64_t version) {
+  std::shared_lock<std::shared_mutex> lk(kv_mutex_);
+  auto search = kv_map_.find(key);
+  if (search == kv_map_.end()) {
+    return "";
+  }
+  const Version* value = GetVersion(search->second, version);
+  return value == nullptr ? "" : value->value;
+}
+
+std::string ChainState::GetAllValues(uint64_t version) {
+  std::shared_lock<std::shared_mutex> lk(kv_mutex_);
   std::string values = "[";
   bool first_iteration = true;
-  for (auto kv : kv_map_) {
+  for (const auto& kv : kv_map_) {
+    const Version* value = GetVersion(kv.second, version);
+    if (value == nullptr) {
+      continue;
+    }
     if (!first_iteration) values.append(",");
     first_iteration = false;
-    values.append(kv.second);
+    values.append(value->value);
   }
   values.append("]");
   return values;
 }
 
 std::string ChainState::GetRange(const std::string& min_key,
-                                 const std::string& max_key) {
-  if (storage_) {
-    return storage_->GetRange(min_key, max_key);
-  }
+                                 const std::string& max_key,
+                                 uint64_t version) {
+  std::shared_lock<std::shared_mutex> lk(kv_mutex_);
   std::string values = "[";
   bool first_iteration = true;
-  for (auto kv : kv_map_) {
+  for (const auto& kv : kv_map_) {
     if (kv.first >= min_key && kv.first <= max_key) {
+      const Version* value = GetVersion(kv.second, version);
+      if (value == nullptr) {
+        continue;
+      }
       if (!first_iteration) values.append(",");
       first_iteration = false;
-      values.append(kv.second);
+      values.append(value->value);
     }
   }
   values.append("]");
   return values;
 }
 
+void ChainState::Commit(uint64_t seq) {
+  std::lock_guard<std::mutex> write_lk(write_mutex_);
+  last_executed_seq_ = seq;
+  ++commit_version_;
+
+  std::unique_ptr<Storage::Snapshot> storage_snapshot;
+  if (storage_) {
+    storage_snapshot = storage_->GetSnapshot();
+    if (storage_snapshot == nullptr) {
+      return;
+    }
+  }
+
+  std::shared_ptr<Snapshot> snapshot(
+      new Snapshot(this, seq, commit_version_, std::move(storage_snapshot)));
+  std::shared_ptr<Snapshot> old_snapshot;
+  {
+    std::unique_lock<std::mutex> lk(snapshot_mutex_);
+    if (!storage_) {
+      snapshot_versions_.insert(commit_version_);
+    }
+    old_snapshot = std::move(snapshot_);
+    snapshot_ = std::move(snapshot);
+  }
+  // old_snapshot is released here, outside the lock.
+}
+
+uint64_t ChainState::GetLastExecutedSeq() { return last_executed_seq_; }
+
+std::shared_ptr<ChainState::Snapshot> ChainState::GetSnapshot() {
+  std::unique_lock<std::mutex> lk(snapshot_mutex_);
+  return snapshot_;
+}
+
+void ChainState::ReleaseSnapshot(uint64_t version) {
+  std::unique_lock<std::mutex> lk(snapshot_mutex_);
+  auto it = snapshot_versions_.find(version);
+  if (it != snapshot_versions_.end()) {
+    snapshot_versions_.erase(it);
+  }
+}
+
+std::string ChainState::GetStateRoot() { return merkle_tree_.GetRoot(); }
+
+std::string ChainState::CheckPointState() {
+  // Hold the writes so that the nodes match the snapshot.
+  std::lock_guard<std::mutex> write_lk(write_mutex_);
+  std::vector<std::string> nodes = merkle_tree_.GetNodes();
+  std::vector<std::shared_ptr<const StateMerkleTree::Leaf>> leaves =
+      merkle_tree_.GetLeaves();
+  std::string root = nodes[1];
+  std::shared_ptr<Snapshot> snapshot = GetSnapshot();
+  std::shared_ptr<Snapshot> old_snapshot;
+  {
+    std::unique_lock<std::mutex> lk(checkpoint_mutex_);
+    checkpoint_nodes_ = std::move(nodes);
+    checkpoint_leaves_ = std::move(leaves);
+    old_snapshot = std::move(checkpoint_snapshot_);
+    checkpoint_snapshot_ = std::move(snapshot);
+  }
+  return root;
+}
+
+uint32_t ChainState::GetStateChunkNum() const {
+  return merkle_tree_.GetLeafNum();
+}
+
+std::vector<std::string> ChainState::GetStateChunkKeys(uint32_t index) {
+  return merkle_tree_.GetKeys(index);
+}
+
+int ChainState::GetStateChunk(uint64_t seq, uint32_t index,
+                              StateMerkleTree::Chunk* chunk) {
+  std::vector<std::string> proof;
+  std::shared_ptr<const StateMerkleTree::Leaf> leaf;
+  std::shared_ptr<Snapshot> snapshot;
+  {
+    std::unique_lock<std::mutex> lk(checkpoint_mutex_);
+    if (checkpoint_snapshot_ == nullptr ||
+        checkpoint_snapshot_->GetSeq() != seq) {
+      return -1;
+    }
+    snapshot = checkpoint_snapshot_;
+    proof = StateMerkleTree::GetProof(checkpoint_nodes_, index);
+    if (proof.empty()) {
+      return -1;
+    }
+    leaf = checkpoint_leaves_[index];
+  }
+
+  // The leaf holds the keys of the checkpoint, all set in the snapshot.
+  chunk->index = index;
+  chunk->kvs.clear();
+  for (const auto& kv : *leaf) {
+    chunk->kvs.push_back(
+        std::make_pair(kv.first, snapshot->GetValue(kv.first)));
+  }
+  chunk->proof = std::move(proof);
+  return 0;
+}
+
+std::optional<uint64_t> ChainState::GetMinSnapshotVersion() {
+  std::unique_lock<std::mutex> lk(snapshot_mutex_);
+  if (snapshot_versions_.empty()) {
+    return std::nullopt;
+  }
+  return *snapshot_versions_.begin();
+}
+
 }  // namespace resdb
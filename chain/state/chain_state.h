@@ -25,15 +25,48 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 
+#include "chain/state/state_merkle_tree.h"
 #include "chain/storage/storage.h"
 
 namespace resdb {
 
 class ChainState {
  public:
+  // A read-only view of the state containing all the values set by the
+  // transactions up to GetSeq(). A snapshot must not outlive its ChainState.
+  class Snapshot {
+   public:
+    ~Snapshot();
+
+    uint64_t GetSeq() const;
+    std::string GetValue(const std::string& key);
+    std::string GetAllValues(void);
+    std::string GetRange(const std::string& min_key,
+                         const std::string& max_key);
+
+   private:
+    friend class ChainState;
+    Snapshot(ChainState* state, uint64_t seq, uint64_t version,
+             std::unique_ptr<Storage::Snapshot> storage_snapshot);
+
+    ChainState* state_;
+    uint64_t seq_;
+    // The commit version read from the in-memory state.
+    uint64_t version_;
+    std::unique_ptr<Storage::Snapshot> storage_snapshot_;
+  };
+
+  // SetValue may be called concurrently by the batches with disjoint keys.
+  // The Merkle tree is rebuilt from the values already in the storage.
   ChainState(std::unique_ptr<Storage> storage = nullptr);
   int SetValue(const std::string& key, const std::string& value);
   std::string GetValue(const std::string& key);
@@ -42,9 +75,80 @@ class ChainState {
 
   Storage* GetStorage();
 
+  // Mark the transactions up to seq as executed and publish a new snapshot
+  // containing all the values set so far, tagged with seq. It is called by
+  // one thread with increasing seqs, once all the batches up to seq are done
+  // and none after seq has started.
+  void Commit(uint64_t seq);
+
+  // Return the last seq passed to Commit.
+  uint64_t GetLastExecutedSeq();
+
+  // Return the latest published snapshot, or nullptr if none has been
+  // published or the storage does not support snapshots.
+  std::shared_ptr<Snapshot> GetSnapshot();
+
+  // Return the Merkle root over the current key-values.
+  std::string GetStateRoot();
+
+  // Keep the state of the latest snapshot for GetStateChunk() and return its
+  // Merkle root.
+  std::string CheckPointState();
+
+  // Return the number of chunks of the state.
+  uint32_t GetStateChunkNum() const;
+
+  // Return the keys of the current state in the chunk `index`.
+  std::vector<std::string> GetStateChunkKeys(uint32_t index);
+
+  // Fill the chunk `index` of the state kept by CheckPointState() at seq,
+  // with its Merkle proof. Return -1 if the state at seq is not kept.
+  int GetStateChunk(uint64_t seq, uint32_t index,
+                    StateMerkleTree::Chunk* chunk);
+
+ private:
+  // Value of a key written before the commit of `version`.
+  struct Version {
+    uint64_t version;
+    std::string value;
+  };
+
+  // Return the latest value visible at version, or nullptr if there is none.
+  const Version* GetVersion(const std::vector<Version>& versions,
+                            uint64_t version);
+  std::string GetValue(const std::string& key, uint64_t version);
+  std::string GetAllValues(uint64_t version);
+  std::string GetRange(const std::string& min_key, const std::string& max_key,
+                       uint64_t version);
+
+  void ReleaseSnapshot(uint64_t version);
+  // Return the smallest version of the in-memory snapshots in use.
+  std::optional<uint64_t> GetMinSnapshotVersion();
+
  private:
   std::unique_ptr<Storage> storage_ = nullptr;
-  std::unordered_map<std::string, std::string> kv_map_;
+  // Versions of each key ordered by version. Old versions are kept only
+  // while a snapshot may still read them.
+  std::unordered_map<std::string, std::vector<Version>> kv_map_;
+  std::shared_mutex kv_mutex_;
+  // Serializes the writes and the commits.
+  std::mutex write_mutex_;
+  std::atomic<uint64_t> last_executed_seq_ = 0;
+  // Counts the commits. Unlike the seqs, which may be committed out of
+  // order, it orders the in-memory versions.
+  uint64_t commit_version_ = 0;
+  StateMerkleTree merkle_tree_;
+
+  std::mutex snapshot_mutex_;
+  std::multiset<uint64_t> snapshot_versions_;
+
+  // The state kept by CheckPointState() for state transfer.
+  std::mutex checkpoint_mutex_;
+  std::vector<std::string> checkpoint_nodes_;
+  std::vector<std::shared_ptr<const StateMerkleTree::Leaf>> checkpoint_leaves_;
+  std::shared_ptr<Snapshot> checkpoint_snapshot_;
+  // Declared last so that it is released before the members it uses.
+  std::shared_ptr<Snapshot> snapshot_;
 };
 
 }  // namespace resdb
@@ -28,9 +28,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "chain/storage/mock_storage.h"
+
 namespace resdb {
 namespace {
 
+using ::testing::Invoke;
+
 TEST(KVServerExecutorTest, SetValue) {
   ChainState state;
 
@@ -49,6 +53,101 @@ TEST(KVServerExecutorTest, GetValue) {
   EXPECT_EQ(state.GetValue("test_key"), "");
 }
 
+TEST(KVServerExecutorTest, GetSnapshot) {
+  ChainState state;
+  EXPECT_EQ(state.GetSnapshot(), nullptr);
+
+  EXPECT_EQ(state.SetValue("test_key", "test_value"), 0);
+  state.Commit(1);
+
+  std::shared_ptr<ChainState::Snapshot> snapshot = state.GetSnapshot();
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_EQ(snapshot->GetSeq(), 1);
+  EXPECT_EQ(state.GetLastExecutedSeq(), 1);
+
+  // Values set after the snapshot are not visible to it.
+  EXPECT_EQ(state.SetValue("test_key", "new_value"), 0);
+  EXPECT_EQ(state.SetValue("test_key2", "test_value2"), 0);
+  state.Commit(2);
+  EXPECT_EQ(state.SetValue("test_key", "pending_value"), 0);
+
+  EXPECT_EQ(snapshot->GetValue("test_key"), "test_value");
+  EXPECT_EQ(snapshot->GetValue("test_key2"), "");
+  EXPECT_EQ(snapshot->GetAllValues(), "[test_value]");
+  EXPECT_EQ(snapshot->GetRange("a", "z"), "[test_value]");
+
+  std::shared_ptr<ChainState::Snapshot> new_snapshot = state.GetSnapshot();
+  EXPECT_EQ(new_snapshot->GetSeq(), 2);
+  EXPECT_EQ(new_snapshot->GetValue("test_key"), "new_value");
+  EXPECT_EQ(new_snapshot->GetValue("test_key2"), "test_value2");
+
+  EXPECT_EQ(state.GetValue("test_key"), "pending_value");
+}
+
+TEST(KVServerExecutorTest, SnapshotAfterRelease) {
+  ChainState state;
+  EXPECT_EQ(state.SetValue("test_key", "value1"), 0);
+  state.Commit(1);
+  EXPECT_EQ(state.SetValue("test_key", "value2"), 0);
+  state.Commit(2);
+  EXPECT_EQ(state.SetValue("test_key", "value3"), 0);
+  state.Commit(3);
+
+  EXPECT_EQ(state.GetSnapshot()->GetValue("test_key"), "value3");
+  EXPECT_EQ(state.GetValue("test_key"), "value3");
+}
+
+TEST(KVServerExecutorTest, GetStateChunk) {
+  ChainState state;
+  EXPECT_EQ(state.SetValue("test_key", "value1"), 0);
+  EXPECT_EQ(state.SetValue("test_key2", "value2"), 0);
+  state.Commit(1);
+  std::string root = state.CheckPointState();
+  EXPECT_EQ(root, state.GetStateRoot());
+
+  // Values set after the checkpoint change the root but not the chunks.
+  EXPECT_EQ(state.SetValue("test_key", "value3"), 0);
+  EXPECT_EQ(state.SetValue("test_key2", ""), 0);
+  EXPECT_EQ(state.SetValue("test_key3", "value4"), 0);
+  state.Commit(2);
+  EXPECT_NE(root, state.GetStateRoot());
+
+  StateMerkleTree::Chunk chunk;
+  EXPECT_EQ(state.GetStateChunk(2, 0, &chunk), -1);
+
+  ChainState new_state;
+  for (uint32_t i = 0; i < state.GetStateChunkNum(); ++i) {
+    ASSERT_EQ(state.GetStateChunk(1, i, &chunk), 0);
+    EXPECT_TRUE(
+        StateMerkleTree::VerifyChunk(root, state.GetStateChunkNum(), chunk));
+    for (const auto& kv : chunk.kvs) {
+      EXPECT_EQ(new_state.SetValue(kv.first, kv.second), 0);
+    }
+  }
+  EXPECT_EQ(new_state.GetStateRoot(), root);
+  EXPECT_EQ(new_state.GetValue("test_key"), "value1");
+  EXPECT_EQ(new_state.GetValue("test_key2"), "value2");
+  EXPECT_EQ(new_state.GetValue("test_key3"), "");
+}
+
+TEST(KVServerExecutorTest, RebuildStateRootFromStorage) {
+  ChainState expected_state;
+  EXPECT_EQ(expected_state.SetValue("test_key", "value1"), 0);
+  EXPECT_EQ(expected_state.SetValue("test_key2", "value2"), 0);
+
+  auto storage = std::make_unique<MockStorage>();
+  EXPECT_CALL(*storage, ForEachValue)
+      .WillOnce(Invoke(
+          [](const std::function<void(const std::string&, const std::string&)>&
+                 func) {
+            func("test_key", "value1");
+            func("test_key2", "value2");
+            return 0;
+          }));
+  ChainState state(std::move(storage));
+  EXPECT_EQ(state.GetStateRoot(), expected_state.GetStateRoot());
+}
+
 }  // namespace
 
 }  // namespace resdb
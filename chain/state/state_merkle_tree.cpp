@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "chain/state/state_merkle_tree.h"
+
+#include <cassert>
+
+#include "common/crypto/signature_verifier.h"
+
+namespace resdb {
+
+namespace {
+
+std::string Hash(const std::string& data) {
+  return SignatureVerifier::CalculateHash(data);
+}
+
+std::string HashPair(const std::string& left, const std::string& right) {
+  std::string data;
+  data.reserve(left.size() + right.size());
+  data.append(left);
+  data.append(right);
+  return Hash(data);
+}
+
+void AppendKeyValueHash(const std::string& key, const std::string& value_hash,
+                        std::string* data) {
+  uint64_t key_size = key.size();
+  data->append(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+  data->append(key);
+  data->append(value_hash);
+}
+
+std::string HashLeaf(const StateMerkleTree::Leaf& leaf) {
+  std::string data;
+  for (const auto& kv : leaf) {
+    AppendKeyValueHash(kv.first, kv.second, &data);
+  }
+  return Hash(data);
+}
+
+}  // namespace
+
+StateMerkleTree::StateMerkleTree(int depth)
+    : depth_(depth), leaf_num_(1u << depth) {
+  assert(depth > 0 && depth < 32);
+  // The empty leaf is copied when a leaf is first updated.
+  leaves_.assign(leaf_num_, std::make_shared<Leaf>());
+  nodes_.resize(2 * leaf_num_);
+  std::string empty_leaf = HashLeaf({});
+  for (uint32_t i = leaf_num_; i < 2 * leaf_num_; ++i) {
+    nodes_[i] = empty_leaf;
+  }
+  for (uint32_t i = leaf_num_ - 1; i > 0; --i) {
+    nodes_[i] = HashPair(nodes_[2 * i], nodes_[2 * i + 1]);
+  }
+}
+
+uint32_t StateMerkleTree::GetLeafNum() const { return leaf_num_; }
+
+uint32_t StateMerkleTree::GetLeafIndex(const std::string& key) const {
+  // FNV-1a, which is the same on all the replicas.
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 16777619u;
+  }
+  return hash & (leaf_num_ - 1);
+}
+
+void StateMerkleTree::Update(const std::string& key,
+                             const std::string& value) {
+  uint32_t index = GetLeafIndex(key);
+  std::string value_hash = value.empty() ? "" : Hash(value);
+  std::lock_guard<std::mutex> lk(mutex_);
+  std::shared_ptr<Leaf>& leaf = leaves_[index];
+  if (leaf.use_count() > 1) {
+    leaf = std::make_shared<Leaf>(*leaf);
+  }
+  if (value.empty()) {
+    leaf->erase(key);
+  } else {
+    (*leaf)[key] = std::move(value_hash);
+  }
+  dirty_.insert(index);
+}
+
+void StateMerkleTree::Rehash() {
+  std::set<uint32_t> parents;
+  for (uint32_t index : dirty_) {
+    nodes_[leaf_num_ + index] = HashLeaf(*leaves_[index]);
+    parents.insert((leaf_num_ + index) / 2);
+  }
+  dirty_.clear();
+  while (!parents.empty()) {
+    std::set<uint32_t> next;
+    for (uint32_t i : parents) {
+      nodes_[i] = HashPair(nodes_[2 * i], nodes_[2 * i + 1]);
+      if (i > 1) {
+        next.insert(i / 2);
+      }
+    }
+    parents.swap(next);
+  }
+}
+
+std::string StateMerkleTree::GetRoot() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  Rehash();
+  return nodes_[1];
+}
+
+std::vector<std::string> StateMerkleTree::GetNodes() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  Rehash();
+  return nodes_;
+}
+
+std::vector<std::string> StateMerkleTree::GetKeys(uint32_t index) {
+  std::vector<std::string> keys;
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (index >= leaf_num_) {
+    return keys;
+  }
+  for (const auto& kv : *leaves_[index]) {
+    keys.push_back(kv.first);
+  }
+  return keys;
+}
+
+std::vector<std::shared_ptr<const StateMerkleTree::Leaf>>
+StateMerkleTree::GetLeaves() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return std::vector<std::shared_ptr<const Leaf>>(leaves_.begin(),
+                                                  leaves_.end());
+}
+
+std::vector<std::string> StateMerkleTree::GetProof(
+    const std::vector<std::string>& nodes, uint32_t index) {
+  std::vector<std::string> proof;
+  uint32_t leaf_num = nodes.size() / 2;
+  if (index >= leaf_num) {
+    return proof;
+  }
+  for (uint32_t i = leaf_num + index; i > 1; i /= 2) {
+    proof.push_back(nodes[i ^ 1]);
+  }
+  return proof;
+}
+
+bool StateMerkleTree::VerifyChunk(const std::string& root, uint32_t leaf_num,
+                                  const Chunk& chunk) {
+  if (leaf_num == 0 || (leaf_num & (leaf_num - 1)) != 0 ||
+      chunk.index >= leaf_num || (1ull << chunk.proof.size()) != leaf_num) {
+    return false;
+  }
+  std::string data;
+  for (size_t i = 0; i < chunk.kvs.size(); ++i) {
+    const auto& kv = chunk.kvs[i];
+    if (kv.second.empty() || (i > 0 && chunk.kvs[i - 1].first >= kv.first)) {
+      return false;
+    }
+    AppendKeyValueHash(kv.first, Hash(kv.second), &data);
+  }
+  std::string hash = Hash(data);
+  uint32_t node = leaf_num + chunk.index;
+  for (const std::string& sibling : chunk.proof) {
+    hash = node % 2 == 0 ? HashPair(hash, sibling) : HashPair(sibling, hash);
+    node /= 2;
+  }
+  return hash == root;
+}
+
+}  // namespace resdb
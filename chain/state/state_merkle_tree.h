@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace resdb {
+
+// StateMerkleTree commits to the key-values of a state. Keys are spread over
+// a fixed number of leaves by the hash of the key, and a leaf hashes the
+// sorted keys in it together with the hashes of their values. Update() only
+// marks the leaf dirty, the dirty leaves and their paths are rehashed when
+// the root is read.
+//
+// A leaf with its key-values is also the unit of state transfer: a chunk
+// carries the sibling hashes from its leaf to the root so that it can be
+// verified against the root alone. Keys with an empty value are not kept.
+class StateMerkleTree {
+ public:
+  // The keys in a leaf and the hashes of their values.
+  using Leaf = std::map<std::string, std::string>;
+
+  struct Chunk {
+    uint32_t index = 0;
+    // Key-values sorted by key.
+    std::vector<std::pair<std::string, std::string>> kvs;
+    // The sibling hashes from the leaf to the root.
+    std::vector<std::string> proof;
+  };
+
+  // The tree has 2^depth leaves.
+  explicit StateMerkleTree(int depth = 12);
+
+  void Update(const std::string& key, const std::string& value);
+
+  std::string GetRoot();
+
+  // Return all the nodes after rehashing the dirty leaves. Node 1 is the
+  // root, the children of node i are 2i and 2i+1, and the leaves start from
+  // GetLeafNum().
+  std::vector<std::string> GetNodes();
+
+  // Return the keys in the leaf.
+  std::vector<std::string> GetKeys(uint32_t index);
+
+  // Return the leaves as they are now. Update() copies a leaf before
+  // changing it if it is still held, so the returned leaves do not change.
+  std::vector<std::shared_ptr<const Leaf>> GetLeaves();
+
+  uint32_t GetLeafNum() const;
+  uint32_t GetLeafIndex(const std::string& key) const;
+
+  // Return the sibling hashes from the leaf to the root in the nodes
+  // returned by GetNodes().
+  static std::vector<std::string> GetProof(
+      const std::vector<std::string>& nodes, uint32_t index);
+
+  // Check the key-values of the chunk against the root of a tree with
+  // `leaf_num` leaves.
+  static bool VerifyChunk(const std::string& root, uint32_t leaf_num,
+                          const Chunk& chunk);
+
+ private:
+  void Rehash();
+
+ private:
+  int depth_;
+  uint32_t leaf_num_;
+  std::mutex mutex_;
+  // Shared with the callers of GetLeaves() until they are changed.
+  std::vector<std::shared_ptr<Leaf>> leaves_;
+  std::vector<std::string> nodes_;
+  std::set<uint32_t> dirty_;
+};
+
+}  // namespace resdb
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "chain/state/state_merkle_tree.h"
+
+#include <gtest/gtest.h>
+
+namespace resdb {
+namespace {
+
+StateMerkleTree::Chunk GetChunk(StateMerkleTree* tree, uint32_t index,
+                                const std::map<std::string, std::string>& kv) {
+  StateMerkleTree::Chunk chunk;
+  chunk.index = index;
+  for (const std::string& key : tree->GetKeys(index)) {
+    chunk.kvs.push_back(std::make_pair(key, kv.at(key)));
+  }
+  chunk.proof = StateMerkleTree::GetProof(tree->GetNodes(), index);
+  return chunk;
+}
+
+TEST(StateMerkleTreeTest, RootFollowsValues) {
+  StateMerkleTree tree(4);
+  std::string empty_root = tree.GetRoot();
+
+  tree.Update("key1", "value1");
+  std::string root = tree.GetRoot();
+  EXPECT_NE(root, empty_root);
+
+  tree.Update("key1", "value2");
+  EXPECT_NE(tree.GetRoot(), root);
+
+  tree.Update("key1", "value1");
+  EXPECT_EQ(tree.GetRoot(), root);
+
+  tree.Update("key1", "");
+  EXPECT_EQ(tree.GetRoot(), empty_root);
+}
+
+TEST(StateMerkleTreeTest, SameStateSameRoot) {
+  StateMerkleTree tree1(4), tree2(4);
+  for (int i = 0; i < 100; ++i) {
+    tree1.Update("key" + std::to_string(i), "value" + std::to_string(i));
+  }
+  for (int i = 99; i >= 0; --i) {
+    tree2.Update("key" + std::to_string(i), "old");
+    tree2.Update("key" + std::to_string(i), "value" + std::to_string(i));
+  }
+  EXPECT_EQ(tree1.GetRoot(), tree2.GetRoot());
+}
+
+TEST(StateMerkleTreeTest, VerifyChunk) {
+  StateMerkleTree tree(4);
+  std::map<std::string, std::string> kv;
+  for (int i = 0; i < 50; ++i) {
+    kv["key" + std::to_string(i)] = "value" + std::to_string(i);
+    tree.Update("key" + std::to_string(i), "value" + std::to_string(i));
+  }
+  std::string root = tree.GetRoot();
+
+  for (uint32_t i = 0; i < tree.GetLeafNum(); ++i) {
+    StateMerkleTree::Chunk chunk = GetChunk(&tree, i, kv);
+    EXPECT_TRUE(StateMerkleTree::VerifyChunk(root, tree.GetLeafNum(), chunk));
+  }
+
+  uint32_t index = tree.GetLeafIndex("key1");
+  StateMerkleTree::Chunk chunk = GetChunk(&tree, index, kv);
+  ASSERT_FALSE(chunk.kvs.empty());
+
+  StateMerkleTree::Chunk bad_value = chunk;
+  bad_value.kvs[0].second = "bad";
+  EXPECT_FALSE(
+      StateMerkleTree::VerifyChunk(root, tree.GetLeafNum(), bad_value));
+
+  StateMerkleTree::Chunk missing_key = chunk;
+  missing_key.kvs.pop_back();
+  EXPECT_FALSE(
+      StateMerkleTree::VerifyChunk(root, tree.GetLeafNum(), missing_key));
+
+  StateMerkleTree::Chunk bad_index = chunk;
+  bad_index.index = (index + 1) % tree.GetLeafNum();
+  EXPECT_FALSE(
+      StateMerkleTree::VerifyChunk(root, tree.GetLeafNum(), bad_index));
+
+  StateMerkleTree::Chunk short_proof = chunk;
+  short_proof.proof.pop_back();
+  EXPECT_FALSE(
+      StateMerkleTree::VerifyChunk(root, tree.GetLeafNum(), short_proof));
+}
+
+}  // namespace
+}  // namespace resdb
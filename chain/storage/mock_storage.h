@@ -39,6 +39,10 @@ class MockStorage : public Storage {
   MOCK_METHOD(std::string, GetRange, (const std::string&, const std::string&),
               (override));
   MOCK_METHOD(bool, Flush, (), (override));
+  MOCK_METHOD(int, ForEachValue,
+              ((const std::function<void(const std::string&,
+                                         const std::string&)>&)),
+              (override));
 };
 
 }  // namespace resdb
@@ -29,6 +29,135 @@
 
 namespace resdb {
 
+namespace {
+
+std::string GetValueFromDB(leveldb::DB* db, const leveldb::ReadOptions& options,
+                           const std::string& key) {
+  std::string value = "";
+  leveldb::Status status = db->Get(options, key, &value);
+  if (status.ok()) {
+    return value;
+  } else {
+    LOG(ERROR) << "get value fail:" << status.ToString();
+    return "";
+  }
+}
+
+std::string GetAllValuesFromDB(leveldb::DB* db,
+                               const leveldb::ReadOptions& options) {
+  std::string values = "[";
+  leveldb::Iterator* it = db->NewIterator(options);
+  bool first_iteration = true;
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    if (!first_iteration) values.append(",");
+    first_iteration = false;
+    values.append(it->value().ToString());
+  }
+  values.append("]");
+
+  delete it;
+  return values;
+}
+
+std::string GetRangeFromDB(leveldb::DB* db, const leveldb::ReadOptions& options,
+                           const std::string& min_key,
+                           const std::string& max_key) {
+  std::string values = "[";
+  leveldb::Iterator* it = db->NewIterator(options);
+  bool first_iteration = true;
+  for (it->Seek(min_key); it->Valid() && it->key().ToString() <= max_key;
+       it->Next()) {
+    if (!first_iteration) values.append(",");
+    first_iteration = false;
+    values.append(it->value().ToString());
+  }
+  values.append("]");
+
+  delete it;
+  return values;
+}
+
+// Returns the values from min_key up to max_key (no upper bound if max_key
+// is null), reading the pending values over the ones in the db.
+std::string GetMergedRangeFromDB(leveldb::DB* db,
+                                 const leveldb::ReadOptions& options,
+                                 const ResLevelDB::PendingValues& pending,
+                                 const std::string& min_key,
+                                 const std::string* max_key) {
+  std::string values = "[";
+  bool first_iteration = true;
+  auto append = [&](const std::string& value) {
+    if (!first_iteration) values.append(",");
+    first_iteration = false;
+    values.append(value);
+  };
+  auto in_range = [&](const std::string& key) {
+    return max_key == nullptr || key <= *max_key;
+  };
+
+  auto pending_it = pending.lower_bound(min_key);
+  std::unique_ptr<leveldb::Iterator> it(db->NewIterator(options));
+  for (it->Seek(min_key); it->Valid() && in_range(it->key().ToString());
+       it->Next()) {
+    std::string key = it->key().ToString();
+    for (; pending_it != pending.end() && pending_it->first < key;
+         ++pending_it) {
+      append(pending_it->second);
+    }
+    if (pending_it != pending.end() && pending_it->first == key) {
+      append(pending_it->second);
+      ++pending_it;
+      continue;
+    }
+    append(it->value().ToString());
+  }
+  for (; pending_it != pending.end() && in_range(pending_it->first);
+       ++pending_it) {
+    append(pending_it->second);
+  }
+  values.append("]");
+  return values;
+}
+
+// Wraps a leveldb snapshot, which is released when the object is destroyed,
+// together with the values still pending in the write batch when it was
+// taken.
+class LevelDBSnapshot : public Storage::Snapshot {
+ public:
+  LevelDBSnapshot(leveldb::DB* db,
+                  std::shared_ptr<const ResLevelDB::PendingValues> pending)
+      : db_(db), snapshot_(db->GetSnapshot()), pending_(std::move(pending)) {
+    options_.snapshot = snapshot_;
+  }
+
+  ~LevelDBSnapshot() { db_->ReleaseSnapshot(snapshot_); }
+
+  std::string GetValue(const std::string& key) override {
+    auto it = pending_->find(key);
+    if (it != pending_->end()) {
+      return it->second;
+    }
+    return GetValueFromDB(db_, options_, key);
+  }
+
+  std::string GetAllValues() override {
+    return GetMergedRangeFromDB(db_, options_, *pending_, "", nullptr);
+  }
+
+  std::string GetRange(const std::string& min_key,
+                       const std::string& max_key) override {
+    return GetMergedRangeFromDB(db_, options_, *pending_, min_key, &max_key);
+  }
+
+ private:
+  leveldb::DB* db_;
+  const leveldb::Snapshot* snapshot_;
+  leveldb::ReadOptions options_;
+  std::shared_ptr<const ResLevelDB::PendingValues> pending_;
+};
+
+}  // namespace
+
 std::unique_ptr<Storage> NewResLevelDB(const char* cert_file,
                                        resdb::ResConfigData config_data) {
   return std::make_unique<ResLevelDB>(cert_file, config_data);
@@ -99,11 +228,18 @@ ResLevelDB::~ResLevelDB() {
 
 int ResLevelDB::SetValue(const std::string& key, const std::string& value) {
   batch_.Put(key, value);
+  // Snapshots hold the pending values they were taken with, so copy them
+  // before the first change after a snapshot.
+  if (pending_.use_count() > 1) {
+    pending_ = std::make_shared<PendingValues>(*pending_);
+  }
+  (*pending_)[key] = value;
 
   if (batch_.ApproximateSize() >= write_batch_size_) {
     leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch_);
     if (status.ok()) {
       batch_.Clear();
+      pending_ = std::make_shared<PendingValues>();
       return 0;
     } else {
       LOG(ERROR) << "flush buffer fail:" << status.ToString();
@@ -114,56 +250,51 @@ int ResLevelDB::SetValue(const std::string& key, const std::string& value) {
 }
 
 std::string ResLevelDB::GetValue(const std::string& key) {
-  std::string value = "";
-  leveldb::Status status = db_->Get(leveldb::ReadOptions(), key, &value);
-  if (status.ok()) {
-    return value;
-  } else {
-    LOG(ERROR) << "get value fail:" << status.ToString();
-    return "";
-  }
+  return GetValueFromDB(db_.get(), leveldb::ReadOptions(), key);
 }
 
 std::string ResLevelDB::GetAllValues(void) {
-  std::string values = "[";
-  leveldb::Iterator* it = db_->NewIterator(leveldb::ReadOptions());
-  bool first_iteration = true;
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    if (!first_iteration) values.append(",");
-    first_iteration = false;
-    values.append(it->value().ToString());
-  }
-  values.append("]");
-
-  delete it;
-  return values;
+  return GetAllValuesFromDB(db_.get(), leveldb::ReadOptions());
 }
 
 std::string ResLevelDB::GetRange(const std::string& min_key,
                                  const std::string& max_key) {
-  std::string values = "[";
-  leveldb::Iterator* it = db_->NewIterator(leveldb::ReadOptions());
-  bool first_iteration = true;
-  for (it->Seek(min_key); it->Valid() && it->key().ToString() <= max_key;
-       it->Next()) {
-    if (!first_iteration) values.append(",");
-    first_iteration = false;
-    values.append(it->value().ToString());
-  }
-  values.append("]");
-
-  delete it;
-  return values;
+  return GetRangeFromDB(db_.get(), leveldb::ReadOptions(), min_key, max_key);
 }
 
 bool ResLevelDB::Flush() {
   leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch_);
   if (status.ok()) {
     batch_.Clear();
+    pending_ = std::make_shared<PendingValues>();
     return true;
   }
   LOG(ERROR) << "flush buffer fail:" << status.ToString();
   return false;
 }
 
+std::unique_ptr<Storage::Snapshot> ResLevelDB::GetSnapshot() {
+  // Values pending in the batch are not visible to the db snapshot, so the
+  // snapshot reads them from the pending values instead of flushing the
+  // batch on every commit.
+  return std::make_unique<LevelDBSnapshot>(db_.get(), pending_);
+}
+
+int ResLevelDB::ForEachValue(
+    const std::function<void(const std::string& key, const std::string& value)>&
+        func) {
+  std::unique_ptr<leveldb::Iterator> it(
+      db_->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    std::string key = it->key().ToString();
+    if (pending_->find(key) == pending_->end()) {
+      func(key, it->value().ToString());
+    }
+  }
+  for (const auto& kv : *pending_) {
+    func(kv.first, kv.second);
+  }
+  return 0;
+}
+
 }  // namespace resdb
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -41,6 +43,9 @@ std::unique_ptr<Storage> NewResLevelDB(const char* cert_file,
 
 class ResLevelDB : public Storage {
  public:
+  // The values set since the last write of the batch.
+  using PendingValues = std::map<std::string, std::string>;
+
   ResLevelDB(const char* cert_file, std::optional<ResConfigData> config_data);
 
   virtual ~ResLevelDB();
@@ -52,12 +57,20 @@ class ResLevelDB : public Storage {
 
   bool Flush() override;
 
+  std::unique_ptr<Snapshot> GetSnapshot() override;
+
+  int ForEachValue(const std::function<void(const std::string& key,
+                                            const std::string& value)>& func)
+      override;
+
  private:
   void CreateDB(const std::string& path);
 
  private:
   std::unique_ptr<leveldb::DB> db_ = nullptr;
   ::leveldb::WriteBatch batch_;
+  // Shared with the snapshots taken since it was last changed.
+  std::shared_ptr<PendingValues> pending_ = std::make_shared<PendingValues>();
   unsigned int write_buffer_size_ = 64 << 20;
   unsigned int write_batch_size_ = 1;
 };
@@ -30,6 +30,7 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <map>
 
 namespace resdb {
 
@@ -106,6 +107,81 @@ TEST_F(ResLevelDBDurableTest, GetRange) {
   EXPECT_EQ(GetRange("key4", "key5"), "[]");
 }
 
+TEST_F(ResLevelDBDurableTest, GetSnapshot) {
+  resdb::ResConfigData config_data;
+  config_data.mutable_leveldb_info()->set_path("/tmp/leveldb_snapshot_test");
+  std::filesystem::remove_all("/tmp/leveldb_snapshot_test");
+  std::unique_ptr<Storage> storage = NewResLevelDB(NULL, config_data);
+
+  EXPECT_EQ(storage->SetValue("key1", "value1"), 0);
+  std::unique_ptr<Storage::Snapshot> snapshot = storage->GetSnapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  EXPECT_EQ(storage->SetValue("key1", "new_value1"), 0);
+  EXPECT_EQ(storage->SetValue("key2", "value2"), 0);
+
+  EXPECT_EQ(snapshot->GetValue("key1"), "value1");
+  EXPECT_EQ(snapshot->GetValue("key2"), "");
+  EXPECT_EQ(snapshot->GetAllValues(), "[value1]");
+  EXPECT_EQ(snapshot->GetRange("key1", "key2"), "[value1]");
+  EXPECT_EQ(storage->GetRange("key1", "key2"), "[new_value1,value2]");
+}
+
+TEST_F(ResLevelDBDurableTest, GetSnapshotWithPendingValues) {
+  resdb::ResConfigData config_data;
+  config_data.mutable_leveldb_info()->set_path("/tmp/leveldb_snapshot_test");
+  config_data.mutable_leveldb_info()->set_write_batch_size(1 << 20);
+  std::filesystem::remove_all("/tmp/leveldb_snapshot_test");
+  std::unique_ptr<Storage> storage = NewResLevelDB(NULL, config_data);
+
+  EXPECT_EQ(storage->SetValue("key1", "value1"), 0);
+  EXPECT_EQ(storage->SetValue("key3", "value3"), 0);
+  ASSERT_TRUE(storage->Flush());
+  EXPECT_EQ(storage->SetValue("key2", "value2"), 0);
+  EXPECT_EQ(storage->SetValue("key3", "new_value3"), 0);
+  std::unique_ptr<Storage::Snapshot> snapshot = storage->GetSnapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  // The pending values are read from the snapshot without being written.
+  EXPECT_EQ(storage->GetValue("key2"), "");
+  EXPECT_EQ(storage->SetValue("key2", "new_value2"), 0);
+  EXPECT_EQ(storage->SetValue("key4", "value4"), 0);
+  ASSERT_TRUE(storage->Flush());
+
+  EXPECT_EQ(snapshot->GetValue("key2"), "value2");
+  EXPECT_EQ(snapshot->GetValue("key3"), "new_value3");
+  EXPECT_EQ(snapshot->GetValue("key4"), "");
+  EXPECT_EQ(snapshot->GetAllValues(), "[value1,value2,new_value3]");
+  EXPECT_EQ(snapshot->GetRange("key2", "key3"), "[value2,new_value3]");
+  EXPECT_EQ(storage->GetAllValues(), "[value1,new_value2,new_value3,value4]");
+}
+
+TEST_F(ResLevelDBDurableTest, ForEachValue) {
+  resdb::ResConfigData config_data;
+  config_data.mutable_leveldb_info()->set_path("/tmp/leveldb_for_each_test");
+  config_data.mutable_leveldb_info()->set_write_batch_size(1 << 20);
+  std::filesystem::remove_all("/tmp/leveldb_for_each_test");
+  std::unique_ptr<Storage> storage = NewResLevelDB(NULL, config_data);
+
+  EXPECT_EQ(storage->SetValue("key1", "value1"), 0);
+  EXPECT_EQ(storage->SetValue("key2", "value2"), 0);
+  ASSERT_TRUE(storage->Flush());
+  EXPECT_EQ(storage->SetValue("key2", "new_value2"), 0);
+  EXPECT_EQ(storage->SetValue("key3", "value3"), 0);
+
+  // The pending values are visited over the ones in the db.
+  std::map<std::string, std::string> values;
+  EXPECT_EQ(storage->ForEachValue(
+                [&](const std::string& key, const std::string& value) {
+                  EXPECT_TRUE(values.emplace(key, value).second);
+                }),
+            0);
+  EXPECT_EQ(values, (std::map<std::string, std::string>{
+                        {"key1", "value1"},
+                        {"key2", "new_value2"},
+                        {"key3", "value3"}}));
+}
+
 }  // namespace
 
 }  // namespace resdb
@@ -30,6 +30,134 @@
 
 namespace resdb {
 
+namespace {
+
+std::string GetValueFromDB(rocksdb::DB* db, const rocksdb::ReadOptions& options,
+                           const std::string& key) {
+  std::string value = "";
+  rocksdb::Status status = db->Get(options, key, &value);
+  if (status.ok()) {
+    return value;
+  } else {
+    return "";
+  }
+}
+
+std::string GetAllValuesFromDB(rocksdb::DB* db,
+                               const rocksdb::ReadOptions& options) {
+  std::string values = "[";
+  rocksdb::Iterator* itr = db->NewIterator(options);
+  bool first_iteration = true;
+  for (itr->SeekToFirst(); itr->Valid(); itr->Next()) {
+    if (!first_iteration) values.append(",");
+    first_iteration = false;
+    values.append(itr->value().ToString());
+  }
+  values.append("]");
+
+  delete itr;
+  return values;
+}
+
+std::string GetRangeFromDB(rocksdb::DB* db, const rocksdb::ReadOptions& options,
+                           const std::string& min_key,
+                           const std::string& max_key) {
+  std::string values = "[";
+  rocksdb::Iterator* itr = db->NewIterator(options);
+  bool first_iteration = true;
+  for (itr->Seek(min_key); itr->Valid() && itr->key().ToString() <= max_key;
+       itr->Next()) {
+    if (!first_iteration) values.append(",");
+    first_iteration = false;
+    values.append(itr->value().ToString());
+  }
+  values.append("]");
+
+  delete itr;
+  return values;
+}
+
+// Returns the values from min_key up to max_key (no upper bound if max_key
+// is null), reading the pending values over the ones in the db.
+std::string GetMergedRangeFromDB(rocksdb::DB* db,
+                                 const rocksdb::ReadOptions& options,
+                                 const ResRocksDB::PendingValues& pending,
+                                 const std::string& min_key,
+                                 const std::string* max_key) {
+  std::string values = "[";
+  bool first_iteration = true;
+  auto append = [&](const std::string& value) {
+    if (!first_iteration) values.append(",");
+    first_iteration = false;
+    values.append(value);
+  };
+  auto in_range = [&](const std::string& key) {
+    return max_key == nullptr || key <= *max_key;
+  };
+
+  auto pending_itr = pending.lower_bound(min_key);
+  std::unique_ptr<rocksdb::Iterator> itr(db->NewIterator(options));
+  for (itr->Seek(min_key); itr->Valid() && in_range(itr->key().ToString());
+       itr->Next()) {
+    std::string key = itr->key().ToString();
+    for (; pending_itr != pending.end() && pending_itr->first < key;
+         ++pending_itr) {
+      append(pending_itr->second);
+    }
+    if (pending_itr != pending.end() && pending_itr->first == key) {
+      append(pending_itr->second);
+      ++pending_itr;
+      continue;
+    }
+    append(itr->value().ToString());
+  }
+  for (; pending_itr != pending.end() && in_range(pending_itr->first);
+       ++pending_itr) {
+    append(pending_itr->second);
+  }
+  values.append("]");
+  return values;
+}
+
+// Wraps a rocksdb snapshot, which is released when the object is destroyed,
+// together with the values still pending in the write batch when it was
+// taken.
+class RocksDBSnapshot : public Storage::Snapshot {
+ public:
+  RocksDBSnapshot(rocksdb::DB* db,
+                  std::shared_ptr<const ResRocksDB::PendingValues> pending)
+      : db_(db), snapshot_(db->GetSnapshot()), pending_(std::move(pending)) {
+    options_.snapshot = snapshot_;
+  }
+
+  ~RocksDBSnapshot() { db_->ReleaseSnapshot(snapshot_); }
+
+  std::string GetValue(const std::string& key) override {
+    auto itr = pending_->find(key);
+    if (itr != pending_->end()) {
+      return itr->second;
+    }
+    return GetValueFromDB(db_, options_, key);
+  }
+
+  std::string GetAllValues() override {
+    return GetMergedRangeFromDB(db_, options_, *pending_, "", nullptr);
+  }
+
+  std::string GetRange(const std::string& min_key,
+                       const std::string& max_key) override {
+    return GetMergedRangeFromDB(db_, options_, *pending_, min_key, &max_key);
+  }
+
+ private:
+  rocksdb::DB* db_;
+  const rocksdb::Snapshot* snapshot_;
+  rocksdb::ReadOptions options_;
+  std::shared_ptr<const ResRocksDB::PendingValues> pending_;
+};
+
+}  // namespace
+
 std::unique_ptr<Storage> NewResRocksDB(
     const char* cert_file, std::optional<resdb::ResConfigData> config_data) {
   return std::make_unique<ResRocksDB>(cert_file, config_data);
@@ -103,11 +231,18 @@ ResRocksDB::~ResRocksDB() {
 
 int ResRocksDB::SetValue(const std::string& key, const std::string& value) {
   batch_.Put(key, value);
+  // Snapshots hold the pending values they were taken with, so copy them
+  // before the first change after a snapshot.
+  if (pending_.use_count() > 1) {
+    pending_ = std::make_shared<PendingValues>(*pending_);
+  }
+  (*pending_)[key] = value;
 
   if (batch_.Count() >= write_batch_size_) {
     rocksdb::Status status = db_->Write(rocksdb::WriteOptions(), &batch_);
     if (status.ok()) {
       batch_.Clear();
+      pending_ = std::make_shared<PendingValues>();
     } else {
       LOG(ERROR) << "write value fail:" << status.ToString();
       return -1;
@@ -117,55 +252,51 @@ int ResRocksDB::SetValue(const std::string& key, const std::string& value) {
 }
 
 std::string ResRocksDB::GetValue(const std::string& key) {
-  std::string value = "";
-  rocksdb::Status status = db_->Get(rocksdb::ReadOptions(), key, &value);
-  if (status.ok()) {
-    return value;
-  } else {
-    return "";
-  }
+  return GetValueFromDB(db_.get(), rocksdb::ReadOptions(), key);
 }
 
 std::string ResRocksDB::GetAllValues(void) {
-  std::string values = "[";
-  rocksdb::Iterator* itr = db_->NewIterator(rocksdb::ReadOptions());
-  bool first_iteration = true;
-  for (itr->SeekToFirst(); itr->Valid(); itr->Next()) {
-    if (!first_iteration) values.append(",");
-    first_iteration = false;
-    values.append(itr->value().ToString());
-  }
-  values.append("]");
-
-  delete itr;
-  return values;
+  return GetAllValuesFromDB(db_.get(), rocksdb::ReadOptions());
 }
 
 std::string ResRocksDB::GetRange(const std::string& min_key,
                                  const std::string& max_key) {
-  std::string values = "[";
-  rocksdb::Iterator* itr = db_->NewIterator(rocksdb::ReadOptions());
-  bool first_iteration = true;
-  for (itr->Seek(min_key); itr->Valid() && itr->key().ToString() <= max_key;
-       itr->Next()) {
-    if (!first_iteration) values.append(",");
-    first_iteration = false;
-    values.append(itr->value().ToString());
-  }
-  values.append("]");
-
-  delete itr;
-  return values;
+  return GetRangeFromDB(db_.get(), rocksdb::ReadOptions(), min_key, max_key);
 }
 
 bool ResRocksDB::Flush() {
   rocksdb::Status status = db_->Write(rocksdb::WriteOptions(), &batch_);
   if (status.ok()) {
     batch_.Clear();
+    pending_ = std::make_shared<PendingValues>();
     return true;
   }
   LOG(ERROR) << "write value fail:" << status.ToString();
   return false;
 }
 
+std::unique_ptr<Storage::Snapshot> ResRocksDB::GetSnapshot() {
+  // Values pending in the batch are not visible to the db snapshot, so the
+  // snapshot reads them from the pending values instead of flushing the
+  // batch on every commit.
+  return std::make_unique<RocksDBSnapshot>(db_.get(), pending_);
+}
+
+int ResRocksDB::ForEachValue(
+    const std::function<void(const std::string& key, const std::string& value)>&
+        func) {
+  std::unique_ptr<rocksdb::Iterator> it(
+      db_->NewIterator(rocksdb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    std::string key = it->key().ToString();
+    if (pending_->find(key) == pending_->end()) {
+      func(key, it->value().ToString());
+    }
+  }
+  for (const auto& kv : *pending_) {
+    func(kv.first, kv.second);
+  }
+  return 0;
+}
+
 }  // namespace resdb
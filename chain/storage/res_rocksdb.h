@@ -25,6 +25,9 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -40,6 +43,9 @@ std::unique_ptr<Storage> NewResRocksDB(
 
 class ResRocksDB : public Storage {
  public:
+  // The values set since the last write of the batch.
+  using PendingValues = std::map<std::string, std::string>;
+
   ResRocksDB(const char* cert_file, std::optional<ResConfigData> config_data);
   virtual ~ResRocksDB();
   int SetValue(const std::string& key, const std::string& value) override;
@@ -50,9 +56,17 @@ class ResRocksDB : public Storage {
 
   bool Flush() override;
 
+  std::unique_ptr<Snapshot> GetSnapshot() override;
+
+  int ForEachValue(const std::function<void(const std::string& key,
+                                            const std::string& value)>& func)
+      override;
+
  private:
   std::unique_ptr<rocksdb::DB> db_ = nullptr;
   rocksdb::WriteBatch batch_;
+  // Shared with the snapshots taken since it was last changed.
+  std::shared_ptr<PendingValues> pending_ = std::make_shared<PendingValues>();
   unsigned int num_threads_ = 1;
   unsigned int write_buffer_size_ = 64 << 20;
   unsigned int write_batch_size_ = 1;
@@ -29,6 +29,7 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <map>
 
 namespace resdb {
 namespace {
@@ -105,5 +106,58 @@ TEST_F(RocksDBDurableTest, GetRange) {
   EXPECT_EQ(GetRange("key4", "key5"), "[]");
 }
 
+TEST_F(RocksDBDurableTest, GetSnapshotWithPendingValues) {
+  ResConfigData config_data;
+  config_data.mutable_rocksdb_info()->set_path(path_);
+  config_data.mutable_rocksdb_info()->set_write_batch_size(100);
+  std::unique_ptr<Storage> storage = NewResRocksDB(NULL, config_data);
+
+  EXPECT_EQ(storage->SetValue("key1", "value1"), 0);
+  EXPECT_EQ(storage->SetValue("key3", "value3"), 0);
+  ASSERT_TRUE(storage->Flush());
+  EXPECT_EQ(storage->SetValue("key2", "value2"), 0);
+  EXPECT_EQ(storage->SetValue("key3", "new_value3"), 0);
+  std::unique_ptr<Storage::Snapshot> snapshot = storage->GetSnapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  // The pending values are read from the snapshot without being written.
+  EXPECT_EQ(storage->GetValue("key2"), "");
+  EXPECT_EQ(storage->SetValue("key2", "new_value2"), 0);
+  EXPECT_EQ(storage->SetValue("key4", "value4"), 0);
+  ASSERT_TRUE(storage->Flush());
+
+  EXPECT_EQ(snapshot->GetValue("key2"), "value2");
+  EXPECT_EQ(snapshot->GetValue("key3"), "new_value3");
+  EXPECT_EQ(snapshot->GetValue("key4"), "");
+  EXPECT_EQ(snapshot->GetAllValues(), "[value1,value2,new_value3]");
+  EXPECT_EQ(snapshot->GetRange("key2", "key3"), "[value2,new_value3]");
+  EXPECT_EQ(storage->GetAllValues(), "[value1,new_value2,new_value3,value4]");
+}
+
+TEST_F(RocksDBDurableTest, ForEachValue) {
+  ResConfigData config_data;
+  config_data.mutable_rocksdb_info()->set_path(path_);
+  config_data.mutable_rocksdb_info()->set_write_batch_size(100);
+  std::unique_ptr<Storage> storage = NewResRocksDB(NULL, config_data);
+
+  EXPECT_EQ(storage->SetValue("key1", "value1"), 0);
+  EXPECT_EQ(storage->SetValue("key2", "value2"), 0);
+  ASSERT_TRUE(storage->Flush());
+  EXPECT_EQ(storage->SetValue("key2", "new_value2"), 0);
+  EXPECT_EQ(storage->SetValue("key3", "value3"), 0);
+
+  // The pending values are visited over the ones in the db.
+  std::map<std::string, std::string> values;
+  EXPECT_EQ(storage->ForEachValue(
+                [&](const std::string& key, const std::string& value) {
+                  EXPECT_TRUE(values.emplace(key, value).second);
+                }),
+            0);
+  EXPECT_EQ(values, (std::map<std::string, std::string>{
+                        {"key1", "value1"},
+                        {"key2", "new_value2"},
+                        {"key3", "value3"}}));
+}
+
 }  // namespace
 }  // namespace resdb
@@ -25,12 +25,26 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 
 namespace resdb {
 
 class Storage {
  public:
+  // A read-only view of the storage at the time it was created.
+  // A snapshot must not outlive the storage it was created from.
+  class Snapshot {
+   public:
+    virtual ~Snapshot() = default;
+
+    virtual std::string GetValue(const std::string& key) = 0;
+    virtual std::string GetAllValues() = 0;
+    virtual std::string GetRange(const std::string& min_key,
+                                 const std::string& max_key) = 0;
+  };
+
   Storage() = default;
   virtual ~Storage() = default;
 
@@ -50,6 +64,21 @@ class Storage {
 
   // Flush data to disk
   virtual bool Flush() = 0;
+
+  // Create a snapshot containing all the values set so far, including the
+  // ones still pending in the write batch.
+  // It should be called from the thread calling SetValue.
+  // Return nullptr if the storage does not support snapshots.
+  virtual std::unique_ptr<Snapshot> GetSnapshot() { return nullptr; }
+
+  // Call func on each key in db with its value, including the values still
+  // pending in the write batch.
+  // Return -1 if the storage does not support it.
+  virtual int ForEachValue(
+      const std::function<void(const std::string& key,
+                               const std::string& value)>& func) {
+    return -1;
+  }
 };
 
 }  // namespace resdb
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+// Cost of storing and reading the committed requests by seq.
+// Arg: request data bytes.
+
+#include <benchmark/benchmark.h>
+
+#include "chain/storage/txn_memory_db.h"
+
+namespace resdb {
+namespace {
+
+// Seqs are reused in the window so that the db does not grow without
+// bound during a long run.
+constexpr uint64_t kSeqWindow = 1 << 16;
+
+void BM_Put(benchmark::State& state) {
+  TxnMemoryDB db;
+  std::string data(state.range(0), 'a');
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    auto request = std::make_unique<Request>();
+    request->set_seq(++seq % kSeqWindow);
+    request->set_data(data);
+    db.Put(std::move(request));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Put)->Arg(64)->Arg(4096);
+
+TxnMemoryDB* shared_db = nullptr;
+
+// Threads read random seqs from a filled db.
+void BM_Get(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    shared_db = new TxnMemoryDB();
+    for (uint64_t seq = 1; seq <= kSeqWindow; ++seq) {
+      auto request = std::make_unique<Request>();
+      request->set_seq(seq);
+      request->set_data(std::string(state.range(0), 'a'));
+      shared_db->Put(std::move(request));
+    }
+  }
+  uint64_t seq = state.thread_index();
+  for (auto _ : state) {
+    seq = seq * 6364136223846793005ULL + 1442695040888963407ULL;
+    benchmark::DoNotOptimize(shared_db->Get(seq % kSeqWindow + 1));
+  }
+  if (state.thread_index() == 0) {
+    delete shared_db;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Get)->Arg(64)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+// Cost of signing and verifying a message with each key type.
+// Args: {SignatureInfo::HashType, message bytes}.
+
+#include <benchmark/benchmark.h>
+
+#include "common/crypto/key_generator.h"
+#include "common/crypto/signature_verifier.h"
+
+namespace resdb {
+namespace {
+
+// A verifier holding its own public key to verify its signatures.
+std::unique_ptr<SignatureVerifier> GetVerifier(SignatureInfo::HashType type) {
+  SecretKey key = KeyGenerator::GeneratorKeys(type);
+  KeyInfo private_key;
+  private_key.set_key(key.private_key());
+  private_key.set_hash_type(key.hash_type());
+
+  CertificateInfo cert_info;
+  cert_info.set_node_id(1);
+  CertificateKeyInfo* public_key =
+      cert_info.mutable_public_key()->mutable_public_key_info();
+  public_key->mutable_key()->set_key(key.public_key());
+  public_key->mutable_key()->set_hash_type(key.hash_type());
+  public_key->set_node_id(1);
+  return std::make_unique<SignatureVerifier>(private_key, cert_info);
+}
+
+void KeyArgs(benchmark::internal::Benchmark* b) {
+  for (int type : {SignatureInfo::RSA, SignatureInfo::ED25519,
+                   SignatureInfo::CMAC_AES, SignatureInfo::ECDSA}) {
+    for (int size : {64, 1024, 16384}) {
+      b->Args({type, size});
+    }
+  }
+}
+
+void BM_Sign(benchmark::State& state) {
+  auto type = static_cast<SignatureInfo::HashType>(state.range(0));
+  auto verifier = GetVerifier(type);
+  std::string message(state.range(1), 'a');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(verifier->SignMessage(message));
+  }
+  state.SetLabel(SignatureInfo::HashType_Name(type));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Sign)->Apply(KeyArgs);
+
+void BM_Verify(benchmark::State& state) {
+  auto type = static_cast<SignatureInfo::HashType>(state.range(0));
+  auto verifier = GetVerifier(type);
+  std::string message(state.range(1), 'a');
+  absl::StatusOr<SignatureInfo> signature = verifier->SignMessage(message);
+  if (!signature.ok() || !verifier->VerifyMessage(message, *signature)) {
+    state.SkipWithError("sign fail");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(verifier->VerifyMessage(message, *signature));
+  }
+  state.SetLabel(SignatureInfo::HashType_Name(type));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Verify)->Apply(KeyArgs);
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "common/utils/compression.h"
+
+#include <zstd.h>
+
+namespace resdb {
+
+namespace {
+// Reject frames claiming a larger content size to avoid huge allocations.
+constexpr unsigned long long kMaxDecompressedSize = 1ull << 30;
+}  // namespace
+
+absl::StatusOr<std::string> ZstdCompress(const std::string& data, int level) {
+  std::string compressed;
+  compressed.resize(ZSTD_compressBound(data.size()));
+  size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                              data.data(), data.size(), level);
+  if (ZSTD_isError(size)) {
+    return absl::InternalError(ZSTD_getErrorName(size));
+  }
+  compressed.resize(size);
+  return compressed;
+}
+
+absl::StatusOr<std::string> ZstdDecompress(const std::string& data) {
+  unsigned long long raw_size =
+      ZSTD_getFrameContentSize(data.data(), data.size());
+  if (raw_size == ZSTD_CONTENTSIZE_ERROR ||
+      raw_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return absl::InvalidArgumentError("invalid zstd frame");
+  }
+  if (raw_size > kMaxDecompressedSize) {
+    return absl::InvalidArgumentError("zstd frame is too large");
+  }
+  std::string raw;
+  raw.resize(raw_size);
+  size_t size =
+      ZSTD_decompress(raw.data(), raw.size(), data.data(), data.size());
+  if (ZSTD_isError(size)) {
+    return absl::InvalidArgumentError(ZSTD_getErrorName(size));
+  }
+  raw.resize(size);
+  return raw;
+}
+
+}  // namespace resdb
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "common/utils/compression.h"
+
+#include <gtest/gtest.h>
+
+namespace resdb {
+namespace {
+
+TEST(CompressionTest, CompressAndDecompress) {
+  std::string data;
+  for (int i = 0; i < 1000; ++i) {
+    data += "geo_request_" + std::to_string(i % 10);
+  }
+  absl::StatusOr<std::string> compressed = ZstdCompress(data);
+  ASSERT_TRUE(compressed.ok());
+  EXPECT_LT(compressed->size(), data.size());
+
+  absl::StatusOr<std::string> raw = ZstdDecompress(*compressed);
+  ASSERT_TRUE(raw.ok());
+  EXPECT_EQ(*raw, data);
+}
+
+TEST(CompressionTest, CompressEmptyData) {
+  absl::StatusOr<std::string> compressed = ZstdCompress("");
+  ASSERT_TRUE(compressed.ok());
+  absl::StatusOr<std::string> raw = ZstdDecompress(*compressed);
+  ASSERT_TRUE(raw.ok());
+  EXPECT_TRUE(raw->empty());
+}
+
+TEST(CompressionTest, DecompressInvalidData) {
+  EXPECT_FALSE(ZstdDecompress("not a zstd frame").ok());
+}
+
+}  // namespace
+}  // namespace resdb
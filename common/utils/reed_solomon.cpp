@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "common/utils/reed_solomon.h"
+
+#include <glog/logging.h>
+
+#include <array>
+#include <cassert>
+#include <cstring>
+
+namespace resdb {
+
+namespace {
+
+// Size of the header keeping the length of the data.
+constexpr size_t kHeaderSize = sizeof(uint64_t);
+
+// Arithmetic in GF(2^8) generated by x^8 + x^4 + x^3 + x^2 + 1.
+struct GaloisField {
+  std::array<uint8_t, 512> exp;
+  std::array<int, 256> log;
+  // mul[a][b] = a * b.
+  std::array<std::array<uint8_t, 256>, 256> mul;
+
+  GaloisField() {
+    int x = 1;
+    for (int i = 0; i < 255; ++i) {
+      exp[i] = x;
+      log[x] = i;
+      x <<= 1;
+      if (x & 0x100) {
+        x ^= 0x11d;
+      }
+    }
+    for (int i = 255; i < 512; ++i) {
+      exp[i] = exp[i - 255];
+    }
+    log[0] = 0;
+    for (int a = 0; a < 256; ++a) {
+      for (int b = 0; b < 256; ++b) {
+        mul[a][b] = (a == 0 || b == 0) ? 0 : exp[log[a] + log[b]];
+      }
+    }
+  }
+
+  uint8_t Inverse(uint8_t a) const { return exp[255 - log[a]]; }
+};
+
+const GaloisField& GF() {
+  static const GaloisField* gf = new GaloisField();
+  return *gf;
+}
+
+// Invert a square matrix in place by Gauss-Jordan elimination.
+bool Invert(std::vector<std::vector<uint8_t>>* matrix) {
+  const GaloisField& gf = GF();
+  std::vector<std::vector<uint8_t>>& m = *matrix;
+  size_t n = m.size();
+  std::vector<std::vector<uint8_t>> inv(n, std::vector<uint8_t>(n, 0));
+  for (size_t i = 0; i < n; ++i) {
+    inv[i][i] = 1;
+  }
+  for (size_t col = 0; col < n; ++col) {
+    size_t pivot = col;
+    while (pivot < n && m[pivot][col] == 0) {
+      pivot++;
+    }
+    if (pivot == n) {
+      return false;
+    }
+    std::swap(m[pivot], m[col]);
+    std::swap(inv[pivot], inv[col]);
+    uint8_t scale = gf.Inverse(m[col][col]);
+    for (size_t j = 0; j < n; ++j) {
+      m[col][j] = gf.mul[scale][m[col][j]];
+      inv[col][j] = gf.mul[scale][inv[col][j]];
+    }
+    for (size_t row = 0; row < n; ++row) {
+      uint8_t factor = m[row][col];
+      if (row == col || factor == 0) {
+        continue;
+      }
+      for (size_t j = 0; j < n; ++j) {
+        m[row][j] ^= gf.mul[factor][m[col][j]];
+        inv[row][j] ^= gf.mul[factor][inv[col][j]];
+      }
+    }
+  }
+  m = std::move(inv);
+  return true;
+}
+
+}  // namespace
+
+ReedSolomon::ReedSolomon(int data_shards, int total_shards)
+    : data_shards_(data_shards), total_shards_(total_shards) {
+  assert(data_shards_ > 0);
+  assert(total_shards_ >= data_shards_ && total_shards_ <= 256);
+  const GaloisField& gf = GF();
+  // Row i of the parity is 1 / (x_i + y_j) with x_i = data_shards + i and
+  // y_j = j, which never collide.
+  for (int i = data_shards_; i < total_shards_; ++i) {
+    std::vector<uint8_t> row(data_shards_);
+    for (int j = 0; j < data_shards_; ++j) {
+      row[j] = gf.Inverse(i ^ j);
+    }
+    parity_.push_back(std::move(row));
+  }
+}
+
+void ReedSolomon::MulAdd(uint8_t coef, const uint8_t* input, uint8_t* output,
+                         size_t size) const {
+  const std::array<uint8_t, 256>& table = GF().mul[coef];
+  for (size_t i = 0; i < size; ++i) {
+    output[i] ^= table[input[i]];
+  }
+}
+
+std::vector<std::string> ReedSolomon::Encode(const std::string& data) const {
+  size_t shard_size =
+      (kHeaderSize + data.size() + data_shards_ - 1) / data_shards_;
+  std::string buf(shard_size * data_shards_, '\0');
+  uint64_t data_size = data.size();
+  memcpy(buf.data(), &data_size, kHeaderSize);
+  memcpy(buf.data() + kHeaderSize, data.data(), data.size());
+
+  std::vector<std::string> shards(total_shards_);
+  for (int i = 0; i < data_shards_; ++i) {
+    shards[i] = buf.substr(i * shard_size, shard_size);
+  }
+  for (int i = data_shards_; i < total_shards_; ++i) {
+    std::string& shard = shards[i];
+    shard.assign(shard_size, '\0');
+    const std::vector<uint8_t>& row = parity_[i - data_shards_];
+    for (int j = 0; j < data_shards_; ++j) {
+      MulAdd(row[j], reinterpret_cast<const uint8_t*>(shards[j].data()),
+             reinterpret_cast<uint8_t*>(shard.data()), shard_size);
+    }
+  }
+  return shards;
+}
+
+absl::StatusOr<std::string> ReedSolomon::Decode(
+    const std::map<int, std::string>& shards) const {
+  std::vector<const std::string*> inputs;
+  std::vector<int> indexes;
+  for (const auto& it : shards) {
+    if (it.first < 0 || it.first >= total_shards_) {
+      return absl::InvalidArgumentError("invalid shard index");
+    }
+    if (!inputs.empty() && it.second.size() != inputs[0]->size()) {
+      return absl::InvalidArgumentError("shard sizes do not match");
+    }
+    inputs.push_back(&it.second);
+    indexes.push_back(it.first);
+    if (static_cast<int>(inputs.size()) == data_shards_) {
+      break;
+    }
+  }
+  if (static_cast<int>(inputs.size()) < data_shards_) {
+    return absl::InvalidArgumentError("not enough shards");
+  }
+  size_t shard_size = inputs[0]->size();
+  if (shard_size * data_shards_ < kHeaderSize) {
+    return absl::InvalidArgumentError("shards are too small");
+  }
+
+  std::string buf(shard_size * data_shards_, '\0');
+  // Map keys are sorted, so data shard i is present iff indexes[i] == i.
+  bool has_all_data = indexes[data_shards_ - 1] == data_shards_ - 1;
+  if (has_all_data) {
+    for (int i = 0; i < data_shards_; ++i) {
+      memcpy(buf.data() + i * shard_size, inputs[i]->data(), shard_size);
+    }
+  } else {
+    // Rows of the encoding matrix of the received shards.
+    std::vector<std::vector<uint8_t>> matrix;
+    for (int index : indexes) {
+      if (index < data_shards_) {
+        std::vector<uint8_t> row(data_shards_, 0);
+        row[index] = 1;
+        matrix.push_back(std::move(row));
+      } else {
+        matrix.push_back(parity_[index - data_shards_]);
+      }
+    }
+    if (!Invert(&matrix)) {
+      return absl::InternalError("decoding matrix is singular");
+    }
+    for (int i = 0; i < data_shards_; ++i) {
+      uint8_t* output =
+          reinterpret_cast<uint8_t*>(buf.data()) + i * shard_size;
+      for (int j = 0; j < data_shards_; ++j) {
+        MulAdd(matrix[i][j],
+               reinterpret_cast<const uint8_t*>(inputs[j]->data()), output,
+               shard_size);
+      }
+    }
+  }
+
+  uint64_t data_size = 0;
+  memcpy(&data_size, buf.data(), kHeaderSize);
+  if (data_size > buf.size() - kHeaderSize) {
+    return absl::InvalidArgumentError("invalid data size");
+  }
+  return buf.substr(kHeaderSize, data_size);
+}
+
+}  // namespace resdb
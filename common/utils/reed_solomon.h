@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+namespace resdb {
+
+// A systematic Reed-Solomon code over GF(2^8). Data is split into
+// `data_shards` chunks and extended to `total_shards` chunks, any
+// `data_shards` of which rebuild the data. The parity rows come from a
+// Cauchy matrix so that every square sub-matrix is invertible.
+// total_shards must not exceed 256.
+class ReedSolomon {
+ public:
+  ReedSolomon(int data_shards, int total_shards);
+
+  int DataShards() const { return data_shards_; }
+  int TotalShards() const { return total_shards_; }
+
+  // Split data into TotalShards() chunks of the same size. The data size is
+  // encoded in the chunks so that the padding can be removed on decoding.
+  std::vector<std::string> Encode(const std::string& data) const;
+
+  // Rebuild the data from at least DataShards() chunks keyed by their index.
+  absl::StatusOr<std::string> Decode(
+      const std::map<int, std::string>& shards) const;
+
+ private:
+  // output ^= coef * input, byte by byte.
+  void MulAdd(uint8_t coef, const uint8_t* input, uint8_t* output,
+              size_t size) const;
+
+ private:
+  int data_shards_, total_shards_;
+  // (total_shards - data_shards) x data_shards parity rows.
+  std::vector<std::vector<uint8_t>> parity_;
+};
+
+}  // namespace resdb
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+// Measure the encode and decode throughput of ReedSolomon for payloads
+// shared by n replicas, any f+1 of which rebuild the payload.
+// Usage: reed_solomon_benchmark [replica_num] [payload_bytes] [rounds]
+
+#include <glog/logging.h>
+
+#include <chrono>
+#include <cstdlib>
+
+#include "common/utils/reed_solomon.h"
+
+using resdb::ReedSolomon;
+
+namespace {
+
+double ThroughputMBps(size_t bytes, std::chrono::nanoseconds time) {
+  return static_cast<double>(bytes) / 1e6 /
+         std::chrono::duration<double>(time).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int replica_num = argc > 1 ? atoi(argv[1]) : 16;
+  size_t payload_bytes = argc > 2 ? atol(argv[2]) : 1 << 20;
+  int rounds = argc > 3 ? atoi(argv[3]) : 100;
+  if (replica_num < 1 || replica_num > 256 || rounds < 1) {
+    LOG(ERROR) << "invalid arguments";
+    return 1;
+  }
+  int data_shards = (replica_num - 1) / 3 + 1;
+  ReedSolomon codec(data_shards, replica_num);
+
+  std::string data(payload_bytes, '\0');
+  for (size_t i = 0; i < payload_bytes; ++i) {
+    data[i] = static_cast<char>(rand());
+  }
+
+  std::vector<std::string> shards;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    shards = codec.Encode(data);
+  }
+  auto encode_time = std::chrono::steady_clock::now() - start;
+
+  // Decode from the parity shards only, which is the most expensive case.
+  std::map<int, std::string> received;
+  for (int i = replica_num - 1; i >= 0; --i) {
+    if (static_cast<int>(received.size()) == data_shards) {
+      break;
+    }
+    received[i] = shards[i];
+  }
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    absl::StatusOr<std::string> ret = codec.Decode(received);
+    if (!ret.ok() || *ret != data) {
+      LOG(ERROR) << "decode fail";
+      return 1;
+    }
+  }
+  auto decode_time = std::chrono::steady_clock::now() - start;
+
+  size_t total_bytes = payload_bytes * rounds;
+  printf("replicas:%d data shards:%d payload:%zu bytes shard:%zu bytes\n",
+         replica_num, data_shards, payload_bytes, shards[0].size());
+  printf("sender egress: %.2fx of the payload, %.2fx without coding\n",
+         static_cast<double>(shards[0].size() * replica_num) / payload_bytes,
+         static_cast<double>(replica_num));
+  printf("encode: %.2f MB/s\n", ThroughputMBps(total_bytes, encode_time));
+  printf("decode: %.2f MB/s\n", ThroughputMBps(total_bytes, decode_time));
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "common/utils/reed_solomon.h"
+
+#include <gtest/gtest.h>
+
+namespace resdb {
+namespace {
+
+std::string GetData(size_t size) {
+  std::string data(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<char>(i * 131 + 7);
+  }
+  return data;
+}
+
+TEST(ReedSolomonTest, DecodeFromDataShards) {
+  ReedSolomon codec(2, 4);
+  std::string data = GetData(1000);
+  std::vector<std::string> shards = codec.Encode(data);
+  ASSERT_EQ(shards.size(), 4);
+  EXPECT_EQ(shards[0].size(), shards[3].size());
+
+  absl::StatusOr<std::string> ret =
+      codec.Decode({{0, shards[0]}, {1, shards[1]}});
+  ASSERT_TRUE(ret.ok());
+  EXPECT_EQ(*ret, data);
+}
+
+TEST(ReedSolomonTest, DecodeFromAnySubset) {
+  const int data_shards = 3, total_shards = 7;
+  ReedSolomon codec(data_shards, total_shards);
+  std::string data = GetData(4097);
+  std::vector<std::string> shards = codec.Encode(data);
+  for (int mask = 0; mask < (1 << total_shards); ++mask) {
+    if (__builtin_popcount(mask) != data_shards) {
+      continue;
+    }
+    std::map<int, std::string> received;
+    for (int i = 0; i < total_shards; ++i) {
+      if (mask & (1 << i)) {
+        received[i] = shards[i];
+      }
+    }
+    absl::StatusOr<std::string> ret = codec.Decode(received);
+    ASSERT_TRUE(ret.ok()) << "mask:" << mask;
+    EXPECT_EQ(*ret, data) << "mask:" << mask;
+  }
+}
+
+TEST(ReedSolomonTest, EmptyData) {
+  ReedSolomon codec(2, 4);
+  std::vector<std::string> shards = codec.Encode("");
+  absl::StatusOr<std::string> ret =
+      codec.Decode({{2, shards[2]}, {3, shards[3]}});
+  ASSERT_TRUE(ret.ok());
+  EXPECT_TRUE(ret->empty());
+}
+
+TEST(ReedSolomonTest, NotEnoughShards) {
+  ReedSolomon codec(3, 4);
+  std::vector<std::string> shards = codec.Encode(GetData(100));
+  EXPECT_FALSE(codec.Decode({{0, shards[0]}, {3, shards[3]}}).ok());
+  EXPECT_FALSE(codec.Decode({{0, shards[0]}, {1, shards[1]}, {5, "a"}}).ok());
+  EXPECT_FALSE(codec.Decode({{0, shards[0]}, {1, shards[1]}, {2, "a"}}).ok());
+}
+
+}  // namespace
+}  // namespace resdb
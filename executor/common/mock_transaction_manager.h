@@ -44,6 +44,10 @@ class MockTransactionManager : public MockTransactionExecutorDataImpl {
       : MockTransactionExecutorDataImpl(is_out_of_order) {}
   MOCK_METHOD(std::unique_ptr<BatchUserResponse>, ExecuteBatch,
               (const BatchUserRequest&), (override));
+  MOCK_METHOD(std::unique_ptr<std::vector<std::string>>, GetConflictKeys,
+              (const BatchUserRequest&), (override));
+  MOCK_METHOD(void, CommitState, (uint64_t), (override));
+  MOCK_METHOD(int, ApplyStateChunk, (const StateChunk&), (override));
 };
 
 }  // namespace resdb
@@ -41,6 +41,22 @@ std::unique_ptr<std::string> TransactionManager::ExecuteData(
   return std::make_unique<std::string>();
 }
 
+std::unique_ptr<std::vector<std::string>> TransactionManager::GetConflictKeys(
+    const BatchUserRequest& request) {
+  return nullptr;
+}
+
+void TransactionManager::CommitState(uint64_t seq) {}
+
+std::string TransactionManager::CheckPointState() { return ""; }
+
+std::unique_ptr<StateChunk> TransactionManager::GetStateChunk(uint64_t seq,
+                                                              uint32_t index) {
+  return nullptr;
+}
+
+int TransactionManager::ApplyStateChunk(const StateChunk& chunk) { return -1; }
+
 std::unique_ptr<BatchUserResponse> TransactionManager::ExecuteBatch(
     const BatchUserRequest& request) {
   std::unique_ptr<BatchUserResponse> batch_response =
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "chain/storage/storage.h"
 #include "platform/proto/resdb.pb.h"
@@ -48,12 +49,37 @@ class TransactionManager {
 
   virtual std::unique_ptr<std::string> ExecuteData(const std::string& request);
 
+  // Return the keys read or written by the batch. Batches with disjoint keys
+  // may be executed concurrently, so ExecuteBatch() must be thread safe for
+  // them if the keys are provided. Return nullptr if the keys are unknown and
+  // the batch will be executed in order.
+  virtual std::unique_ptr<std::vector<std::string>> GetConflictKeys(
+      const BatchUserRequest& request);
+
   bool IsOutOfOrder();
 
   bool NeedResponse();
 
   virtual Storage* GetStorage() { return nullptr; };
 
+  // Publish the state after the batches up to seq, e.g. as a snapshot for the
+  // reads. It is called by one thread with increasing seqs, once all the
+  // batches up to seq are done and none after seq has started.
+  virtual void CommitState(uint64_t seq);
+
+  // Return the commitment of the state after the last executed batch and
+  // keep that state for GetStateChunk(). Return an empty string if the state
+  // has no commitment.
+  virtual std::string CheckPointState();
+
+  // Return the chunk `index` of the state kept at seq, or nullptr if the
+  // state at seq is not kept.
+  virtual std::unique_ptr<StateChunk> GetStateChunk(uint64_t seq,
+                                                    uint32_t index);
+
+  // Replace the part of the state in a verified chunk with its key-values.
+  virtual int ApplyStateChunk(const StateChunk& chunk);
+
  private:
   bool is_out_of_order_ = false;
   bool need_response_ = true;
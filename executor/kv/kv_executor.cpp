@@ -27,6 +27,8 @@
 
 #include <glog/logging.h>
 
+#include <set>
+
 #include "proto/kv/kv.pb.h"
 
 namespace resdb {
@@ -62,6 +64,71 @@ std::unique_ptr<std::string> KVExecutor::ExecuteData(
   return resp_str;
 }
 
+std::unique_ptr<std::vector<std::string>> KVExecutor::GetConflictKeys(
+    const BatchUserRequest& request) {
+  auto keys = std::make_unique<std::vector<std::string>>();
+  for (auto& sub_request : request.user_requests()) {
+    KVRequest kv_request;
+    if (!kv_request.ParseFromString(sub_request.request().data())) {
+      return nullptr;
+    }
+    if (kv_request.cmd() != KVRequest::SET &&
+        kv_request.cmd() != KVRequest::GET) {
+      return nullptr;
+    }
+    keys->push_back(kv_request.key());
+  }
+  return keys;
+}
+
+void KVExecutor::CommitState(uint64_t seq) { state_->Commit(seq); }
+
+std::string KVExecutor::CheckPointState() { return state_->CheckPointState(); }
+
+std::unique_ptr<StateChunk> KVExecutor::GetStateChunk(uint64_t seq,
+                                                      uint32_t index) {
+  StateMerkleTree::Chunk chunk;
+  if (state_->GetStateChunk(seq, index, &chunk)) {
+    return nullptr;
+  }
+  std::unique_ptr<StateChunk> state_chunk = std::make_unique<StateChunk>();
+  state_chunk->set_seq(seq);
+  state_chunk->set_index(index);
+  state_chunk->set_chunk_num(state_->GetStateChunkNum());
+  for (auto& kv : chunk.kvs) {
+    state_chunk->add_keys(std::move(kv.first));
+    state_chunk->add_values(std::move(kv.second));
+  }
+  for (auto& hash : chunk.proof) {
+    state_chunk->add_proof(std::move(hash));
+  }
+  return state_chunk;
+}
+
+int KVExecutor::ApplyStateChunk(const StateChunk& chunk) {
+  if (chunk.keys_size() != chunk.values_size() ||
+      chunk.index() >= state_->GetStateChunkNum()) {
+    return -2;
+  }
+  // Clear the local keys of the chunk that are not in the installed state.
+  std::set<std::string> keys(chunk.keys().begin(), chunk.keys().end());
+  for (const std::string& key : state_->GetStateChunkKeys(chunk.index())) {
+    if (keys.find(key) == keys.end()) {
+      int ret = state_->SetValue(key, "");
+      if (ret < 0) {
+        return ret;
+      }
+    }
+  }
+  for (int i = 0; i < chunk.keys_size(); ++i) {
+    int ret = state_->SetValue(chunk.keys(i), chunk.values(i));
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
 void KVExecutor::Set(const std::string& key, const std::string& value) {
   state_->SetValue(key, value);
 }
@@ -78,4 +145,40 @@ std::string KVExecutor::GetRange(const std::string& min_key,
   return state_->GetRange(min_key, max_key);
 }
 
+KVQuery::KVQuery(ChainState* state) : state_(state) {}
+
+std::unique_ptr<std::string> KVQuery::Query(const std::string& request_str) {
+  KVRequest kv_request;
+  KVResponse kv_response;
+
+  if (!kv_request.ParseFromString(request_str)) {
+    LOG(ERROR) << "parse data fail";
+    return nullptr;
+  }
+
+  std::shared_ptr<ChainState::Snapshot> snapshot = state_->GetSnapshot();
+  if (snapshot == nullptr || snapshot->GetSeq() < kv_request.min_seq()) {
+    return nullptr;
+  }
+
+  if (kv_request.cmd() == KVRequest::GET) {
+    kv_response.set_value(snapshot->GetValue(kv_request.key()));
+  } else if (kv_request.cmd() == KVRequest::GETVALUES) {
+    kv_response.set_value(snapshot->GetAllValues());
+  } else if (kv_request.cmd() == KVRequest::GETRANGE) {
+    kv_response.set_value(
+        snapshot->GetRange(kv_request.key(), kv_request.value()));
+  } else {
+    LOG(ERROR) << "not a read-only request:" << kv_request.cmd();
+    return nullptr;
+  }
+  kv_response.set_seq(snapshot->GetSeq());
+
+  std::unique_ptr<std::string> resp_str = std::make_unique<std::string>();
+  if (!kv_response.SerializeToString(resp_str.get())) {
+    return nullptr;
+  }
+  return resp_str;
+}
+
 }  // namespace resdb
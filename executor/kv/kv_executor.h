@@ -30,6 +30,7 @@
 #include <unordered_map>
 
 #include "chain/state/chain_state.h"
+#include "executor/common/custom_query.h"
 #include "executor/common/transaction_manager.h"
 #include "platform/config/resdb_config_utils.h"
 
@@ -42,6 +43,19 @@ class KVExecutor : public TransactionManager {
 
   std::unique_ptr<std::string> ExecuteData(const std::string& request) override;
 
+  // Return the keys of the SET and GET requests, or nullptr if the batch
+  // reads a range or all the values.
+  std::unique_ptr<std::vector<std::string>> GetConflictKeys(
+      const BatchUserRequest& request) override;
+
+  // Publish a state snapshot tagged with seq.
+  void CommitState(uint64_t seq) override;
+
+  std::string CheckPointState() override;
+  std::unique_ptr<StateChunk> GetStateChunk(uint64_t seq,
+                                            uint32_t index) override;
+  int ApplyStateChunk(const StateChunk& chunk) override;
+
  protected:
   virtual void Set(const std::string& key, const std::string& value);
   std::string Get(const std::string& key);
@@ -52,4 +66,17 @@ class KVExecutor : public TransactionManager {
   std::unique_ptr<ChainState> state_;
 };
 
+// Serve the read-only requests (GET, GETVALUES, GETRANGE) from the latest
+// state snapshot published by KVExecutor, without going through consensus.
+class KVQuery : public CustomQuery {
+ public:
+  KVQuery(ChainState* state);
+  virtual ~KVQuery() = default;
+
+  std::unique_ptr<std::string> Query(const std::string& request_str) override;
+
+ private:
+  ChainState* state_;
+};
+
 }  // namespace resdb
@@ -28,6 +28,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "chain/storage/mock_storage.h"
 #include "platform/config/resdb_config_utils.h"
 #include "proto/kv/kv.pb.h"
@@ -162,6 +164,139 @@ TEST_F(KVExecutorTest, SetValue) {
   EXPECT_EQ(GetRange("a", "z"), "[test_value]");
 }
 
+TEST(KVExecutorConflictTest, GetConflictKeys) {
+  KVExecutor executor(std::make_unique<ChainState>());
+
+  auto add_request = [](BatchUserRequest* batch_request, KVRequest::CMD cmd,
+                        const std::string& key) {
+    KVRequest request;
+    request.set_cmd(cmd);
+    request.set_key(key);
+    request.SerializeToString(
+        batch_request->add_user_requests()->mutable_request()->mutable_data());
+  };
+
+  BatchUserRequest batch_request;
+  add_request(&batch_request, KVRequest::SET, "key1");
+  add_request(&batch_request, KVRequest::GET, "key2");
+  std::unique_ptr<std::vector<std::string>> keys =
+      executor.GetConflictKeys(batch_request);
+  ASSERT_NE(keys, nullptr);
+  EXPECT_EQ(*keys, std::vector<std::string>({"key1", "key2"}));
+
+  // A range read conflicts with every batch.
+  add_request(&batch_request, KVRequest::GETRANGE, "key1");
+  EXPECT_EQ(executor.GetConflictKeys(batch_request), nullptr);
+}
+
+TEST(KVExecutorConflictTest, ExecuteDisjointBatchesConcurrently) {
+  auto state = std::make_unique<ChainState>();
+  ChainState* state_ptr = state.get();
+  KVExecutor executor(std::move(state));
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i <= 4; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int seq = i; seq <= 400; seq += 4) {
+        KVRequest request;
+        request.set_cmd(KVRequest::SET);
+        request.set_key("key" + std::to_string(i));
+        request.set_value(std::to_string(seq));
+        BatchUserRequest batch_request;
+        batch_request.set_seq(seq);
+        request.SerializeToString(batch_request.add_user_requests()
+                                      ->mutable_request()
+                                      ->mutable_data());
+        executor.ExecuteBatch(batch_request);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  executor.CommitState(400);
+
+  std::shared_ptr<ChainState::Snapshot> snapshot = state_ptr->GetSnapshot();
+  EXPECT_EQ(snapshot->GetSeq(), 400);
+  EXPECT_EQ(state_ptr->GetLastExecutedSeq(), 400);
+  for (int i = 1; i <= 4; ++i) {
+    EXPECT_EQ(snapshot->GetValue("key" + std::to_string(i)),
+              std::to_string(396 + i));
+  }
+}
+
+TEST(KVExecutorStateTest, ApplyStateChunk) {
+  auto source_state = std::make_unique<ChainState>();
+  source_state->SetValue("key1", "value3");
+  source_state->Commit(1);
+  KVExecutor source(std::move(source_state));
+  std::string root = source.CheckPointState();
+
+  auto state = std::make_unique<ChainState>();
+  ChainState* state_ptr = state.get();
+  state_ptr->SetValue("key1", "value1");
+  state_ptr->SetValue("key2", "value2");
+  KVExecutor executor(std::move(state));
+  for (uint32_t i = 0; i < state_ptr->GetStateChunkNum(); ++i) {
+    std::unique_ptr<StateChunk> chunk = source.GetStateChunk(1, i);
+    ASSERT_NE(chunk, nullptr);
+    EXPECT_EQ(executor.ApplyStateChunk(*chunk), 0);
+  }
+  // The local keys missing from the chunks are cleared.
+  EXPECT_EQ(state_ptr->GetStateRoot(), root);
+  EXPECT_EQ(state_ptr->GetValue("key1"), "value3");
+  EXPECT_EQ(state_ptr->GetValue("key2"), "");
+}
+
+TEST(KVQueryTest, QueryFromSnapshot) {
+  auto state = std::make_unique<ChainState>();
+  ChainState* state_ptr = state.get();
+  KVExecutor executor(std::move(state));
+  KVQuery query(state_ptr);
+
+  auto query_value = [&](const std::string& key, uint64_t min_seq) {
+    KVRequest request;
+    request.set_cmd(KVRequest::GET);
+    request.set_key(key);
+    request.set_min_seq(min_seq);
+    std::string str;
+    request.SerializeToString(&str);
+    return query.Query(str);
+  };
+
+  // No snapshot has been published.
+  EXPECT_EQ(query_value("test_key", 0), nullptr);
+
+  KVRequest set_request;
+  set_request.set_cmd(KVRequest::SET);
+  set_request.set_key("test_key");
+  set_request.set_value("test_value");
+
+  BatchUserRequest batch_request;
+  batch_request.set_seq(1);
+  set_request.SerializeToString(
+      batch_request.add_user_requests()->mutable_request()->mutable_data());
+  executor.ExecuteBatch(batch_request);
+  // The value is not visible before the state is committed.
+  EXPECT_EQ(query_value("test_key", 0), nullptr);
+  executor.CommitState(1);
+
+  std::unique_ptr<std::string> resp = query_value("test_key", 1);
+  ASSERT_NE(resp, nullptr);
+  KVResponse kv_response;
+  ASSERT_TRUE(kv_response.ParseFromString(*resp));
+  EXPECT_EQ(kv_response.value(), "test_value");
+  EXPECT_EQ(kv_response.seq(), 1);
+
+  // The state has not reached seq 2.
+  EXPECT_EQ(query_value("test_key", 2), nullptr);
+
+  // Write requests are not served.
+  std::string str;
+  set_request.SerializeToString(&str);
+  EXPECT_EQ(query.Query(str), nullptr);
+}
+
 }  // namespace
 
 }  // namespace resdb
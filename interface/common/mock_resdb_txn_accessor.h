@@ -38,6 +38,10 @@ class MockResDBTxnAccessor : public ResDBTxnAccessor {
 
   MOCK_METHOD((absl::StatusOr<std::vector<std::pair<uint64_t, std::string>>>),
               GetTxn, (uint64_t, uint64_t), (override));
+  MOCK_METHOD(absl::StatusOr<std::vector<Request>>, GetRequestFromReplica,
+              (uint64_t, uint64_t, const ReplicaInfo&), (override));
+  MOCK_METHOD(absl::StatusOr<StateChunk>, GetStateChunkFromReplica,
+              (uint64_t, uint32_t, const ReplicaInfo&), (override));
 };
 
 }  // namespace resdb
@@ -153,4 +153,35 @@ absl::StatusOr<std::vector<Request>> ResDBTxnAccessor::GetRequestFromReplica(
   return txn_resp;
 }
 
+absl::StatusOr<StateChunk> ResDBTxnAccessor::GetStateChunkFromReplica(
+    uint64_t seq, uint32_t index, const ReplicaInfo& replica) {
+  StateChunkRequest request;
+  request.set_seq(seq);
+  request.set_index(index);
+
+  std::unique_ptr<NetChannel> client =
+      GetNetChannel(replica.ip(), replica.port());
+
+  std::string response_str;
+  int ret = client->SendRequest(request, Request::TYPE_STATE_QUERY);
+  if (ret) {
+    return absl::InternalError("send data fail.");
+  }
+  client->SetRecvTimeout(1000);
+  ret = client->RecvRawMessageStr(&response_str);
+  if (ret) {
+    return absl::InternalError("recv data fail.");
+  }
+
+  StateChunk chunk;
+  if (!chunk.ParseFromString(response_str)) {
+    LOG(ERROR) << "parse fail len:" << response_str.size();
+    return absl::InternalError("recv data fail.");
+  }
+  if (chunk.seq() != seq || chunk.index() != index) {
+    return absl::NotFoundError("state chunk not found.");
+  }
+  return chunk;
+}
+
 }  // namespace resdb
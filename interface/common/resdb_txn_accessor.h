@@ -46,6 +46,10 @@ class ResDBTxnAccessor {
   virtual absl::StatusOr<std::vector<Request>> GetRequestFromReplica(
       uint64_t min_seq, uint64_t max_seq, const ReplicaInfo& replica);
 
+  // Obtain the chunk `index` of the state kept at the checkpoint seq.
+  virtual absl::StatusOr<StateChunk> GetStateChunkFromReplica(
+      uint64_t seq, uint32_t index, const ReplicaInfo& replica);
+
  protected:
   virtual std::unique_ptr<NetChannel> GetNetChannel(const std::string& ip,
                                                     int port);
@@ -27,12 +27,14 @@
 
 #include <glog/logging.h>
 
-#include "proto/kv/kv.pb.h"
+#include <map>
 
 namespace resdb {
 
 KVClient::KVClient(const ResDBConfig& config)
-    : TransactionConstructor(config) {}
+    : TransactionConstructor(config),
+      query_replica_num_(config.GetMinDataReceiveNum()),
+      min_match_num_(config.GetMinClientReceiveNum()) {}
 
 int KVClient::Set(const std::string& key, const std::string& data) {
   KVRequest request;
@@ -82,4 +84,63 @@ std::unique_ptr<std::string> KVClient::GetRange(const std::string& min_key,
   return std::make_unique<std::string>(response.value());
 }
 
+std::unique_ptr<std::string> KVClient::ReadOnlyGet(const std::string& key,
+                                                   uint64_t min_seq) {
+  KVRequest request;
+  request.set_cmd(KVRequest::GET);
+  request.set_key(key);
+  request.set_min_seq(min_seq);
+  std::unique_ptr<std::string> value = ReadOnlyRequest(request);
+  if (value == nullptr) {
+    return Get(key);
+  }
+  return value;
+}
+
+std::unique_ptr<std::string> KVClient::ReadOnlyGetRange(
+    const std::string& min_key, const std::string& max_key, uint64_t min_seq) {
+  KVRequest request;
+  request.set_cmd(KVRequest::GETRANGE);
+  request.set_key(min_key);
+  request.set_value(max_key);
+  request.set_min_seq(min_seq);
+  std::unique_ptr<std::string> value = ReadOnlyRequest(request);
+  if (value == nullptr) {
+    return GetRange(min_key, max_key);
+  }
+  return value;
+}
+
+uint64_t KVClient::GetLastReadSeq() const { return last_read_seq_; }
+
+std::unique_ptr<std::string> KVClient::ReadOnlyRequest(
+    const KVRequest& request) {
+  // value -> {number of replicas, min seq among them}
+  // The smallest seq of the matching replicas is reported so that a faulty
+  // replica cannot inflate the seq returned by GetLastReadSeq().
+  std::map<std::string, std::pair<size_t, uint64_t>> votes;
+  for (const std::string& resp_str :
+       SendCustomQuery(request, query_replica_num_)) {
+    KVResponse response;
+    if (!response.ParseFromString(resp_str)) {
+      LOG(ERROR) << "parse response fail:" << resp_str.size();
+      continue;
+    }
+    // Replicas which are behind min_seq do not set the seq.
+    if (response.seq() == 0 || response.seq() < request.min_seq()) {
+      continue;
+    }
+    auto& vote = votes[response.value()];
+    vote.second = vote.first == 0 ? response.seq()
+                                  : std::min(vote.second, response.seq());
+    vote.first++;
+    if (vote.first >= min_match_num_) {
+      last_read_seq_ = std::max(last_read_seq_, vote.second);
+      return std::make_unique<std::string>(response.value());
+    }
+  }
+  LOG(ERROR) << "read-only responses do not match, use ordered request.";
+  return nullptr;
+}
+
 }  // namespace resdb
@@ -26,6 +26,7 @@
 #pragma once
 
 #include "interface/rdbc/transaction_constructor.h"
+#include "proto/kv/kv.pb.h"
 
 namespace resdb {
 
@@ -39,6 +40,28 @@ class KVClient : public TransactionConstructor {
   std::unique_ptr<std::string> GetValues();
   std::unique_ptr<std::string> GetRange(const std::string& min_key,
                                         const std::string& max_key);
+
+  // Read from the committed state of the replicas without ordering the
+  // request. The result is accepted once f+1 replicas return the same value
+  // from a state which has executed the transactions up to min_seq.
+  // If the responses disagree, it falls back to the ordered request.
+  std::unique_ptr<std::string> ReadOnlyGet(const std::string& key,
+                                           uint64_t min_seq = 0);
+  std::unique_ptr<std::string> ReadOnlyGetRange(const std::string& min_key,
+                                                const std::string& max_key,
+                                                uint64_t min_seq = 0);
+
+  // The seq of the state serving the last accepted read-only request.
+  // It can be used as min_seq to keep the following reads monotonic.
+  uint64_t GetLastReadSeq() const;
+
+ private:
+  std::unique_ptr<std::string> ReadOnlyRequest(const KVRequest& request);
+
+ private:
+  size_t query_replica_num_;
+  size_t min_match_num_;
+  uint64_t last_read_seq_ = 0;
 };
 
 }  // namespace resdb
@@ -27,6 +27,8 @@
 
 #include <glog/logging.h>
 
+#include <future>
+
 namespace resdb {
 
 TransactionConstructor::TransactionConstructor(const ResDBConfig& config)
@@ -92,4 +94,41 @@ int TransactionConstructor::SendRequest(
   return -1;
 }
 
+std::vector<std::string> TransactionConstructor::SendCustomQuery(
+    const google::protobuf::Message& message, size_t replica_num) {
+  const std::vector<ReplicaInfo>& replicas = config_.GetReplicaInfos();
+  replica_num = std::min(replica_num, replicas.size());
+
+  std::vector<std::future<absl::StatusOr<std::string>>> resps;
+  for (size_t i = 0; i < replica_num; ++i) {
+    resps.push_back(std::async(
+        std::launch::async,
+        [&](const ReplicaInfo& replica) -> absl::StatusOr<std::string> {
+          NetChannel channel(replica.ip(), replica.port());
+          channel.SetSignatureVerifier(verifier_);
+          channel.SetRecvTimeout(timeout_ms_);
+          if (channel.SendRequest(message, Request::TYPE_CUSTOM_QUERY) != 0) {
+            return absl::UnavailableError("send request fail");
+          }
+          CustomQueryResponse response;
+          if (channel.RecvRawMessage(&response) != 0) {
+            return absl::UnavailableError("recv response fail");
+          }
+          return response.resp_str();
+        },
+        replicas[i]));
+  }
+
+  std::vector<std::string> resp_data;
+  for (auto& resp : resps) {
+    absl::StatusOr<std::string> data = resp.get();
+    if (!data.ok()) {
+      LOG(ERROR) << "query replica fail:" << data.status();
+      continue;
+    }
+    resp_data.push_back(std::move(*data));
+  }
+  return resp_data;
+}
+
 }  // namespace resdb
@@ -46,6 +46,11 @@ class TransactionConstructor : public NetChannel {
                   google::protobuf::Message* response,
                   Request::Type type = Request::TYPE_CLIENT_REQUEST);
 
+  // Send a custom query to the first replica_num replicas in parallel and
+  // return the response data from the replicas responding before the timeout.
+  std::vector<std::string> SendCustomQuery(
+      const google::protobuf::Message& message, size_t replica_num);
+
  private:
   absl::StatusOr<std::string> GetResponseData(const Response& response);
 
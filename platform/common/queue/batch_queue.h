@@ -27,59 +27,38 @@
 
 #include <glog/logging.h>
 
-#include <condition_variable>
-#include <list>
+#include "platform/common/queue/mpmc_queue.h"
 
 namespace resdb {
 
+// BatchQueue pops the items in batches of up to batch_size. It is an
+// MPMCQueue, so Push() waits for room once the capacity is reached.
 template <typename T>
 class BatchQueue {
-  struct BatchQueueItem {
-    std::vector<T> list;
-  };
-
  public:
   int num = 0;
   BatchQueue() = default;
-  BatchQueue(const std::string& name, int batch_size)
-      : name_(name), batch_size_(batch_size) {}
-  void Push(T&& data) {
-    std::lock_guard<std::mutex> lk(mutex_);
-    if (queue_.empty() || queue_.back()->list.size() >= batch_size_) {
-      queue_.push_back(std::make_unique<BatchQueueItem>());
-      queue_.back()->list.reserve(batch_size_);
-    }
-    queue_.back()->list.push_back(std::move(data));
-    cv_.notify_all();
-  }
+  BatchQueue(const std::string& name, int batch_size,
+             size_t capacity = MPMCQueue<T>::kDefaultCapacity)
+      : batch_size_(batch_size), queue_(name, capacity) {}
 
-  size_t Size() { return queue_.size(); }
+  void Push(T&& data) { queue_.Push(std::move(data)); }
 
+  // The number of batches.
+  size_t Size() { return (queue_.Size() + batch_size_ - 1) / batch_size_; }
+
+  // Wait up to timeout_ms microseconds for a full batch and return the
+  // items queued, up to batch_size.
   std::vector<T> Pop(int timeout_ms) {
-    std::unique_ptr<BatchQueueItem> item = nullptr;
-    {
-      std::unique_lock<std::mutex> lk(mutex_);
-      if (timeout_ms > 0) {
-        cv_.wait_for(lk, std::chrono::microseconds(timeout_ms), [&] {
-          return !queue_.empty() && queue_.front()->list.size() >= batch_size_;
-        });
-      }
-      if (queue_.empty()) {
-        return std::vector<T>();
-      }
-      item = std::move(queue_.front());
-      queue_.pop_front();
-    }
-    return std::move(item->list);
+    std::vector<T> list;
+    list.reserve(batch_size_);
+    queue_.PopBatch(&list, batch_size_, timeout_ms);
+    return list;
   }
 
  private:
-  std::string name_;
-  std::condition_variable cv_;
-  std::mutex mutex_;
-  //  std::queue<T> queue_ GUARDED_BY(mutex_);
-  std::list<std::unique_ptr<BatchQueueItem>> queue_;
-  size_t batch_size_;
+  size_t batch_size_ = 1;
+  MPMCQueue<T> queue_;
 };
 
 }  // namespace resdb
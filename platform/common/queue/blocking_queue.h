@@ -27,85 +27,43 @@
 
 #include <glog/logging.h>
 
-#include <condition_variable>
-#include <queue>
-
 #include "absl/status/statusor.h"
+#include "platform/common/queue/mpmc_queue.h"
 
 namespace resdb {
 
+// A queue of pointer-like items whose pops return nullptr on timeout. It is
+// an MPMCQueue, so Push() waits for room once the capacity is reached.
 template <typename T>
 class BlockingQueue {
  public:
-  BlockingQueue() = default;
-  BlockingQueue(const std::string& name) : name_(name) {}
-  void Push(T&& data) {
-    std::lock_guard<std::mutex> lk(mutex_);
-    queue_.push(std::move(data));
-    cv_.notify_all();
-  }
+  BlockingQueue(const std::string& name = "",
+                size_t capacity = MPMCQueue<T>::kDefaultCapacity)
+      : queue_(name, capacity) {}
 
-  void Push(T& data) {
-    std::lock_guard<std::mutex> lk(mutex_);
-    queue_.push(std::move(data));
-    cv_.notify_all();
-  }
+  void Push(T&& data) { queue_.Push(std::move(data)); }
 
-  absl::StatusOr<T*> Front() {
-    std::unique_lock<std::mutex> lk(mutex_);
-    if (queue_.empty()) {
-      return nullptr;
-    }
-    return &queue_.front();
-  }
+  void Push(T& data) { queue_.Push(std::move(data)); }
 
-  T Pop() {
-    std::unique_lock<std::mutex> lk(mutex_);
-    cv_.wait_for(lk, std::chrono::microseconds(timeout_ms_),
-                 [&] { return !queue_.empty(); });
+  absl::StatusOr<T*> Front() { return queue_.Front(); }
 
-    if (queue_.empty()) {
-      return nullptr;
-    }
-    auto resp = std::move(queue_.front());
-    queue_.pop();
-    return resp;
-  }
+  T Pop() { return Pop(timeout_ms_); }
 
   T Pop(int timeout_ms) {
-    std::unique_lock<std::mutex> lk(mutex_);
-    if (timeout_ms > 0) {
-      cv_.wait_for(lk, std::chrono::microseconds(timeout_ms),
-                   [&] { return !queue_.empty(); });
-    }
-    if (queue_.empty()) {
+    T data;
+    if (!queue_.Pop(&data, timeout_ms)) {
       return nullptr;
     }
-    auto resp = std::move(queue_.front());
-    queue_.pop();
-    return resp;
+    return data;
   }
 
   T PopWithSize(int timeout_ms, size_t size) {
-    std::unique_lock<std::mutex> lk(mutex_);
-    if (timeout_ms > 0) {
-      cv_.wait_for(lk, std::chrono::microseconds(timeout_ms),
-                   [&] { return queue_.size() >= size; });
-    }
-    if (queue_.empty()) {
-      return nullptr;
-    }
-    auto resp = std::move(queue_.front());
-    queue_.pop();
-    return resp;
+    queue_.WaitForSize(size, timeout_ms);
+    return Pop(0);
   }
 
  private:
-  std::string name_;
-  std::condition_variable cv_;
-  std::mutex mutex_;
-  //  std::queue<T> queue_ GUARDED_BY(mutex_);
-  std::queue<T> queue_;
+  MPMCQueue<T> queue_;
   int64_t timeout_ms_ = 500;  // microsecond for timeout.
 };
 
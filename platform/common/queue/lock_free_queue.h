@@ -31,18 +31,23 @@
 #include <condition_variable>
 
 #include "absl/status/statusor.h"
+#include "platform/common/queue/queue_metrics.h"
 
 namespace resdb {
 
 template <typename T>
 class LockFreeQueue {
  public:
-  LockFreeQueue(const std::string& name = "") : name_(name), queue_(4096) {}
+  LockFreeQueue(const std::string& name = "")
+      : name_(name), queue_(4096), metrics_(QueueMetrics::Get(name)) {}
   void Push(std::unique_ptr<T> data) {
-    T* ptr = data.release();
-    while (!queue_.push(ptr)) {
+    Item item = {data.release(), metrics_ ? QueueMetrics::GetTime() : 0};
+    while (!queue_.push(item)) {
       LOG(ERROR) << "push data:" << name_ << " fail";
     }
+    if (metrics_) {
+      metrics_->Push();
+    }
     if (need_notify_.load()) {
       bool old_v = true;
       if (need_notify_.compare_exchange_strong(old_v, false,
@@ -56,7 +61,7 @@ class LockFreeQueue {
   }
 
   std::unique_ptr<T> Pop(int timeout_ms = 100) {
-    T* ret = nullptr;
+    Item ret;
     if (!queue_.pop(ret)) {
       if (timeout_ms > 0) {
         std::unique_lock<std::mutex> lk(mutex_);
@@ -64,18 +69,33 @@ class LockFreeQueue {
         cv_.wait_for(lk, std::chrono::milliseconds(timeout_ms),
                      [&] { return !need_notify_.load(); });
         if (queue_.pop(ret)) {
-          return std::unique_ptr<T>(ret);
+          return Release(ret);
         }
       }
       return nullptr;
     }
-    return std::unique_ptr<T>(ret);
+    return Release(ret);
   }
   bool Empty() { return queue_.empty(); }
 
+ private:
+  struct Item {
+    T* data;
+    // The time of pushing the data if the metrics are enabled.
+    uint64_t push_time;
+  };
+
+  std::unique_ptr<T> Release(const Item& item) {
+    if (metrics_) {
+      metrics_->Pop(item.push_time);
+    }
+    return std::unique_ptr<T>(item.data);
+  }
+
  private:
   std::string name_;
-  boost::lockfree::queue<T*> queue_;
+  boost::lockfree::queue<Item> queue_;
+  QueueMetrics* metrics_;
   std::condition_variable cv_;
   std::mutex mutex_;
   std::atomic<bool> need_notify_;
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "platform/common/queue/queue_metrics.h"
+
+namespace resdb {
+
+// MPMCQueue is a bounded queue of multiple producers and consumers on a ring
+// of preallocated slots, so pushing and popping neither lock nor allocate.
+// Each slot carries a sequence telling whether it is ready to be written or
+// read in the current lap, as in Vyukov's bounded MPMC queue.
+//
+// A thread waiting for data, or for room when the queue is full, spins for a
+// while and then parks on a condition variable. The spin length adapts to
+// whether spinning was enough the last time. The other side only takes the
+// lock to wake the waiters when some are parked.
+//
+// The timeouts are in microseconds.
+template <typename T>
+class MPMCQueue {
+ public:
+  static constexpr size_t kDefaultCapacity = 1 << 16;
+
+  // The capacity is rounded up to a power of two.
+  MPMCQueue(const std::string& name = "", size_t capacity = kDefaultCapacity)
+      : name_(name), metrics_(QueueMetrics::Get(name)) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_ = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Push the data, waiting for room if the queue is full.
+  void Push(T&& data) {
+    if (TryPush(data)) {
+      return;
+    }
+    if (metrics_) {
+      metrics_->Full();
+    }
+    while (!TryPush(data)) {
+      Wait([&] { return Size() < Capacity(); }, &not_full_, &push_waiters_,
+           std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    }
+  }
+
+  // Return false and keep the data if the queue is full.
+  bool TryPush(T& data) {
+    uint64_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+      slot = &slots_[pos & mask_];
+      int64_t diff =
+          static_cast<int64_t>(slot->seq.load(std::memory_order_acquire)) -
+          static_cast<int64_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->data = std::move(data);
+    slot->push_time = metrics_ ? QueueMetrics::GetTime() : 0;
+    slot->seq.store(pos + 1, std::memory_order_release);
+    if (metrics_) {
+      metrics_->Push();
+    }
+    Notify(&not_empty_, &pop_waiters_);
+    return true;
+  }
+
+  // Return false if the queue is empty.
+  bool TryPop(T* data) {
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+      slot = &slots_[pos & mask_];
+      int64_t diff =
+          static_cast<int64_t>(slot->seq.load(std::memory_order_acquire)) -
+          static_cast<int64_t>(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    *data = std::move(slot->data);
+    if (metrics_) {
+      metrics_->Pop(slot->push_time);
+    }
+    // Ready to be written in the next lap.
+    slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+    Notify(&not_full_, &push_waiters_);
+    return true;
+  }
+
+  // Pop one item, waiting up to timeout_us for it. Return false on timeout.
+  bool Pop(T* data, int timeout_us) {
+    if (TryPop(data)) {
+      return true;
+    }
+    if (timeout_us <= 0) {
+      return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(timeout_us);
+    while (Wait([&] { return Size() > 0; }, &not_empty_, &pop_waiters_,
+                deadline)) {
+      if (TryPop(data)) {
+        return true;
+      }
+    }
+    return TryPop(data);
+  }
+
+  // Wait up to timeout_us until max_num items are queued, then append up to
+  // max_num of them to data. Return the number popped.
+  size_t PopBatch(std::vector<T>* data, size_t max_num, int timeout_us) {
+    WaitForSize(max_num, timeout_us);
+    size_t num = 0;
+    T item;
+    while (num < max_num && TryPop(&item)) {
+      data->push_back(std::move(item));
+      num++;
+    }
+    return num;
+  }
+
+  // Wait up to timeout_us until size items are queued. Return false on
+  // timeout.
+  bool WaitForSize(size_t size, int timeout_us) {
+    if (Size() >= size) {
+      return true;
+    }
+    if (timeout_us <= 0) {
+      return false;
+    }
+    return Wait([&] { return Size() >= size; }, &not_empty_, &pop_waiters_,
+                std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(timeout_us));
+  }
+
+  // Return the item at the front, or nullptr if the queue is empty. It is
+  // only valid until the item is popped.
+  T* Front() {
+    uint64_t pos = head_.load(std::memory_order_acquire);
+    Slot& slot = slots_[pos & mask_];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1) {
+      return nullptr;
+    }
+    return &slot.data;
+  }
+
+  size_t Size() const {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> seq;
+    T data;
+    // The time of pushing the data if the metrics are enabled.
+    uint64_t push_time = 0;
+  };
+
+  static constexpr int kMinSpinNum = 16;
+  static constexpr int kMaxSpinNum = 4096;
+
+  // Wait until ready() or the deadline. Return ready().
+  template <typename Func>
+  bool Wait(const Func& ready, std::condition_variable* cv,
+            std::atomic<int>* waiters,
+            std::chrono::steady_clock::time_point deadline) {
+    int spin_num = spin_num_.load(std::memory_order_relaxed);
+    for (int i = 0; i < spin_num; ++i) {
+      if (ready()) {
+        spin_num_.store(std::min(spin_num * 2, kMaxSpinNum),
+                        std::memory_order_relaxed);
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    spin_num_.store(std::max(spin_num / 2, kMinSpinNum),
+                    std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    waiters->fetch_add(1);
+    // Pairs with the fence in Notify(): either the waker sees the waiter or
+    // the waiter sees the queue change.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ret = cv->wait_until(lk, deadline, ready);
+    waiters->fetch_sub(1);
+    return ret;
+  }
+
+  void Notify(std::condition_variable* cv, std::atomic<int>* waiters) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters->load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      cv->notify_all();
+    }
+  }
+
+ private:
+  std::string name_;
+  QueueMetrics* metrics_ = nullptr;
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_;
+  // The producers and the consumers move different cache lines.
+  alignas(64) std::atomic<uint64_t> tail_ = 0;
+  alignas(64) std::atomic<uint64_t> head_ = 0;
+  alignas(64) std::atomic<int> spin_num_ = kMinSpinNum;
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_, not_full_;
+  std::atomic<int> pop_waiters_ = 0, push_waiters_ = 0;
+};
+
+}  // namespace resdb
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/common/queue/mpmc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace resdb {
+namespace {
+
+TEST(MPMCQueueTest, PushPop) {
+  MPMCQueue<std::unique_ptr<int>> queue("", 3);
+  EXPECT_EQ(queue.Capacity(), 4);
+  EXPECT_EQ(queue.Front(), nullptr);
+
+  for (int i = 0; i < 4; ++i) {
+    auto data = std::make_unique<int>(i);
+    EXPECT_TRUE(queue.TryPush(data));
+  }
+  auto data = std::make_unique<int>(4);
+  EXPECT_FALSE(queue.TryPush(data));
+  EXPECT_NE(data, nullptr);
+  EXPECT_EQ(queue.Size(), 4);
+  EXPECT_EQ(**queue.Front(), 0);
+
+  std::unique_ptr<int> out;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPop(&out));
+    EXPECT_EQ(*out, i);
+  }
+  EXPECT_FALSE(queue.TryPop(&out));
+  EXPECT_EQ(queue.Size(), 0);
+
+  // The slots are reused in the next lap.
+  EXPECT_TRUE(queue.TryPush(data));
+  EXPECT_TRUE(queue.Pop(&out, 0));
+  EXPECT_EQ(*out, 4);
+}
+
+TEST(MPMCQueueTest, PopBatch) {
+  MPMCQueue<int> queue;
+  for (int i = 0; i < 5; ++i) {
+    queue.Push(int(i));
+  }
+  std::vector<int> data;
+  EXPECT_EQ(queue.PopBatch(&data, 3, 1000), 3);
+  EXPECT_EQ(data, std::vector<int>({0, 1, 2}));
+
+  // Return the items queued after the timeout.
+  EXPECT_EQ(queue.PopBatch(&data, 3, 1000), 2);
+  EXPECT_EQ(data, std::vector<int>({0, 1, 2, 3, 4}));
+  EXPECT_EQ(queue.PopBatch(&data, 3, 1000), 0);
+}
+
+TEST(MPMCQueueTest, WakeUpParkedConsumer) {
+  MPMCQueue<int> queue;
+  int data = 0;
+  auto start_time = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.Pop(&data, 10000));
+  EXPECT_GE(std::chrono::steady_clock::now() - start_time,
+            std::chrono::milliseconds(10));
+
+  std::thread producer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.Push(1);
+  });
+  start_time = std::chrono::steady_clock::now();
+  EXPECT_TRUE(queue.Pop(&data, 10000000));
+  EXPECT_LT(std::chrono::steady_clock::now() - start_time,
+            std::chrono::seconds(5));
+  EXPECT_EQ(data, 1);
+  producer.join();
+}
+
+TEST(MPMCQueueTest, MultiProducerMultiConsumer) {
+  constexpr int kProducerNum = 4;
+  constexpr int kConsumerNum = 4;
+  constexpr int kItemNum = 100000;
+  // Small enough for the producers to wait for room.
+  MPMCQueue<int> queue("", 64);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kProducerNum; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < kItemNum; ++j) {
+        queue.Push(i * kItemNum + j + 1);
+      }
+    });
+  }
+  std::atomic<int> pop_num = 0;
+  std::atomic<int64_t> sum = 0;
+  for (int i = 0; i < kConsumerNum; ++i) {
+    threads.emplace_back([&]() {
+      std::vector<int> data;
+      while (pop_num < kProducerNum * kItemNum) {
+        data.clear();
+        pop_num += queue.PopBatch(&data, 16, 100);
+        for (int value : data) {
+          sum += value;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int64_t total = static_cast<int64_t>(kProducerNum) * kItemNum;
+  EXPECT_EQ(pop_num, total);
+  EXPECT_EQ(sum, total * (total + 1) / 2);
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+// Throughput of the queues with producers pushing messages of a size to one
+// consumer, which is how the network and the executor threads use them.
+// Args: {producer num, message bytes}.
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+#include "platform/common/queue/batch_queue.h"
+#include "platform/common/queue/blocking_queue.h"
+#include "platform/common/queue/lock_free_queue.h"
+#include "platform/common/queue/mpmc_queue.h"
+
+namespace resdb {
+namespace {
+
+constexpr int kMessageNum = 1 << 16;
+
+struct Message {
+  std::string data;
+};
+
+// Run the producers, each pushing its share of kMessageNum messages, and
+// pop them on this thread with pop, which returns the number popped.
+template <typename PushFunc, typename PopFunc>
+void RunProducers(benchmark::State& state, PushFunc push, PopFunc pop) {
+  int producer_num = state.range(0);
+  std::string data(state.range(1), 'a');
+  for (auto _ : state) {
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producer_num; ++i) {
+      producers.emplace_back([&]() {
+        for (int j = 0; j < kMessageNum / producer_num; ++j) {
+          auto message = std::make_unique<Message>();
+          message->data = data;
+          push(std::move(message));
+        }
+      });
+    }
+    int total = kMessageNum / producer_num * producer_num;
+    for (int popped = 0; popped < total;) {
+      popped += pop();
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kMessageNum);
+  state.SetBytesProcessed(state.iterations() * kMessageNum * data.size());
+}
+
+void ProducerArgs(benchmark::internal::Benchmark* b) {
+  for (int producer_num : {1, 2, 4, 8}) {
+    for (int size : {64, 4096}) {
+      b->Args({producer_num, size});
+    }
+  }
+  b->UseRealTime();
+}
+
+void BM_LockFreeQueue(benchmark::State& state) {
+  LockFreeQueue<Message> queue;
+  RunProducers(
+      state,
+      [&](std::unique_ptr<Message> message) { queue.Push(std::move(message)); },
+      [&]() { return queue.Pop() == nullptr ? 0 : 1; });
+}
+BENCHMARK(BM_LockFreeQueue)->Apply(ProducerArgs);
+
+void BM_BlockingQueue(benchmark::State& state) {
+  BlockingQueue<std::unique_ptr<Message>> queue;
+  RunProducers(
+      state,
+      [&](std::unique_ptr<Message> message) { queue.Push(std::move(message)); },
+      [&]() { return queue.Pop(100) == nullptr ? 0 : 1; });
+}
+BENCHMARK(BM_BlockingQueue)->Apply(ProducerArgs);
+
+void BM_BatchQueue(benchmark::State& state) {
+  BatchQueue<std::unique_ptr<Message>> queue("benchmark", 100);
+  RunProducers(
+      state,
+      [&](std::unique_ptr<Message> message) { queue.Push(std::move(message)); },
+      [&]() { return queue.Pop(100).size(); });
+}
+BENCHMARK(BM_BatchQueue)->Apply(ProducerArgs);
+
+void BM_MPMCQueue(benchmark::State& state) {
+  MPMCQueue<std::unique_ptr<Message>> queue;
+  RunProducers(
+      state,
+      [&](std::unique_ptr<Message> message) { queue.Push(std::move(message)); },
+      [&]() {
+        std::unique_ptr<Message> message;
+        return queue.Pop(&message, 100) ? 1 : 0;
+      });
+}
+BENCHMARK(BM_MPMCQueue)->Apply(ProducerArgs);
+
+void BM_MPMCQueuePopBatch(benchmark::State& state) {
+  MPMCQueue<std::unique_ptr<Message>> queue;
+  std::vector<std::unique_ptr<Message>> messages;
+  RunProducers(
+      state,
+      [&](std::unique_ptr<Message> message) { queue.Push(std::move(message)); },
+      [&]() {
+        messages.clear();
+        return queue.PopBatch(&messages, 100, 100);
+      });
+}
+BENCHMARK(BM_MPMCQueuePopBatch)->Apply(ProducerArgs);
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/common/queue/queue_metrics.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace resdb {
+
+namespace {
+
+std::atomic<bool> enabled(false);
+std::mutex metrics_mutex;
+
+std::map<std::string, std::unique_ptr<QueueMetrics>>& GetMetricsMap() {
+  static std::map<std::string, std::unique_ptr<QueueMetrics>> metrics;
+  return metrics;
+}
+
+}  // namespace
+
+QueueMetrics::QueueMetrics(const std::string& name)
+    : name_(name),
+      depth_(0),
+      max_depth_(0),
+      push_num_(0),
+      pop_num_(0),
+      full_num_(0) {}
+
+void QueueMetrics::Enable(bool enable) { enabled = enable; }
+
+QueueMetrics* QueueMetrics::Get(const std::string& name) {
+  if (!enabled || name.empty()) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lk(metrics_mutex);
+  auto& metrics = GetMetricsMap()[name];
+  if (metrics == nullptr) {
+    metrics = std::make_unique<QueueMetrics>(name);
+  }
+  return metrics.get();
+}
+
+std::vector<QueueMetrics*> QueueMetrics::GetAll() {
+  std::vector<QueueMetrics*> all;
+  std::lock_guard<std::mutex> lk(metrics_mutex);
+  for (auto& it : GetMetricsMap()) {
+    all.push_back(it.second.get());
+  }
+  return all;
+}
+
+uint64_t QueueMetrics::GetTime() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void QueueMetrics::Push(uint64_t num) {
+  push_num_.fetch_add(num, std::memory_order_relaxed);
+  int64_t depth = depth_.fetch_add(num, std::memory_order_relaxed) + num;
+  int64_t max_depth = max_depth_.load(std::memory_order_relaxed);
+  while (depth > max_depth &&
+         !max_depth_.compare_exchange_weak(max_depth, depth,
+                                           std::memory_order_relaxed)) {
+  }
+}
+
+void QueueMetrics::Pop(uint64_t push_time, uint64_t num) {
+  pop_num_.fetch_add(num, std::memory_order_relaxed);
+  depth_.fetch_sub(num, std::memory_order_relaxed);
+  uint64_t current_time = GetTime();
+  uint64_t wait_time = current_time > push_time ? current_time - push_time : 0;
+  wait_time_.Record(wait_time, num);
+}
+
+void QueueMetrics::Full() { full_num_.fetch_add(1, std::memory_order_relaxed); }
+
+const std::string& QueueMetrics::GetName() const { return name_; }
+
+int64_t QueueMetrics::GetDepth() const { return depth_; }
+
+int64_t QueueMetrics::GetMaxDepth() { return max_depth_.exchange(depth_); }
+
+uint64_t QueueMetrics::GetPushNum() const { return push_num_; }
+
+uint64_t QueueMetrics::GetPopNum() const { return pop_num_; }
+
+uint64_t QueueMetrics::GetFullNum() const { return full_num_; }
+
+LatencyHistogram::Snapshot QueueMetrics::GetWaitTime() const {
+  return wait_time_.GetSnapshot();
+}
+
+}  // namespace resdb
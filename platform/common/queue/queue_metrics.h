@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "platform/statistic/latency_histogram.h"
+
+namespace resdb {
+
+// QueueMetrics counts what goes through the queues of one name: the depth,
+// the max depth, the number of pushes and pops, the pushes that found the
+// queue full and how long the items wait.
+// The queues sharing a name share the metrics.
+//
+// Metrics are disabled by default. Queues constructed after Enable(true)
+// record them, and Stats reports them.
+class QueueMetrics {
+ public:
+  explicit QueueMetrics(const std::string& name);
+
+  static void Enable(bool enable);
+  // Return the metrics of the name, or nullptr if the name is empty or the
+  // metrics are disabled.
+  static QueueMetrics* Get(const std::string& name);
+  static std::vector<QueueMetrics*> GetAll();
+
+  // The current time in microseconds from a steady clock.
+  static uint64_t GetTime();
+
+  void Push(uint64_t num = 1);
+  // Pop num items pushed at push_time.
+  void Pop(uint64_t push_time, uint64_t num = 1);
+  // Count a push that had to wait for room.
+  void Full();
+
+  const std::string& GetName() const;
+  int64_t GetDepth() const;
+  // Return the max depth since the last call.
+  int64_t GetMaxDepth();
+  uint64_t GetPushNum() const;
+  uint64_t GetPopNum() const;
+  uint64_t GetFullNum() const;
+  // The time in queue in microseconds.
+  LatencyHistogram::Snapshot GetWaitTime() const;
+
+ private:
+  std::string name_;
+  std::atomic<int64_t> depth_, max_depth_;
+  std::atomic<uint64_t> push_num_, pop_num_, full_num_;
+  LatencyHistogram wait_time_;
+};
+
+}  // namespace resdb
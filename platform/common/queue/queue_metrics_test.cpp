@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/common/queue/queue_metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "platform/common/queue/batch_queue.h"
+#include "platform/common/queue/blocking_queue.h"
+#include "platform/common/queue/lock_free_queue.h"
+
+namespace resdb {
+namespace {
+
+class QueueMetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override { QueueMetrics::Enable(true); }
+  void TearDown() override { QueueMetrics::Enable(false); }
+};
+
+TEST_F(QueueMetricsTest, Disabled) {
+  QueueMetrics::Enable(false);
+  EXPECT_EQ(QueueMetrics::Get("disabled"), nullptr);
+  QueueMetrics::Enable(true);
+  EXPECT_EQ(QueueMetrics::Get(""), nullptr);
+  EXPECT_EQ(QueueMetrics::Get("enabled"), QueueMetrics::Get("enabled"));
+}
+
+TEST_F(QueueMetricsTest, LockFreeQueue) {
+  LockFreeQueue<int> queue("lock_free");
+  QueueMetrics* metrics = QueueMetrics::Get("lock_free");
+  ASSERT_NE(metrics, nullptr);
+
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(std::make_unique<int>(i));
+  }
+  EXPECT_EQ(metrics->GetDepth(), 3);
+  EXPECT_EQ(*queue.Pop(), 0);
+  EXPECT_EQ(metrics->GetDepth(), 2);
+  EXPECT_EQ(metrics->GetMaxDepth(), 3);
+  // The max depth restarts from the current depth.
+  EXPECT_EQ(metrics->GetMaxDepth(), 2);
+  EXPECT_EQ(metrics->GetPushNum(), 3);
+  EXPECT_EQ(metrics->GetPopNum(), 1);
+  EXPECT_EQ(metrics->GetWaitTime().count, 1);
+}
+
+TEST_F(QueueMetricsTest, BlockingQueue) {
+  BlockingQueue<std::unique_ptr<int>> queue("blocking");
+  QueueMetrics* metrics = QueueMetrics::Get("blocking");
+  ASSERT_NE(metrics, nullptr);
+
+  queue.Push(std::make_unique<int>(1));
+  queue.Push(std::make_unique<int>(2));
+  EXPECT_EQ(***queue.Front(), 1);
+  EXPECT_EQ(*queue.Pop(100), 1);
+  EXPECT_EQ(*queue.Pop(100), 2);
+  EXPECT_EQ(queue.Pop(100), nullptr);
+  EXPECT_EQ(metrics->GetDepth(), 0);
+  EXPECT_EQ(metrics->GetPopNum(), 2);
+  EXPECT_EQ(metrics->GetWaitTime().count, 2);
+}
+
+TEST_F(QueueMetricsTest, BatchQueue) {
+  BatchQueue<std::unique_ptr<int>> queue("batch", 2);
+  QueueMetrics* metrics = QueueMetrics::Get("batch");
+  ASSERT_NE(metrics, nullptr);
+
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(std::make_unique<int>(i));
+  }
+  EXPECT_EQ(metrics->GetDepth(), 3);
+  EXPECT_EQ(queue.Pop(100).size(), 2);
+  EXPECT_EQ(metrics->GetDepth(), 1);
+  EXPECT_EQ(metrics->GetPopNum(), 2);
+  EXPECT_EQ(metrics->GetWaitTime().count, 2);
+}
+
+TEST_F(QueueMetricsTest, Full) {
+  BatchQueue<std::unique_ptr<int>> queue("full", 1, 2);
+  QueueMetrics* metrics = QueueMetrics::Get("full");
+  ASSERT_NE(metrics, nullptr);
+
+  queue.Push(std::make_unique<int>(1));
+  queue.Push(std::make_unique<int>(2));
+  EXPECT_EQ(metrics->GetFullNum(), 0);
+  std::thread pusher([&]() { queue.Push(std::make_unique<int>(3)); });
+  while (metrics->GetFullNum() == 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(queue.Pop(100).size(), 1);
+  pusher.join();
+  EXPECT_EQ(metrics->GetFullNum(), 1);
+  EXPECT_EQ(metrics->GetDepth(), 2);
+}
+
+}  // namespace
+}  // namespace resdb
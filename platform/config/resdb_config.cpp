@@ -27,6 +27,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 namespace resdb {
 
 ResDBConfig::ResDBConfig(const std::vector<ReplicaInfo>& replicas,
@@ -154,12 +156,15 @@ void ResDBConfig::SetCheckPointLoggingPath(const std::string& path) {
   checkpoint_logging_path_ = path;
 }
 
-int ResDBConfig::GetCheckPointWaterMark() const {
-  return checkpoint_water_mark_;
+int ResDBConfig::GetCheckPointInterval() const {
+  if (config_data_.checkpoint_interval() > 0) {
+    return config_data_.checkpoint_interval();
+  }
+  return 128;
 }
 
-void ResDBConfig::SetCheckPointWaterMark(int water_mark) {
-  checkpoint_water_mark_ = water_mark;
+void ResDBConfig::SetCheckPointInterval(int interval) {
+  config_data_.set_checkpoint_interval(interval);
 }
 
 void ResDBConfig::EnableCheckPoint(bool is_enable) {
@@ -256,4 +261,131 @@ void ResDBConfig::SetViewchangeCommitTimeout(uint64_t timeout_ms) {
   config_data_.set_view_change_timeout_ms(timeout_ms);
 }
 
+uint32_t ResDBConfig::GetViewChangeFirstTimeoutMs() const {
+  if (config_data_.view_change_first_timeout_ms() > 0) {
+    return config_data_.view_change_first_timeout_ms();
+  }
+  return 1000;
+}
+
+uint32_t ResDBConfig::GetViewChangeMaxTimeoutMs() const {
+  if (config_data_.view_change_max_timeout_ms() > 0) {
+    return std::max<uint32_t>(config_data_.view_change_max_timeout_ms(),
+                              GetViewChangeFirstTimeoutMs());
+  }
+  return std::max<uint32_t>(60000, GetViewChangeFirstTimeoutMs());
+}
+
+uint32_t ResDBConfig::GetTraceSampleRate() const {
+  if (config_data_.trace_sample_rate() > 0) {
+    return config_data_.trace_sample_rate();
+  }
+  return 0;
+}
+
+std::string ResDBConfig::GetTraceFile() const {
+  if (!config_data_.trace_file().empty()) {
+    return config_data_.trace_file();
+  }
+  return "seq_trace_" + std::to_string(self_info_.id()) + ".json";
+}
+
+bool ResDBConfig::IsQueueMetricsEnabled() const {
+  return config_data_.enable_queue_metrics();
+}
+
+std::vector<uint32_t> ResDBConfig::GetLoadRates() const {
+  std::vector<uint32_t> rates;
+  for (uint32_t rate : config_data_.load_rates()) {
+    if (rate > 0) {
+      rates.push_back(rate);
+    }
+  }
+  return rates;
+}
+
+bool ResDBConfig::IsLoadPoissonArrival() const {
+  return config_data_.load_poisson_arrival();
+}
+
+uint32_t ResDBConfig::GetLoadStepTimeS() const {
+  if (config_data_.load_step_time_s() > 0) {
+    return config_data_.load_step_time_s();
+  }
+  return 30;
+}
+
+uint32_t ResDBConfig::GetMaxPendingLoadNum() const {
+  if (config_data_.max_pending_load_num() > 0) {
+    return config_data_.max_pending_load_num();
+  }
+  return 100000;
+}
+
+uint32_t ResDBConfig::GetBroadcastQueueCapacity() const {
+  if (config_data_.broadcast_queue_capacity() > 0) {
+    return config_data_.broadcast_queue_capacity();
+  }
+  return 1 << 16;
+}
+
+uint32_t ResDBConfig::GetGeoBatchSize() const {
+  if (config_data_.geo_batch_size() > 0) {
+    return config_data_.geo_batch_size();
+  }
+  return 50;
+}
+
+uint32_t ResDBConfig::GetGeoBatchLingerMs() const {
+  if (config_data_.geo_batch_linger_ms() > 0) {
+    return config_data_.geo_batch_linger_ms();
+  }
+  return 1;
+}
+
+bool ResDBConfig::IsAdaptiveWindowEnabled() const {
+  return config_data_.enable_adaptive_window();
+}
+
+uint32_t ResDBConfig::GetMinProcessTxn() const {
+  if (config_data_.min_process_txn() > 0) {
+    return std::min<uint32_t>(config_data_.min_process_txn(),
+                              GetMaxProcessTxn());
+  }
+  return std::max<uint32_t>(GetMaxProcessTxn() / 8, 1);
+}
+
+uint32_t ResDBConfig::GetMinClientBatchNum() const {
+  if (config_data_.min_client_batch_num() > 0) {
+    return config_data_.min_client_batch_num();
+  }
+  return 1;
+}
+
+uint32_t ResDBConfig::GetMaxClientBatchNum() const {
+  if (config_data_.max_client_batch_num() > 0) {
+    return config_data_.max_client_batch_num();
+  }
+  return ClientBatchNum();
+}
+
+uint32_t ResDBConfig::GetTargetCommitLatencyUs() const {
+  return config_data_.target_commit_latency_us();
+}
+
+bool ResDBConfig::IsDigestPrePrepareEnabled() const {
+  return config_data_.enable_digest_preprepare();
+}
+
+bool ResDBConfig::IsErasureCodedPayloadEnabled() const {
+  return config_data_.enable_erasure_coded_payload();
+}
+
+uint32_t ResDBConfig::GetErasureCodedPayloadMinBytes() const {
+  if (config_data_.erasure_coded_payload_min_bytes() > 0) {
+    return config_data_.erasure_coded_payload_min_bytes();
+  }
+  return 16 * 1024;
+}
+
 }  // namespace resdb
@@ -79,9 +79,9 @@ class ResDBConfig {
   void SetClientTimeoutMs(int timeout_ms);
   int GetClientTimeoutMs() const;
 
-  // CheckPoint Window
-  int GetCheckPointWaterMark() const;
-  void SetCheckPointWaterMark(int water_mark);
+  // The number of sequences between two checkpoints. Default value is 128.
+  int GetCheckPointInterval() const;
+  void SetCheckPointInterval(int interval);
 
   // Logging
   std::string GetCheckPointLoggingPath() const;
@@ -127,6 +127,54 @@ class ResDBConfig {
   uint32_t GetViewchangeCommitTimeout() const;
   void SetViewchangeCommitTimeout(uint64_t timeout_ms);
 
+  // The timeout to suspect the primary and wait for a view change, which is
+  // doubled after each failed view change up to the max.
+  // Default values are 1s and 60s.
+  uint32_t GetViewChangeFirstTimeoutMs() const;
+  uint32_t GetViewChangeMaxTimeoutMs() const;
+
+  // Trace one in every GetTraceSampleRate() seqs, 0 if tracing is disabled.
+  // The trace file is seq_trace_<id>.json by default.
+  uint32_t GetTraceSampleRate() const;
+  std::string GetTraceFile() const;
+
+  // Record the depth and the wait time of the internal queues.
+  bool IsQueueMetricsEnabled() const;
+
+  // The open-loop rates (requests/s) of the performance clients, each held
+  // for GetLoadStepTimeS() but the last one. Empty runs the closed loop.
+  // The clients keep at most GetMaxPendingLoadNum() requests waiting to be
+  // batched. Default values are 30s and 100000.
+  std::vector<uint32_t> GetLoadRates() const;
+  bool IsLoadPoissonArrival() const;
+  uint32_t GetLoadStepTimeS() const;
+  uint32_t GetMaxPendingLoadNum() const;
+
+  // The max number of messages waiting to be broadcast. Default value is
+  // 65536.
+  uint32_t GetBroadcastQueueCapacity() const;
+
+  // The max number of local batches and the max time to wait for them when
+  // shipping geo requests to other regions.
+  uint32_t GetGeoBatchSize() const;
+  uint32_t GetGeoBatchLingerMs() const;
+
+  // Bounds of the in-flight window and client batch size when they are
+  // adjusted from the commit latency. The max window is GetMaxProcessTxn().
+  bool IsAdaptiveWindowEnabled() const;
+  uint32_t GetMinProcessTxn() const;
+  uint32_t GetMinClientBatchNum() const;
+  uint32_t GetMaxClientBatchNum() const;
+  uint32_t GetTargetCommitLatencyUs() const;
+
+  // Whether the proxies disseminate the batches and the primary only
+  // proposes their digests.
+  bool IsDigestPrePrepareEnabled() const;
+  // Whether the disseminated batches larger than the min bytes are sent as
+  // erasure-coded chunks.
+  bool IsErasureCodedPayloadEnabled() const;
+  uint32_t GetErasureCodedPayloadMinBytes() const;
+
  private:
   ResConfigData config_data_;
   std::vector<ReplicaInfo> replicas_;
@@ -135,7 +183,6 @@ class ResDBConfig {
   const CertificateInfo public_key_cert_info_;
   int client_timeout_ms_ = 3000000;
   std::string checkpoint_logging_path_;
-  int checkpoint_water_mark_ = 5;
   bool is_enable_checkpoint_ = false;
   bool hb_enabled_ = true;
   bool signature_verifier_enabled_ = true;
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+// Cost of the duplicate checks of the proposed and the executed requests,
+// with threads checking distinct hashes.
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+#include "platform/config/resdb_config_utils.h"
+#include "platform/consensus/execution/duplicate_manager.h"
+
+namespace resdb {
+namespace {
+
+DuplicateManager* manager = nullptr;
+
+std::string GetHash(int thread, uint64_t id) {
+  std::string hash(32, '\0');
+  memcpy(&hash[0], &thread, sizeof(thread));
+  memcpy(&hash[8], &id, sizeof(id));
+  return hash;
+}
+
+void SetUp(const benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    manager = new DuplicateManager(
+        ResDBConfig({GenerateReplicaInfo(1, "127.0.0.1", 1234)},
+                    GenerateReplicaInfo(1, "127.0.0.1", 1234)));
+  }
+}
+
+void TearDown(const benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    delete manager;
+  }
+}
+
+void BM_CheckAndAddProposed(benchmark::State& state) {
+  SetUp(state);
+  uint64_t id = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        manager->CheckAndAddProposed(GetHash(state.thread_index(), ++id)));
+  }
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CheckAndAddProposed)->ThreadRange(1, 8)->UseRealTime();
+
+// A request is proposed, executed and checked again by a duplicate.
+void BM_ProposeAndExecute(benchmark::State& state) {
+  SetUp(state);
+  uint64_t id = 0;
+  for (auto _ : state) {
+    std::string hash = GetHash(state.thread_index(), ++id);
+    manager->CheckAndAddProposed(hash);
+    manager->CheckAndAddExecuted(hash, id);
+    manager->EraseProposed(hash);
+    benchmark::DoNotOptimize(manager->CheckIfExecuted(hash));
+  }
+  TearDown(state);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ProposeAndExecute)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace resdb
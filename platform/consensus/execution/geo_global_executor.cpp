@@ -27,27 +27,56 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 namespace resdb {
 
+namespace {
+// The rounds admitted before the ordering thread stops at a round boundary to
+// publish a snapshot.
+constexpr uint64_t kSnapshotRounds = 16;
+}  // namespace
+
 GeoGlobalExecutor::GeoGlobalExecutor(
     std::unique_ptr<TransactionManager> global_transaction_manager,
     const ResDBConfig& config)
     : global_transaction_manager_(std::move(global_transaction_manager)),
+      region_size_(config.GetConfigData().region().size()),
       config_(config),
-      is_stop_(false) {
+      is_stop_(false),
+      region_requests_(region_size_),
+      region_seq_(region_size_, 0),
+      region_lag_(region_size_),
+      region_waiting_(region_size_) {
   global_stats_ = Stats::GetGlobalStats();
-  region_size_ = config_.GetConfigData().region().size();
-  order_thread_ = std::thread(&GeoGlobalExecutor::OrderRound, this);
   my_region_ = config.GetConfigData().self_region_id();
+  for (size_t i = 0; i < region_size_; ++i) {
+    region_lag_[i] = 0;
+    worker_queues_.push_back(std::make_unique<LockFreeQueue<Request>>(
+        "geo_worker_" + std::to_string(i + 1)));
+  }
+  for (size_t i = 0; i < region_size_; ++i) {
+    workers_.push_back(std::thread(&GeoGlobalExecutor::RegionWorker, this, i));
+  }
+  order_thread_ = std::thread(&GeoGlobalExecutor::OrderRound, this);
 }
 
 GeoGlobalExecutor::~GeoGlobalExecutor() { Stop(); }
 
 void GeoGlobalExecutor::Stop() {
-  is_stop_ = true;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    is_stop_ = true;
+    cv_.notify_all();
+  }
   if (order_thread_.joinable()) {
     order_thread_.join();
   }
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
 }
 
 void GeoGlobalExecutor::Execute(std::unique_ptr<Request> request) {
@@ -82,51 +111,203 @@ bool GeoGlobalExecutor::IsStop() { return is_stop_; }
 
 int GeoGlobalExecutor::OrderGeoRequest(std::unique_ptr<Request> request) {
   order_queue_.Push(std::move(request));
+  std::lock_guard<std::mutex> lk(mutex_);
+  cv_.notify_one();
   return 0;
 }
 
-void GeoGlobalExecutor::AddData() {
-  auto request = order_queue_.Pop();
-  if (request == nullptr) {
-    return;
-  }
+void GeoGlobalExecutor::AddData(std::unique_ptr<Request> request) {
   global_stats_->IncGeoRequest();
   uint64_t seq_num = request->seq();
   int region_id = request->region_info().region_id();
-  execute_map_[std::make_pair(seq_num, region_id)] = std::move(request);
+  if (region_id < 1 || region_id > static_cast<int>(region_size_)) {
+    LOG(ERROR) << "[GeoGlobalExecutor] invalid region:" << region_id;
+    return;
+  }
+  // Drop the requests already admitted.
+  if (seq_num < next_seq_ ||
+      (seq_num == next_seq_ &&
+       static_cast<size_t>(region_id - 1) < next_region_)) {
+    return;
+  }
+  auto& region_requests = region_requests_[region_id - 1];
+  region_requests[seq_num] = std::move(request);
+
+  uint64_t& region_seq = region_seq_[region_id - 1];
+  uint64_t old_region_seq = region_seq;
+  while (region_requests.find(region_seq + 1) != region_requests.end()) {
+    region_seq++;
+  }
+  if (region_seq != old_region_seq) {
+    UpdateRegionLag();
+  }
+}
+
+void GeoGlobalExecutor::UpdateRegionLag() {
+  uint64_t max_seq = *std::max_element(region_seq_.begin(), region_seq_.end());
+  for (size_t i = 0; i < region_size_; ++i) {
+    region_lag_[i] = max_seq - region_seq_[i];
+    if (global_stats_) {
+      global_stats_->SetGeoRegionLag(i + 1, max_seq - region_seq_[i]);
+    }
+  }
 }
 
-std::unique_ptr<Request> GeoGlobalExecutor::GetNextMap() {
-  if (execute_map_.empty()) {
+uint64_t GeoGlobalExecutor::GetRegionLag(int region_id) {
+  if (region_id < 1 || region_id > static_cast<int>(region_size_)) {
+    return 0;
+  }
+  return region_lag_[region_id - 1];
+}
+
+std::unique_ptr<std::vector<std::string>> GeoGlobalExecutor::GetConflictKeys(
+    const Request& request) {
+  if (global_transaction_manager_ == nullptr) {
     return nullptr;
   }
-  // LOG(ERROR) << "Next round seq: " << next_seq_ << ", current First in map: "
-  // << execute_map_.begin()->first << ", size: " <<
-
-  // LOG(ERROR)<<"get next seq:"<<next_seq_<<" region:"<<next_region_;
-  if (execute_map_.begin()->first == std::make_pair(next_seq_, next_region_)) {
-    std::unique_ptr<Request> res = std::move(execute_map_.begin()->second);
-    execute_map_.erase(execute_map_.begin());
-    next_region_++;
-    if (next_region_ > static_cast<int64_t>(region_size_)) {
-      next_region_ = 1;
-      next_seq_++;
+  BatchUserRequest batch_request;
+  if (!batch_request.ParseFromString(request.data())) {
+    return nullptr;
+  }
+  return global_transaction_manager_->GetConflictKeys(batch_request);
+}
+
+void GeoGlobalExecutor::AdmitRequests() {
+  while (region_size_ > 0) {
+    // Stop at the round boundary to publish the rounds done so far if the
+    // snapshot falls too far behind.
+    if (next_region_ == 0 &&
+        next_seq_ - 1 >= committed_round_ + kSnapshotRounds) {
+      return;
+    }
+    auto& region_requests = region_requests_[next_region_];
+    auto it = region_requests.find(next_seq_);
+    if (it == region_requests.end()) {
+      return;
+    }
+    Position pos(next_seq_, next_region_);
+    std::unique_ptr<std::vector<std::string>> keys =
+        GetConflictKeys(*it->second);
+    if (keys == nullptr) {
+      barriers_.insert(pos);
+    } else {
+      std::sort(keys->begin(), keys->end());
+      keys->erase(std::unique(keys->begin(), keys->end()), keys->end());
+      for (const std::string& key : *keys) {
+        key_queues_[key].push_back(pos);
+      }
+    }
+    incomplete_[pos] = std::move(keys);
+    region_waiting_[next_region_].push_back(std::move(it->second));
+    region_requests.erase(it);
+    if (++next_region_ == region_size_) {
+      next_region_ = 0;
+      ++next_seq_;
+    }
+  }
+}
+
+bool GeoGlobalExecutor::CanDispatch(const Position& pos) {
+  auto it = incomplete_.find(pos);
+  if (it->second == nullptr) {
+    // Without the keys, the request can only run after all the earlier ones.
+    return it == incomplete_.begin();
+  }
+  if (!barriers_.empty() && *barriers_.begin() < pos) {
+    return false;
+  }
+  // The earlier requests of the same region run before it on the same worker.
+  for (const std::string& key : *it->second) {
+    for (const Position& other : key_queues_[key]) {
+      if (other == pos) {
+        break;
+      }
+      if (other.second != pos.second) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void GeoGlobalExecutor::DispatchRequests() {
+  for (size_t i = 0; i < region_size_; ++i) {
+    auto& waiting = region_waiting_[i];
+    while (!waiting.empty() &&
+           CanDispatch(Position(waiting.front()->seq(), i))) {
+      worker_queues_[i]->Push(std::move(waiting.front()));
+      waiting.pop_front();
+    }
+  }
+}
+
+void GeoGlobalExecutor::Complete(const Position& pos) {
+  auto it = incomplete_.find(pos);
+  if (it == incomplete_.end()) {
+    return;
+  }
+  if (it->second == nullptr) {
+    barriers_.erase(pos);
+  } else {
+    for (const std::string& key : *it->second) {
+      auto queue_it = key_queues_.find(key);
+      std::deque<Position>& queue = queue_it->second;
+      queue.erase(std::find(queue.begin(), queue.end(), pos));
+      if (queue.empty()) {
+        key_queues_.erase(queue_it);
+      }
     }
-    return res;
   }
-  return nullptr;
+  incomplete_.erase(it);
+}
+
+bool GeoGlobalExecutor::CommitRound() {
+  if (next_region_ != 0 || !incomplete_.empty() ||
+      next_seq_ - 1 <= committed_round_) {
+    return false;
+  }
+  committed_round_ = next_seq_ - 1;
+  if (global_transaction_manager_) {
+    global_transaction_manager_->CommitState(committed_round_);
+  }
+  return true;
+}
+
+void GeoGlobalExecutor::RegionWorker(int region_idx) {
+  while (!IsStop()) {
+    auto request = worker_queues_[region_idx]->Pop();
+    if (request == nullptr) {
+      continue;
+    }
+    Position pos(request->seq(), region_idx);
+    Execute(std::move(request));
+    std::lock_guard<std::mutex> lk(mutex_);
+    done_.push_back(pos);
+    cv_.notify_one();
+  }
 }
 
 void GeoGlobalExecutor::OrderRound() {
   while (!IsStop()) {
-    AddData();
-    while (!IsStop()) {
-      std::unique_ptr<Request> seq_map = GetNextMap();
-      if (seq_map == nullptr) {
-        break;
-      }
-      Execute(std::move(seq_map));
+    std::vector<Position> done;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cv_.wait_for(lk, std::chrono::milliseconds(100), [&] {
+        return !done_.empty() || !order_queue_.Empty() || IsStop();
+      });
+      done.swap(done_);
+    }
+    for (const Position& pos : done) {
+      Complete(pos);
+    }
+    for (auto request = order_queue_.Pop(0); request != nullptr;
+         request = order_queue_.Pop(0)) {
+      AddData(std::move(request));
     }
+    do {
+      AdmitRequests();
+      DispatchRequests();
+    } while (CommitRound());
   }
 }
 
@@ -24,8 +24,11 @@
  */
 
 #pragma once
+#include <deque>
+#include <map>
 #include <mutex>
 #include <queue>
+#include <set>
 #include <unordered_map>
 
 #include "executor/common/transaction_manager.h"
@@ -35,6 +38,14 @@
 
 namespace resdb {
 
+// GeoGlobalExecutor executes the requests from all the regions in the global
+// order (seq, region). A request is admitted once all the requests ordered
+// before it have been delivered, and then runs on the worker of its region as
+// soon as the earlier requests of the other regions sharing a conflict key
+// with it are done, without waiting for the rest of the round. Requests
+// without conflict keys run alone in the global order.
+// A state snapshot is published by the ordering thread at the end of a round
+// once all the requests up to that round are done.
 class GeoGlobalExecutor {
  public:
   GeoGlobalExecutor(
@@ -48,29 +59,70 @@ class GeoGlobalExecutor {
 
   std::unique_ptr<BatchUserResponse> GetResponseMsg();
 
+  // Return how many seqs the region falls behind the fastest region.
+  uint64_t GetRegionLag(int region_id);
+
  private:
-  using ExecuteMap =
-      std::map<std::pair<uint64_t, int>, std::unique_ptr<Request>>;
+  // A position in the global order: (seq, region index).
+  typedef std::pair<uint64_t, size_t> Position;
 
   bool IsStop();
   void OrderRound();
-  std::unique_ptr<Request> GetNextMap();
-  void AddData();
+  void AddData(std::unique_ptr<Request> request);
+  void UpdateRegionLag();
+
+  // Admit the delivered requests in the global order until one is missing.
+  void AdmitRequests();
+  // Send the admitted requests that can run to their region workers.
+  void DispatchRequests();
+  bool CanDispatch(const Position& pos);
+  void Complete(const Position& pos);
+  // Publish the state of the last round if all its requests are done.
+  // Return true if a snapshot is published.
+  bool CommitRound();
+
+  std::unique_ptr<std::vector<std::string>> GetConflictKeys(
+      const Request& request);
+  void RegionWorker(int region_idx);
 
  protected:
   std::unique_ptr<TransactionManager> global_transaction_manager_;
   Stats* global_stats_;
-  std::thread execute_round_thread_, order_thread_;
-  ExecuteMap execute_map_;
+  std::thread order_thread_;
+  // The next position to admit.
   uint64_t next_seq_ = 1;
-  int next_region_ = 1;
+  size_t next_region_ = 0;
+  // The round of the last published snapshot.
+  uint64_t committed_round_ = 0;
   size_t region_size_;
   ResDBConfig config_;
   std::atomic<bool> is_stop_;
-  std::mutex mutex_;
-  std::condition_variable cv_;
   LockFreeQueue<Request> order_queue_;
   LockFreeQueue<BatchUserResponse> resp_queue_;
   int my_region_;
+
+  // Requests received from each region, indexed by region id - 1.
+  std::vector<std::map<uint64_t, std::unique_ptr<Request>>> region_requests_;
+  // The largest seq each region has delivered without gaps.
+  std::vector<uint64_t> region_seq_;
+  std::vector<std::atomic<uint64_t>> region_lag_;
+
+  // The conflict keys of the admitted requests not done yet, or nullptr if
+  // the keys are unknown.
+  std::map<Position, std::unique_ptr<std::vector<std::string>>> incomplete_;
+  // The admitted requests without conflict keys not done yet.
+  std::set<Position> barriers_;
+  // The admitted requests not done yet for each conflict key, in order.
+  std::unordered_map<std::string, std::deque<Position>> key_queues_;
+  // The admitted requests of each region not dispatched yet, in order.
+  std::vector<std::deque<std::unique_ptr<Request>>> region_waiting_;
+
+  // Workers executing the requests, one for each region.
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<LockFreeQueue<Request>>> worker_queues_;
+  // Wake up the ordering thread for new requests and the done ones.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Position> done_;
 };
 }  // namespace resdb
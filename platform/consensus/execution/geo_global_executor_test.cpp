@@ -96,6 +96,159 @@ TEST_F(GlobalExecutorTest, ExecuteFailed) {
   global_executor.Execute(std::make_unique<Request>(request));
 }
 
+class GeoRegionExecutorTest : public Test {
+ public:
+  GeoRegionExecutorTest() : config_(GenerateConfig()) {}
+
+  static ResDBConfig GenerateConfig() {
+    ResConfigData config_data;
+    config_data.set_self_region_id(1);
+    config_data.add_region()->set_region_id(1);
+    config_data.add_region()->set_region_id(2);
+    return ResDBConfig({GenerateReplicaInfo(1, "127.0.0.1", 1234)},
+                       GenerateReplicaInfo(1, "127.0.0.1", 1234), config_data);
+  }
+
+  static std::unique_ptr<Request> GenerateRequest(uint64_t seq, int region_id,
+                                                  const std::string& key) {
+    auto request = std::make_unique<Request>();
+    request->set_seq(seq);
+    request->mutable_region_info()->set_region_id(region_id);
+    BatchUserRequest batch_request;
+    batch_request.set_seq(seq);
+    // The data is "seq/region:key".
+    batch_request.add_user_requests()->mutable_request()->set_data(
+        std::to_string(seq) + "/" + std::to_string(region_id) + ":" + key);
+    batch_request.SerializeToString(request->mutable_data());
+    return request;
+  }
+
+ protected:
+  ResDBConfig config_;
+};
+
+TEST_F(GeoRegionExecutorTest, ExecuteConflictKeysInOrder) {
+  auto mock_executor = std::make_unique<MockTransactionManager>();
+
+  std::mutex mutex;
+  std::vector<std::string> executed;
+  EXPECT_CALL(*mock_executor, GetConflictKeys)
+      .WillRepeatedly(::testing::Invoke([](const BatchUserRequest& request) {
+        const std::string& data = request.user_requests(0).request().data();
+        return std::make_unique<std::vector<std::string>>(
+            1, data.substr(data.find(':') + 1));
+      }));
+  EXPECT_CALL(*mock_executor, ExecuteBatch)
+      .Times(4)
+      .WillRepeatedly(::testing::Invoke([&](const BatchUserRequest& request) {
+        std::lock_guard<std::mutex> lk(mutex);
+        executed.push_back(request.user_requests(0).request().data());
+        return std::make_unique<BatchUserResponse>();
+      }));
+
+  GeoGlobalExecutor global_executor(std::move(mock_executor), config_);
+  // (2, 1) conflicts with (1, 2) and must be executed after it.
+  global_executor.OrderGeoRequest(GenerateRequest(2, 1, "b"));
+  global_executor.OrderGeoRequest(GenerateRequest(1, 1, "a"));
+  global_executor.OrderGeoRequest(GenerateRequest(2, 2, "c"));
+  global_executor.OrderGeoRequest(GenerateRequest(1, 2, "b"));
+
+  // The responses of the local region are returned in order.
+  for (uint64_t seq = 1; seq <= 2; ++seq) {
+    std::unique_ptr<BatchUserResponse> response;
+    while (response == nullptr) {
+      response = global_executor.GetResponseMsg();
+    }
+    EXPECT_EQ(response->seq(), seq);
+  }
+  // The other region may still be running.
+  while (true) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (executed.size() == 4) {
+      break;
+    }
+  }
+  global_executor.Stop();
+
+  std::lock_guard<std::mutex> lk(mutex);
+  auto pos = [&](const std::string& data) {
+    return std::find(executed.begin(), executed.end(), data) - executed.begin();
+  };
+  // Each region runs in order, and (2, 1) waits for (1, 2) sharing key b.
+  EXPECT_LT(pos("1/1:a"), pos("2/1:b"));
+  EXPECT_LT(pos("1/2:b"), pos("2/2:c"));
+  EXPECT_LT(pos("1/2:b"), pos("2/1:b"));
+}
+
+TEST_F(GeoRegionExecutorTest, RegionLag) {
+  auto mock_executor = std::make_unique<MockTransactionManager>();
+  // Without the conflict keys, the requests are executed in order.
+  EXPECT_CALL(*mock_executor, GetConflictKeys)
+      .WillRepeatedly(::testing::Invoke(
+          [](const BatchUserRequest&)
+              -> std::unique_ptr<std::vector<std::string>> {
+            return nullptr;
+          }));
+  std::atomic<int> executed = 0;
+  // (2, 1) is ordered before the missing (2, 2) and does not wait for it.
+  EXPECT_CALL(*mock_executor, ExecuteBatch)
+      .Times(3)
+      .WillRepeatedly(::testing::Invoke([&](const BatchUserRequest&) {
+        ++executed;
+        return std::make_unique<BatchUserResponse>();
+      }));
+
+  GeoGlobalExecutor global_executor(std::move(mock_executor), config_);
+  for (uint64_t seq = 1; seq <= 3; ++seq) {
+    global_executor.OrderGeoRequest(GenerateRequest(seq, 1, "a"));
+  }
+  global_executor.OrderGeoRequest(GenerateRequest(1, 2, "a"));
+  while (global_executor.GetRegionLag(2) != 2 || executed != 3) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(global_executor.GetRegionLag(1), 0);
+  global_executor.Stop();
+}
+
+TEST_F(GeoRegionExecutorTest, CommitStateAtRoundBoundary) {
+  auto mock_executor = std::make_unique<MockTransactionManager>();
+  EXPECT_CALL(*mock_executor, GetConflictKeys)
+      .WillRepeatedly(::testing::Invoke([](const BatchUserRequest& request) {
+        const std::string& data = request.user_requests(0).request().data();
+        return std::make_unique<std::vector<std::string>>(
+            1, data.substr(data.find(':') + 1));
+      }));
+  std::atomic<int> executed = 0;
+  EXPECT_CALL(*mock_executor, ExecuteBatch)
+      .Times(6)
+      .WillRepeatedly(::testing::Invoke([&](const BatchUserRequest&) {
+        ++executed;
+        return std::make_unique<BatchUserResponse>();
+      }));
+  // Each snapshot contains exactly the requests up to its round.
+  std::promise<void> done;
+  EXPECT_CALL(*mock_executor, CommitState)
+      .WillRepeatedly(::testing::Invoke([&](uint64_t seq) {
+        EXPECT_EQ(executed, seq * 2);
+        if (seq == 3) {
+          done.set_value();
+        }
+      }));
+
+  GeoGlobalExecutor global_executor(std::move(mock_executor), config_);
+  for (uint64_t seq = 1; seq <= 2; ++seq) {
+    global_executor.OrderGeoRequest(GenerateRequest(seq, 1, "a"));
+    global_executor.OrderGeoRequest(GenerateRequest(seq, 2, "b"));
+  }
+  // (3, 2) waits for (3, 1) and is not in the snapshot of round 2.
+  global_executor.OrderGeoRequest(GenerateRequest(3, 2, "b"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(executed, 4);
+  global_executor.OrderGeoRequest(GenerateRequest(3, 1, "a"));
+  done.get_future().get();
+  global_executor.Stop();
+}
+
 }  // namespace
 
 }  // namespace resdb
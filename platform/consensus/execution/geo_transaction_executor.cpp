@@ -27,6 +27,8 @@
 
 #include <glog/logging.h>
 
+#include "common/utils/compression.h"
+#include "common/utils/utils.h"
 #include "platform/consensus/ordering/common/transaction_utils.h"
 
 namespace resdb {
@@ -40,6 +42,8 @@ GeoTransactionExecutor::GeoTransactionExecutor(
       system_info_(std::move(system_info)),
       replica_communicator_(std::move(replica_communicator)),
       local_transaction_manager_(std::move(local_transaction_manager)),
+      batch_size_(config_.GetGeoBatchSize()),
+      batch_linger_ms_(config_.GetGeoBatchLingerMs()),
       is_stop_(false) {
   geo_thread_ = std::thread(&GeoTransactionExecutor::SendGeoMessages, this);
 }
@@ -59,15 +63,16 @@ void GeoTransactionExecutor::SendGeoMessages() {
     auto message = queue_.Pop(100);
     if (message != nullptr) {
       messages.push_back(std::move(message));
+      // Linger for more local batches so that they share one WAN message.
+      uint64_t deadline = GetCurrentTime() + batch_linger_ms_ * 1000;
       while (!IsStop() && messages.size() < batch_size_) {
-        auto message = queue_.Pop(0);
+        uint64_t now = GetCurrentTime();
+        int wait_ms = now < deadline ? (deadline - now + 999) / 1000 : 0;
+        auto message = queue_.Pop(wait_ms);
         if (message == nullptr) {
           break;
         }
         messages.push_back(std::move(message));
-        if (messages.size() >= batch_size_) {
-          break;
-        }
       }
     }
     if (messages.size() > 0) {
@@ -89,6 +94,11 @@ void GeoTransactionExecutor::SendBatchGeoMessage(
   }
   // Only for primary node: send out GEO_REQUEST to other regions.
   if (config_.GetSelfInfo().id() == system_info_->GetPrimaryId()) {
+    std::unique_ptr<Request> geo_batch_request =
+        NewGeoBatchRequest(batch_geo_request);
+    if (geo_batch_request == nullptr) {
+      return;
+    }
     for (const auto& region : config_data.region()) {
       if (region.region_id() == config_data.self_region_id()) {
         continue;
@@ -102,7 +112,7 @@ void GeoTransactionExecutor::SendBatchGeoMessage(
           break;
         }
         int ret =
-            replica_communicator_->SendBatchMessage(batch_geo_request, replica);
+            replica_communicator_->SendMessage(*geo_batch_request, replica);
         if (ret >= 0) {
           num_request_sent++;
         }
@@ -112,6 +122,29 @@ void GeoTransactionExecutor::SendBatchGeoMessage(
   }
 }
 
+std::unique_ptr<Request> GeoTransactionExecutor::NewGeoBatchRequest(
+    const std::vector<std::unique_ptr<Request>>& requests) {
+  GeoBatchRequest batch_request;
+  for (const auto& request : requests) {
+    *batch_request.add_requests() = *request;
+  }
+  std::string data;
+  batch_request.SerializeToString(&data);
+  absl::StatusOr<std::string> compressed = ZstdCompress(data);
+  if (!compressed.ok()) {
+    LOG(ERROR) << "compress geo batch fail:" << compressed.status();
+    return nullptr;
+  }
+
+  std::unique_ptr<Request> geo_batch_request = resdb::NewRequest(
+      Request::TYPE_GEO_BATCH_REQUEST, Request(), config_.GetSelfInfo().id(),
+      config_.GetConfigData().self_region_id());
+  geo_batch_request->mutable_data()->swap(*compressed);
+  geo_batch_request->set_hash(
+      SignatureVerifier::CalculateHash(geo_batch_request->data()));
+  return geo_batch_request;
+}
+
 std::unique_ptr<BatchUserResponse> GeoTransactionExecutor::ExecuteBatch(
     const BatchUserRequest& request) {
   std::unique_ptr<Request> geo_request = resdb::NewRequest(
@@ -120,12 +153,12 @@ std::unique_ptr<BatchUserResponse> GeoTransactionExecutor::ExecuteBatch(
 
   geo_request->set_seq(request.seq());
   geo_request->set_proxy_id(request.proxy_id());
+  // The data has to be filled before being hashed.
+  request.SerializeToString(geo_request->mutable_data());
   geo_request->set_hash(SignatureVerifier::CalculateHash(
       geo_request->data() + std::to_string(request.seq()) +
       std::to_string(config_.GetConfigData().self_region_id())));
 
-  request.SerializeToString(geo_request->mutable_data());
-
   queue_.Push(std::move(geo_request));
   return nullptr;
 }
@@ -47,6 +47,9 @@ class GeoTransactionExecutor : public TransactionManager {
   void SendGeoMessages();
   void SendBatchGeoMessage(
       const std::vector<std::unique_ptr<Request>>& requests);
+  // Pack the requests into one compressed TYPE_GEO_BATCH_REQUEST request.
+  std::unique_ptr<Request> NewGeoBatchRequest(
+      const std::vector<std::unique_ptr<Request>>& requests);
 
  protected:
   ResDBConfig config_;
@@ -54,7 +57,8 @@ class GeoTransactionExecutor : public TransactionManager {
   std::unique_ptr<ReplicaCommunicator> replica_communicator_;
   std::unique_ptr<TransactionManager> local_transaction_manager_ = nullptr;
   std::thread geo_thread_;
-  size_t batch_size_ = 50;
+  size_t batch_size_;
+  uint32_t batch_linger_ms_;
   LockFreeQueue<Request> queue_;
   std::atomic<bool> is_stop_;
 
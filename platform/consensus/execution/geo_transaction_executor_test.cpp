@@ -32,6 +32,7 @@
 #include <future>
 
 #include "common/test/test_macros.h"
+#include "common/utils/compression.h"
 #include "executor/common/mock_transaction_manager.h"
 #include "platform/config/resdb_config_utils.h"
 #include "platform/consensus/ordering/common/transaction_utils.h"
@@ -136,9 +137,36 @@ TEST(LocalExecutorTest, PrimaryNodeBroadcast) {
   int call_times = 0;
   std::promise<bool> done;
   std::future<bool> done_future = done.get_future();
-  EXPECT_CALL(*replica_communicator, SendBatchMessage)
-      .WillRepeatedly(Invoke([&]() {
-        if (++call_times >= 3) {
+  // Send to self.
+  EXPECT_CALL(*replica_communicator, SendBatchMessage).WillOnce(Return(0));
+  // Send f+1 compressed batches to region 2.
+  EXPECT_CALL(*replica_communicator,
+              SendMessage(_, Matcher<const ReplicaInfo&>(_)))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](const google::protobuf::Message& message,
+                                 const ReplicaInfo& replica) {
+        const Request& request = dynamic_cast<const Request&>(message);
+        EXPECT_EQ(request.type(), Request::TYPE_GEO_BATCH_REQUEST);
+        EXPECT_EQ(request.region_info().region_id(), 1);
+        EXPECT_EQ(request.hash(),
+                  SignatureVerifier::CalculateHash(request.data()));
+
+        absl::StatusOr<std::string> data = ZstdDecompress(request.data());
+        EXPECT_TRUE(data.ok());
+        GeoBatchRequest geo_batch_request;
+        EXPECT_TRUE(geo_batch_request.ParseFromString(*data));
+        EXPECT_EQ(geo_batch_request.requests_size(), 1);
+
+        const Request& geo_request = geo_batch_request.requests(0);
+        EXPECT_EQ(geo_request.type(), Request::TYPE_GEO_REQUEST);
+        EXPECT_EQ(geo_request.seq(), 1);
+        BatchUserRequest sent_request;
+        EXPECT_TRUE(sent_request.ParseFromString(geo_request.data()));
+        EXPECT_THAT(sent_request, EqualsProto(batch_request));
+        EXPECT_EQ(geo_request.hash(),
+                  SignatureVerifier::CalculateHash(geo_request.data() + "1" +
+                                                   "1"));
+        if (++call_times >= 2) {
           done.set_value(true);
         }
         return 0;
@@ -27,6 +27,8 @@
 
 #include <glog/logging.h>
 
+#include "common/utils/utils.h"
+
 namespace resdb {
 
 TransactionExecutor::TransactionExecutor(
@@ -39,9 +41,11 @@ TransactionExecutor::TransactionExecutor(
       transaction_manager_(std::move(transaction_manager)),
       commit_queue_("order"),
       execute_queue_("execute"),
+      execute_OOO_queue_("execute_ooo"),
       stop_(false),
       duplicate_manager_(nullptr) {
   global_stats_ = Stats::GetGlobalStats();
+  tracer_ = SeqTracer::GetGlobalTracer();
   ordering_thread_ = std::thread(&TransactionExecutor::OrderMessage, this);
   execute_thread_ = std::thread(&TransactionExecutor::ExecuteMessage, this);
 
@@ -71,6 +75,65 @@ Storage* TransactionExecutor::GetStorage() {
   return transaction_manager_ ? transaction_manager_->GetStorage() : nullptr;
 }
 
+std::unique_ptr<StateChunk> TransactionExecutor::GetStateChunk(uint64_t seq,
+                                                               uint32_t index) {
+  return transaction_manager_
+             ? transaction_manager_->GetStateChunk(seq, index)
+             : nullptr;
+}
+
+void TransactionExecutor::InstallState(uint64_t seq,
+                                       std::vector<StateChunk> chunks) {
+  // The ordering thread drops the requests up to seq and the execution thread
+  // writes the state once the requests ordered before it are executed.
+  std::lock_guard<std::mutex> lk(state_mutex_);
+  install_seq_ = seq;
+  install_chunks_ = std::move(chunks);
+}
+
+void TransactionExecutor::OrderState() {
+  uint64_t seq = 0;
+  {
+    std::lock_guard<std::mutex> lk(state_mutex_);
+    if (install_seq_ == 0) {
+      return;
+    }
+    seq = install_seq_;
+    install_seq_ = 0;
+    if (next_execute_seq_ > seq) {
+      // The requests up to seq have been ordered already.
+      install_chunks_.clear();
+      return;
+    }
+    apply_chunks_ = std::move(install_chunks_);
+    install_chunks_.clear();
+    apply_seq_ = seq;
+  }
+  candidates_.erase(candidates_.begin(), candidates_.upper_bound(seq));
+  next_execute_seq_ = seq + 1;
+  if (seq_update_notify_func_) {
+    seq_update_notify_func_(next_execute_seq_);
+  }
+}
+
+void TransactionExecutor::ApplyState(uint64_t seq) {
+  std::vector<StateChunk> chunks;
+  {
+    std::lock_guard<std::mutex> lk(state_mutex_);
+    // A later state has been ordered and replaces this one.
+    if (apply_seq_ != seq) {
+      return;
+    }
+    chunks.swap(apply_chunks_);
+    apply_seq_ = 0;
+  }
+  for (const StateChunk& chunk : chunks) {
+    if (transaction_manager_->ApplyStateChunk(chunk)) {
+      LOG(ERROR) << "apply state chunk fail:" << chunk.index();
+    }
+  }
+}
+
 void TransactionExecutor::SetPreExecuteFunc(PreExecuteFunc pre_exec_func) {
   pre_exec_func_ = pre_exec_func;
 }
@@ -92,6 +155,7 @@ bool TransactionExecutor::NeedResponse() {
 
 int TransactionExecutor::Commit(std::unique_ptr<Request> message) {
   global_stats_->IncPendingExecute();
+  tracer_->AddEvent(message->seq(), "commit_queue");
   if (transaction_manager_ && transaction_manager_->IsOutOfOrder()) {
     // LOG(ERROR)<<"add out of order exe:"<<message->seq()<<" from
     // proxy:"<<message->proxy_id();
@@ -122,6 +186,7 @@ std::unique_ptr<Request> TransactionExecutor::GetNextData() {
 
 void TransactionExecutor::OrderMessage() {
   while (!IsStop()) {
+    OrderState();
     auto message = commit_queue_.Pop();
     if (message != nullptr) {
       global_stats_->IncExecute();
@@ -140,6 +205,7 @@ void TransactionExecutor::OrderMessage() {
       if (message == nullptr) {
         break;
       }
+      tracer_->AddEvent(message->seq(), "ordered");
       execute_queue_.Push(std::move(message));
       next_execute_seq_++;
       if (seq_update_notify_func_) {
@@ -152,10 +218,20 @@ void TransactionExecutor::OrderMessage() {
 
 void TransactionExecutor::ExecuteMessage() {
   while (!IsStop()) {
+    // The requests ordered before a state are queued before apply_seq_ is
+    // set, so the queue is drained of them if it is empty after reading it.
+    uint64_t apply_seq = apply_seq_;
     auto message = execute_queue_.Pop();
     if (message == nullptr) {
+      if (apply_seq > 0) {
+        ApplyState(apply_seq);
+      }
       continue;
     }
+    apply_seq = apply_seq_;
+    if (apply_seq > 0 && message->seq() > apply_seq) {
+      ApplyState(apply_seq);
+    }
     bool need_execute = true;
     if (transaction_manager_ && transaction_manager_->IsOutOfOrder()) {
       need_execute = false;
@@ -224,7 +300,15 @@ void TransactionExecutor::Execute(std::unique_ptr<Request> request,
 
   std::unique_ptr<BatchUserResponse> response;
   if (transaction_manager_ && need_execute) {
+    tracer_->AddEvent(request->seq(), "execute");
+    uint64_t start_time = GetCurrentTime();
     response = transaction_manager_->ExecuteBatch(batch_request);
+    global_stats_->AddLatency(EXECUTE_LATENCY, GetCurrentTime() - start_time);
+    tracer_->AddEvent(request->seq(), "executed");
+    transaction_manager_->CommitState(request->seq());
+    if (request->seq() % config_.GetCheckPointInterval() == 0) {
+      request->set_state_digest(transaction_manager_->CheckPointState());
+    }
   }
 
   if (duplicate_manager_) {
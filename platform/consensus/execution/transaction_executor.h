@@ -33,6 +33,7 @@
 #include "platform/consensus/execution/duplicate_manager.h"
 #include "platform/consensus/execution/system_info.h"
 #include "platform/proto/resdb.pb.h"
+#include "platform/statistic/seq_tracer.h"
 #include "platform/statistic/stats.h"
 
 namespace resdb {
@@ -70,6 +71,13 @@ class TransactionExecutor {
 
   Storage* GetStorage();
 
+  // Return the chunk `index` of the state kept at the checkpoint seq.
+  std::unique_ptr<StateChunk> GetStateChunk(uint64_t seq, uint32_t index);
+
+  // Replace the execution up to seq by writing the verified chunks of the
+  // state at seq. The requests not executed yet up to seq are dropped.
+  void InstallState(uint64_t seq, std::vector<StateChunk> chunks);
+
  private:
   void Execute(std::unique_ptr<Request> request, bool need_execute = true);
   void OnlyExecute(std::unique_ptr<Request> request);
@@ -86,6 +94,11 @@ class TransactionExecutor {
 
   void UpdateMaxExecutedSeq(uint64_t seq);
 
+  // Drop the requests up to the state to install, if any.
+  void OrderState();
+  // Write the state ordered at seq.
+  void ApplyState(uint64_t seq);
+
  protected:
   ResDBConfig config_;
 
@@ -101,7 +114,16 @@ class TransactionExecutor {
   LockFreeQueue<Request> commit_queue_, execute_queue_, execute_OOO_queue_;
   std::atomic<bool> stop_;
   Stats* global_stats_ = nullptr;
+  SeqTracer* tracer_ = nullptr;
   DuplicateManager* duplicate_manager_;
+  std::mutex state_mutex_;
+  // The state to install, taken by the ordering thread.
+  uint64_t install_seq_ = 0;
+  std::vector<StateChunk> install_chunks_;
+  // The state ordered, written by the execution thread before the requests
+  // after apply_seq_.
+  std::atomic<uint64_t> apply_seq_ = 0;
+  std::vector<StateChunk> apply_chunks_;
 };
 
 }  // namespace resdb
@@ -283,6 +283,72 @@ TEST(TransactionExecutorTest, CallBack) {
   done_future.get();
 }
 
+TEST(TransactionExecutorTest, InstallState) {
+  ResDBConfig config = GetResDBConfig();
+  SystemInfo system_info(config);
+  auto mock_executor = std::make_unique<MockTransactionManager>();
+
+  std::promise<bool> done;
+  std::future<bool> done_future = done.get_future();
+  EXPECT_CALL(*mock_executor, ApplyStateChunk)
+      .WillOnce(Invoke([&](const StateChunk& chunk) {
+        EXPECT_EQ(chunk.index(), 1);
+        return 0;
+      }));
+  EXPECT_CALL(*mock_executor, ExecuteBatch)
+      .WillOnce(Invoke([&](const BatchUserRequest& request) {
+        EXPECT_EQ(request.seq(), 4);
+        done.set_value(true);
+        return nullptr;
+      }));
+
+  TransactionExecutor executor(
+      config,
+      [&](std::unique_ptr<Request>, std::unique_ptr<BatchUserResponse> resp) {},
+      &system_info, std::move(mock_executor));
+
+  // seq 3 is waiting for the previous ones and is replaced by the state.
+  Request request;
+  request.set_seq(3);
+  EXPECT_EQ(executor.Commit(std::make_unique<Request>(request)), 0);
+
+  std::vector<StateChunk> chunks(1);
+  chunks[0].set_index(1);
+  executor.InstallState(3, std::move(chunks));
+
+  request.set_seq(4);
+  EXPECT_EQ(executor.Commit(std::make_unique<Request>(request)), 0);
+  done_future.get();
+}
+
+TEST(TransactionExecutorTest, CommitStateQueryType) {
+  ResDBConfig config = GetResDBConfig();
+  SystemInfo system_info(config);
+  auto mock_executor = std::make_unique<MockTransactionManager>();
+
+  std::promise<bool> done;
+  std::future<bool> done_future = done.get_future();
+  // A committed request is executed whatever its type says.
+  EXPECT_CALL(*mock_executor, ApplyStateChunk).Times(0);
+  EXPECT_CALL(*mock_executor, ExecuteBatch)
+      .WillOnce(Invoke([&](const BatchUserRequest& request) {
+        EXPECT_EQ(request.seq(), 1);
+        done.set_value(true);
+        return nullptr;
+      }));
+
+  TransactionExecutor executor(
+      config,
+      [&](std::unique_ptr<Request>, std::unique_ptr<BatchUserResponse> resp) {},
+      &system_info, std::move(mock_executor));
+
+  Request request;
+  request.set_seq(1);
+  request.set_type(Request::TYPE_STATE_QUERY);
+  EXPECT_EQ(executor.Commit(std::make_unique<Request>(request)), 0);
+  done_future.get();
+}
+
 }  // namespace
 
 }  // namespace resdb
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/common/load_generator.h"
+
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include "common/utils/utils.h"
+
+namespace resdb {
+
+LoadGenerator::LoadGenerator(const ResDBConfig& config)
+    : rates_(config.GetLoadRates()),
+      poisson_(config.IsLoadPoissonArrival()),
+      step_time_(config.GetLoadStepTimeS() * 1000000ull),
+      max_pending_num_(config.GetMaxPendingLoadNum()),
+      stop_(false),
+      pending_num_(0),
+      random_(std::random_device()()),
+      step_snapshot_(latency_.GetSnapshot()) {}
+
+bool LoadGenerator::IsOpenLoop() const { return !rates_.empty(); }
+
+void LoadGenerator::Stop() { stop_ = true; }
+
+void LoadGenerator::Consume(int num) { pending_num_ -= num; }
+
+void LoadGenerator::Run(std::function<void(uint64_t)> issue,
+                        std::function<void()> ready) {
+  if (IsOpenLoop()) {
+    RunOpenLoop(issue, ready);
+  } else {
+    RunClosedLoop(issue, ready);
+  }
+}
+
+// Wait until there is room for one more request. Return false if stopped.
+bool LoadGenerator::WaitPending() {
+  while (pending_num_ >= max_pending_num_) {
+    if (stop_) {
+      return false;
+    }
+    usleep(100);
+  }
+  return !stop_;
+}
+
+void LoadGenerator::RunClosedLoop(const std::function<void(uint64_t)>& issue,
+                                  const std::function<void()>& ready) {
+  bool is_ready = false;
+  while (!stop_) {
+    if (pending_num_ >= max_pending_num_ && !is_ready) {
+      // Start batching once the first window is generated.
+      ready();
+      is_ready = true;
+    }
+    if (!WaitPending()) {
+      break;
+    }
+    pending_num_++;
+    issue(GetCurrentTime());
+  }
+  if (!is_ready) {
+    ready();
+  }
+}
+
+double LoadGenerator::GetInterval(uint32_t rate) {
+  if (poisson_) {
+    return std::exponential_distribution<double>(rate)(random_) * 1e6;
+  }
+  return 1e6 / rate;
+}
+
+void LoadGenerator::RunOpenLoop(const std::function<void(uint64_t)>& issue,
+                                const std::function<void()>& ready) {
+  ready();
+  double next_time = GetCurrentTime();
+  for (size_t i = 0; i < rates_.size() && !stop_; ++i) {
+    uint64_t start_time = next_time;
+    bool last = i + 1 == rates_.size();
+    uint64_t issue_num = 0;
+    LOG(WARNING) << "start load rate:" << rates_[i]
+                 << (poisson_ ? " poisson" : " constant") << " arrival";
+    while (!stop_) {
+      if (next_time >= start_time + step_time_) {
+        // The last rate runs until the generator is stopped, so it is
+        // logged once per step time instead of only at the end.
+        LogStep(rates_[i], start_time, issue_num);
+        if (!last) {
+          break;
+        }
+        start_time = next_time;
+        issue_num = 0;
+      }
+      uint64_t intended_time = next_time;
+      uint64_t current_time = GetCurrentTime();
+      if (intended_time > current_time) {
+        usleep(intended_time - current_time);
+      }
+      // If the batching falls behind, the requests queue up here in the
+      // schedule rather than in memory, still charged from their intended
+      // time.
+      if (!WaitPending()) {
+        break;
+      }
+      pending_num_++;
+      issue(intended_time);
+      issue_num++;
+      next_time += GetInterval(rates_[i]);
+    }
+    if (stop_ && issue_num > 0) {
+      LogStep(rates_[i], start_time, issue_num);
+    }
+  }
+}
+
+void LoadGenerator::LogStep(uint32_t rate, uint64_t start_time,
+                            uint64_t issue_num) {
+  LatencyHistogram::Snapshot snapshot = latency_.GetSnapshot();
+  LatencyHistogram::Snapshot step = snapshot - step_snapshot_;
+  step_snapshot_ = snapshot;
+
+  double run_time = (GetCurrentTime() - start_time) / 1e6;
+  if (run_time <= 0) {
+    return;
+  }
+  LOG(ERROR) << "load step rate:" << rate
+             << " offered:" << issue_num / run_time
+             << " throughput:" << step.count / run_time
+             << " mean(us):" << step.GetMean()
+             << " p50(us):" << step.GetPercentile(50)
+             << " p90(us):" << step.GetPercentile(90)
+             << " p99(us):" << step.GetPercentile(99)
+             << " p999(us):" << step.GetPercentile(99.9);
+}
+
+void LoadGenerator::AddBatch(uint64_t id,
+                             std::vector<uint64_t> intended_times) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  batches_[id] = std::move(intended_times);
+}
+
+std::vector<uint64_t> LoadGenerator::FinishBatch(uint64_t id) {
+  std::vector<uint64_t> intended_times;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = batches_.find(id);
+    if (it == batches_.end()) {
+      return intended_times;
+    }
+    intended_times = std::move(it->second);
+    batches_.erase(it);
+  }
+  uint64_t current_time = GetCurrentTime();
+  std::vector<uint64_t> latencies;
+  for (uint64_t intended_time : intended_times) {
+    latencies.push_back(
+        current_time > intended_time ? current_time - intended_time : 0);
+    latency_.Record(latencies.back());
+  }
+  return latencies;
+}
+
+}  // namespace resdb
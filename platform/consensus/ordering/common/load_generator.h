@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "platform/config/resdb_config.h"
+#include "platform/statistic/latency_histogram.h"
+
+namespace resdb {
+
+// LoadGenerator paces the requests issued by the performance clients.
+//
+// In the closed loop it generates the requests as they are consumed, keeping
+// at most GetMaxPendingLoadNum() of them waiting to be batched.
+//
+// In the open loop it issues them at the rates from GetLoadRates(), each one
+// at an intended time drawn from constant or Poisson arrivals. The latency of
+// a request is measured from its intended time rather than from the time it
+// was sent, so the time it waits behind a saturated system is not omitted.
+// A summary is logged after each rate to draw the throughput-latency curve.
+// The last rate keeps running until Stop() and is logged every step time.
+class LoadGenerator {
+ public:
+  explicit LoadGenerator(const ResDBConfig& config);
+
+  bool IsOpenLoop() const;
+
+  // Call issue(intended_time) for each request until Stop() is called.
+  // ready() is called once the batching threads are able to start.
+  void Run(std::function<void(uint64_t)> issue, std::function<void()> ready);
+  void Stop();
+
+  // The batching threads have taken num requests.
+  void Consume(int num);
+
+  // Keep the intended times of the requests sent in the batch until
+  // FinishBatch() returns their latencies (us) once the batch is responded.
+  void AddBatch(uint64_t id, std::vector<uint64_t> intended_times);
+  std::vector<uint64_t> FinishBatch(uint64_t id);
+
+ private:
+  void RunClosedLoop(const std::function<void(uint64_t)>& issue,
+                     const std::function<void()>& ready);
+  void RunOpenLoop(const std::function<void(uint64_t)>& issue,
+                   const std::function<void()>& ready);
+  // The time (us) to the next arrival.
+  double GetInterval(uint32_t rate);
+  bool WaitPending();
+  void LogStep(uint32_t rate, uint64_t start_time, uint64_t issue_num);
+
+ private:
+  std::vector<uint32_t> rates_;
+  bool poisson_;
+  uint64_t step_time_;
+  int max_pending_num_;
+  std::atomic<bool> stop_;
+  std::atomic<int> pending_num_;
+  std::mt19937_64 random_;
+
+  std::mutex mutex_;
+  std::map<uint64_t, std::vector<uint64_t>> batches_;
+  LatencyHistogram latency_;
+  LatencyHistogram::Snapshot step_snapshot_;
+};
+
+}  // namespace resdb
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/common/load_generator.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "common/utils/utils.h"
+
+namespace resdb {
+namespace {
+
+ResDBConfig GetConfig(const std::vector<uint32_t>& rates, bool poisson,
+                      int max_pending_num) {
+  ResConfigData config_data;
+  for (uint32_t rate : rates) {
+    config_data.add_load_rates(rate);
+  }
+  config_data.set_load_poisson_arrival(poisson);
+  config_data.set_load_step_time_s(1);
+  config_data.set_max_pending_load_num(max_pending_num);
+  return ResDBConfig(config_data, ReplicaInfo(), KeyInfo(), CertificateInfo());
+}
+
+// Run the generator until num requests are issued, returning their intended
+// times.
+std::vector<uint64_t> Generate(LoadGenerator* generator, int num) {
+  std::vector<uint64_t> times;
+  std::thread run([&]() {
+    generator->Run(
+        [&](uint64_t intended_time) {
+          times.push_back(intended_time);
+          generator->Consume(1);
+          if (times.size() == static_cast<size_t>(num)) {
+            generator->Stop();
+          }
+        },
+        []() {});
+  });
+  run.join();
+  return times;
+}
+
+TEST(LoadGeneratorTest, ClosedLoopBoundsPending) {
+  LoadGenerator generator(GetConfig({}, false, 10));
+  EXPECT_FALSE(generator.IsOpenLoop());
+
+  std::atomic<int> issue_num = 0;
+  std::atomic<bool> ready = false;
+  std::thread run([&]() {
+    generator.Run([&](uint64_t) { issue_num++; }, [&]() { ready = true; });
+  });
+  while (!ready) {
+    usleep(1000);
+  }
+  usleep(10000);
+  EXPECT_EQ(issue_num, 10);
+
+  generator.Consume(5);
+  while (issue_num < 15) {
+    usleep(1000);
+  }
+  usleep(10000);
+  EXPECT_EQ(issue_num, 15);
+
+  generator.Stop();
+  run.join();
+}
+
+TEST(LoadGeneratorTest, ConstantArrival) {
+  LoadGenerator generator(GetConfig({1000}, false, 10));
+  EXPECT_TRUE(generator.IsOpenLoop());
+
+  std::vector<uint64_t> times = Generate(&generator, 100);
+  ASSERT_EQ(times.size(), 100);
+  for (size_t i = 1; i < times.size(); ++i) {
+    EXPECT_NEAR(times[i] - times[i - 1], 1000, 1);
+  }
+}
+
+TEST(LoadGeneratorTest, PoissonArrival) {
+  LoadGenerator generator(GetConfig({100000}, true, 10));
+
+  std::vector<uint64_t> times = Generate(&generator, 10000);
+  ASSERT_EQ(times.size(), 10000);
+  double mean = (times.back() - times.front()) / (times.size() - 1.0);
+  EXPECT_NEAR(mean, 10, 1);
+}
+
+TEST(LoadGeneratorTest, LatencyFromIntendedTime) {
+  LoadGenerator generator(GetConfig({1000}, false, 10));
+
+  uint64_t current_time = GetCurrentTime();
+  generator.AddBatch(1, {current_time - 3000, current_time - 1000});
+  std::vector<uint64_t> latencies = generator.FinishBatch(1);
+  ASSERT_EQ(latencies.size(), 2);
+  EXPECT_GE(latencies[0], 3000);
+  EXPECT_GE(latencies[1], 1000);
+  EXPECT_LT(latencies[1], latencies[0]);
+
+  EXPECT_TRUE(generator.FinishBatch(1).empty());
+}
+
+}  // namespace
+}  // namespace resdb
@@ -38,8 +38,9 @@ PerformanceManager::PerformanceManager(
     : config_(config),
       system_info_(system_info),
       replica_communicator_(replica_communicator),
-      batch_queue_("user request"),
-      verifier_(verifier) {
+      batch_queue_("user request", config_.GetMaxPendingLoadNum()),
+      verifier_(verifier),
+      load_generator_(std::make_unique<LoadGenerator>(config_)) {
   stop_ = false;
   local_id_ = 0;
   send_num_ = 0;
@@ -61,6 +62,7 @@ PerformanceManager::PerformanceManager(
 
 PerformanceManager::~PerformanceManager() {
   stop_ = true;
+  load_generator_->Stop();
   for (int i = 0; i < 16; ++i) {
     if (user_req_thread_[i].joinable()) {
       user_req_thread_[i].join();
@@ -86,14 +88,14 @@ int PerformanceManager::StartEval() {
     return 0;
   }
   eval_started_ = true;
-  for (int i = 0; i < 60000000000; ++i) {
-    std::unique_ptr<QueueItem> queue_item = std::make_unique<QueueItem>();
-    queue_item->user_request = GenerateUserRequest();
-    batch_queue_.Push(std::move(queue_item));
-    if (i == 20000000) {
-      eval_ready_promise_.set_value(true);
-    }
-  }
+  load_generator_->Run(
+      [&](uint64_t intended_time) {
+        std::unique_ptr<QueueItem> queue_item = std::make_unique<QueueItem>();
+        queue_item->user_request = GenerateUserRequest();
+        queue_item->intended_time = intended_time;
+        batch_queue_.Push(std::move(queue_item));
+      },
+      [&]() { eval_ready_promise_.set_value(true); });
   LOG(WARNING) << "start eval done";
   return 0;
 }
@@ -161,7 +163,13 @@ void PerformanceManager::SendResponseToClient(
     const BatchUserResponse& batch_response) {
   uint64_t create_time = batch_response.createtime();
   uint64_t local_id = batch_response.local_id();
-  if (create_time > 0) {
+  if (load_generator_->IsOpenLoop()) {
+    // Charge each request from the time it was meant to be sent. It also
+    // counts in the average client latency, like the closed loop.
+    for (uint64_t latency : load_generator_->FinishBatch(local_id)) {
+      global_stats_->AddLatency(latency);
+    }
+  } else if (create_time > 0) {
     uint64_t run_time = GetCurrentTime() - create_time;
     global_stats_->AddLatency(run_time);
   } else {
@@ -183,12 +191,10 @@ int PerformanceManager::BatchProposeMsg() {
       continue;
     }
     if (batch_req.size() < config_.ClientBatchNum()) {
-      std::unique_ptr<QueueItem> item =
-          batch_queue_.Pop(config_.ClientBatchWaitTimeMS());
-      if (item == nullptr) {
-        continue;
-      }
-      batch_req.push_back(std::move(item));
+      size_t num = batch_queue_.PopBatch(
+          &batch_req, config_.ClientBatchNum() - batch_req.size(),
+          config_.ClientBatchWaitTimeMS() * 1000);
+      load_generator_->Consume(num);
       if (batch_req.size() < config_.ClientBatchNum()) {
         continue;
       }
@@ -229,11 +235,20 @@ int PerformanceManager::DoBatch(
   new_request->set_hash(SignatureVerifier::CalculateHash(new_request->data()));
   new_request->set_proxy_id(config_.GetSelfInfo().id());
 
+  if (load_generator_->IsOpenLoop()) {
+    std::vector<uint64_t> intended_times;
+    for (const auto& item : batch_req) {
+      intended_times.push_back(item->intended_time);
+    }
+    load_generator_->AddBatch(batch_request.local_id(),
+                              std::move(intended_times));
+  }
   replica_communicator_->SendMessage(*new_request, GetPrimary());
   global_stats_->BroadCastMsg();
   send_num_++;
   if (total_num_++ == 1000000) {
     stop_ = true;
+    load_generator_->Stop();
     LOG(WARNING) << "total num is done:" << total_num_;
   }
   if (total_num_ % 10000 == 0) {
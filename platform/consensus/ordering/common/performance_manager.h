@@ -27,7 +27,9 @@
 
 #include <future>
 
+#include "platform/common/queue/mpmc_queue.h"
 #include "platform/config/resdb_config.h"
+#include "platform/consensus/ordering/common/load_generator.h"
 #include "platform/consensus/execution/system_info.h"
 #include "platform/consensus/ordering/common/transaction_utils.h"
 #include "platform/networkstrate/replica_communicator.h"
@@ -60,6 +62,8 @@ class PerformanceManager {
 
   struct QueueItem {
     std::unique_ptr<Request> user_request;
+    // The time the request was meant to be sent in the open loop.
+    uint64_t intended_time = 0;
   };
   int DoBatch(const std::vector<std::unique_ptr<QueueItem>>& batch_req);
   int BatchProposeMsg();
@@ -70,7 +74,7 @@ class PerformanceManager {
   ResDBConfig config_;
   SystemInfo* system_info_;
   ReplicaCommunicator* replica_communicator_;
-  LockFreeQueue<QueueItem> batch_queue_;
+  MPMCQueue<std::unique_ptr<QueueItem>> batch_queue_;
   std::thread user_req_thread_[16];
   std::atomic<bool> stop_;
   std::atomic<uint64_t> local_id_;
@@ -85,6 +89,7 @@ class PerformanceManager {
   std::promise<bool> eval_ready_promise_;
   std::atomic<bool> eval_started_;
   std::atomic<int> fail_num_;
+  std::unique_ptr<LoadGenerator> load_generator_;
   static const int response_set_size_ = 6000000;
   std::map<int64_t, int> response_[response_set_size_];
   std::mutex response_lock_[response_set_size_];
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace resdb {
+
+// A set of sender ids in [0, max_id] backed by a bitmap. Replica ids start
+// from 1, so the replica number can be used as max_id. Clear() keeps the
+// memory for reuse.
+class SenderSet {
+ public:
+  SenderSet(uint32_t max_id = 0)
+      : max_id_(max_id), bits_(max_id / 64 + 1, 0), count_(0) {}
+
+  // Return false if the id is out of range or has been added.
+  bool Add(uint32_t id) {
+    if (id > max_id_) {
+      return false;
+    }
+    size_t word = id / 64;
+    uint64_t mask = 1ull << (id % 64);
+    if (bits_[word] & mask) {
+      return false;
+    }
+    bits_[word] |= mask;
+    ++count_;
+    return true;
+  }
+
+  bool Contains(uint32_t id) const {
+    return id <= max_id_ && (bits_[id / 64] & (1ull << (id % 64)));
+  }
+
+  size_t Count() const { return count_; }
+
+  void Clear() {
+    std::fill(bits_.begin(), bits_.end(), 0);
+    count_ = 0;
+  }
+
+ private:
+  uint32_t max_id_;
+  std::vector<uint64_t> bits_;
+  size_t count_;
+};
+
+// The lock-free version of SenderSet. Add() can be called from multiple
+// threads. The count is derived from the bits, so an Add() racing with
+// Clear() leaves at most its bit set and is never counted twice.
+class AtomicSenderSet {
+ public:
+  AtomicSenderSet(uint32_t max_id = 0)
+      : max_id_(max_id),
+        size_(max_id / 64 + 1),
+        bits_(std::make_unique<std::atomic<uint64_t>[]>(size_)) {
+    Clear();
+  }
+
+  // Return false if the id is out of range or has been added.
+  bool Add(uint32_t id) {
+    if (id > max_id_) {
+      return false;
+    }
+    uint64_t mask = 1ull << (id % 64);
+    return !(bits_[id / 64].fetch_or(mask, std::memory_order_acq_rel) & mask);
+  }
+
+  bool Contains(uint32_t id) const {
+    return id <= max_id_ && (bits_[id / 64].load(std::memory_order_acquire) &
+                             (1ull << (id % 64)));
+  }
+
+  size_t Count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < size_; ++i) {
+      count += __builtin_popcountll(bits_[i].load(std::memory_order_acquire));
+    }
+    return count;
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < size_; ++i) {
+      bits_[i].store(0, std::memory_order_release);
+    }
+  }
+
+ private:
+  uint32_t max_id_;
+  size_t size_;
+  std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+};
+
+}  // namespace resdb
@@ -27,6 +27,7 @@
 
 #include <glog/logging.h>
 
+#include "common/utils/compression.h"
 #include "platform/consensus/ordering/common/transaction_utils.h"
 
 namespace resdb {
@@ -68,27 +69,26 @@ bool GeoPBFTCommitment::VerifyCerts(const BatchUserRequest& request,
   return true;
 }
 
-bool GeoPBFTCommitment::AddNewReq(uint64_t seq, uint32_t sender_region) {
-  std::lock_guard<std::mutex> lk(mutex_);
-  if (seq < min_seq_) {
-    return false;
-  }
+SeqRegionSet::AddResult GeoPBFTCommitment::AddNewReq(uint64_t seq,
+                                                     uint32_t sender_region) {
   // LOG(ERROR)<<"add req seq:"<<seq<<" regioin:"<<sender_region;
-  auto ret = checklist_[seq % (1 << 20)].insert(sender_region);
-  return ret.second;
+  return checklist_.Add(seq, sender_region);
 }
 
 void GeoPBFTCommitment::UpdateSeq(uint64_t seq) {
-  std::lock_guard<std::mutex> lk(mutex_);
-  if (seq > min_seq_) {
-    min_seq_ = seq;
-  }
+  // A request is only executed once all the requests ordered before it have
+  // been delivered, so all the seqs smaller than the executed one have been
+  // received from every region.
+  checklist_.Release(seq);
+  OrderDeferredRequests();
 }
 
 int GeoPBFTCommitment::GeoProcessCcm(std::unique_ptr<Context> context,
                                      std::unique_ptr<Request> request) {
   int sender_region_id = request->region_info().region_id();
-  if (!AddNewReq(request->seq(), sender_region_id)) {
+  SeqRegionSet::AddResult add_result =
+      AddNewReq(request->seq(), sender_region_id);
+  if (add_result == SeqRegionSet::kExists) {
     // LOG(ERROR) << "geo_request already received, from sender id: "
     //		       << request->sender_id() << " seq:" << request->seq() <<"
     // region:"<<sender_region_id
@@ -111,6 +111,15 @@ int GeoPBFTCommitment::GeoProcessCcm(std::unique_ptr<Context> context,
   }
   // return global_executor_->OrderGeoRequest(std::move(request));
 
+  if (add_result == SeqRegionSet::kAhead) {
+    DeferRequest(std::move(request));
+    return 0;
+  }
+  return OrderRequest(std::move(request));
+}
+
+int GeoPBFTCommitment::OrderRequest(std::unique_ptr<Request> request) {
+  int sender_region_id = request->region_info().region_id();
   ResConfigData config_data = config_.GetConfigData();
   int self_region_id = config_data.self_region_id();
   // LOG(ERROR)<<"get request seq:"<<request->seq()<<" from:"<<sender_region_id;
@@ -126,6 +135,69 @@ int GeoPBFTCommitment::GeoProcessCcm(std::unique_ptr<Context> context,
   return global_executor_->OrderGeoRequest(std::move(request));
 }
 
+void GeoPBFTCommitment::DeferRequest(std::unique_ptr<Request> request) {
+  {
+    std::lock_guard<std::mutex> lk(deferred_mutex_);
+    std::pair<uint64_t, uint32_t> key(request->seq(),
+                                      request->region_info().region_id());
+    deferred_.emplace(key, std::move(request));
+  }
+  // The window may have moved since the request was checked.
+  OrderDeferredRequests();
+}
+
+void GeoPBFTCommitment::OrderDeferredRequests() {
+  std::vector<std::unique_ptr<Request>> requests;
+  {
+    std::lock_guard<std::mutex> lk(deferred_mutex_);
+    while (!deferred_.empty()) {
+      auto it = deferred_.begin();
+      SeqRegionSet::AddResult add_result =
+          AddNewReq(it->first.first, it->first.second);
+      if (add_result == SeqRegionSet::kAhead) {
+        break;
+      }
+      if (add_result == SeqRegionSet::kAdded) {
+        requests.push_back(std::move(it->second));
+      }
+      deferred_.erase(it);
+    }
+  }
+  for (auto& request : requests) {
+    OrderRequest(std::move(request));
+  }
+}
+
+int GeoPBFTCommitment::GeoProcessBatch(std::unique_ptr<Context> context,
+                                       std::unique_ptr<Request> request) {
+  if (request->hash() != SignatureVerifier::CalculateHash(request->data())) {
+    LOG(ERROR) << "geo batch hash not match";
+    return -2;
+  }
+  absl::StatusOr<std::string> data = ZstdDecompress(request->data());
+  if (!data.ok()) {
+    LOG(ERROR) << "decompress geo batch fail:" << data.status();
+    return -2;
+  }
+  GeoBatchRequest batch_request;
+  if (!batch_request.ParseFromString(*data)) {
+    LOG(ERROR) << "parse geo batch fail";
+    return -2;
+  }
+  for (auto& geo_request : *batch_request.mutable_requests()) {
+    if (geo_request.region_info().region_id() !=
+        request->region_info().region_id()) {
+      LOG(ERROR) << "geo request region not match:"
+                 << geo_request.region_info().region_id();
+      continue;
+    }
+    auto sub_request = std::make_unique<Request>();
+    sub_request->Swap(&geo_request);
+    GeoProcessCcm(nullptr, std::move(sub_request));
+  }
+  return 0;
+}
+
 int GeoPBFTCommitment::PostProcessExecutedMsg() {
   while (!stop_) {
     auto batch_resp = global_executor_->GetResponseMsg();
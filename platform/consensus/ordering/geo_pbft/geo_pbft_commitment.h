@@ -25,10 +25,13 @@
 
 #pragma once
 
+#include <map>
+#include <mutex>
+
 #include "platform/config/resdb_config.h"
 #include "platform/consensus/execution/geo_global_executor.h"
 #include "platform/consensus/execution/system_info.h"
-#include "platform/consensus/ordering/geo_pbft/hash_set.h"
+#include "platform/consensus/ordering/geo_pbft/seq_region_set.h"
 #include "platform/networkstrate/replica_communicator.h"
 #include "platform/networkstrate/server_comm.h"
 #include "platform/proto/resdb.pb.h"
@@ -47,28 +50,41 @@ class GeoPBFTCommitment {
 
   int GeoProcessCcm(std::unique_ptr<Context> context,
                     std::unique_ptr<Request> request);
+  // Unpack the compressed geo requests sent from another region.
+  int GeoProcessBatch(std::unique_ptr<Context> context,
+                      std::unique_ptr<Request> request);
 
  private:
   bool VerifyCerts(const BatchUserRequest& request,
                    const std::string& raw_data);
 
-  bool AddNewReq(uint64_t seq, uint32_t sender_region);
+  SeqRegionSet::AddResult AddNewReq(uint64_t seq, uint32_t sender_region);
   void UpdateSeq(uint64_t seq);
+  // Broadcast a verified request from another region to the local replicas
+  // and pass it to the global executor.
+  int OrderRequest(std::unique_ptr<Request> request);
+  // Keep a verified request ahead of the window until the window reaches
+  // it.
+  void DeferRequest(std::unique_ptr<Request> request);
+  // Order the deferred requests which are in the window now.
+  void OrderDeferredRequests();
 
   int PostProcessExecutedMsg();
 
  private:
   std::unique_ptr<GeoGlobalExecutor> global_executor_;
   std::atomic<bool> stop_;
-  std::set<uint32_t> checklist_[1 << 20];
+  // The (seq, region) pairs received, released once the seq is executed.
+  SeqRegionSet checklist_;
+  std::mutex deferred_mutex_;
+  // The requests ahead of the window of checklist_, keyed by (seq, region).
+  std::map<std::pair<uint64_t, uint32_t>, std::unique_ptr<Request>> deferred_;
   ResDBConfig config_;
   std::unique_ptr<SystemInfo> system_info_ = nullptr;
   ReplicaCommunicator* replica_communicator_;
   SignatureVerifier* verifier_;
   Stats* global_stats_;
-  std::mutex mutex_;
   std::thread executed_thread_;
-  uint64_t min_seq_ = 0;
 };
 
 }  // namespace resdb
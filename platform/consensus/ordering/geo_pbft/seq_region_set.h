@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace resdb {
+
+// A set of (seq, region) pairs sharded by seq. Seqs smaller than the low
+// water mark are released by Release() as the global execution advances and
+// reported as existing. Seqs max_window or more above it are not added and
+// are reported as ahead, for the caller to add again once the window moves,
+// so the memory is bounded by the window.
+class SeqRegionSet {
+ public:
+  static constexpr uint64_t kDefaultMaxWindow = 1 << 18;
+
+  enum AddResult {
+    kAdded = 0,
+    // (seq, region) has been added or seq has been released.
+    kExists = 1,
+    // seq is out of the window.
+    kAhead = 2,
+  };
+
+  SeqRegionSet(uint32_t shard_num = 64,
+               uint64_t max_window = kDefaultMaxWindow)
+      : shards_(std::max<uint32_t>(shard_num, 1)),
+        max_window_(std::max<uint64_t>(max_window, 1)),
+        min_seq_(0) {}
+
+  AddResult Add(uint64_t seq, uint32_t region) {
+    Shard& shard = GetShard(seq);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    // min_seq_ is checked under the shard lock so that Release() never
+    // misses a seq added concurrently.
+    uint64_t min_seq = min_seq_.load(std::memory_order_acquire);
+    if (seq < min_seq) {
+      return kExists;
+    }
+    if (seq - min_seq >= max_window_) {
+      return kAhead;
+    }
+    std::vector<uint32_t>& regions = shard.regions[seq];
+    if (std::find(regions.begin(), regions.end(), region) != regions.end()) {
+      return kExists;
+    }
+    regions.push_back(region);
+    return kAdded;
+  }
+
+  bool Contains(uint64_t seq, uint32_t region) {
+    Shard& shard = GetShard(seq);
+    std::lock_guard<std::mutex> lk(shard.mutex);
+    auto it = shard.regions.find(seq);
+    return it != shard.regions.end() &&
+           std::find(it->second.begin(), it->second.end(), region) !=
+               it->second.end();
+  }
+
+  // Release all the seqs smaller than min_seq.
+  void Release(uint64_t min_seq) {
+    std::lock_guard<std::mutex> lk(release_mutex_);
+    uint64_t old_min_seq = min_seq_.load(std::memory_order_acquire);
+    if (min_seq <= old_min_seq) {
+      return;
+    }
+    min_seq_.store(min_seq, std::memory_order_release);
+    if (min_seq - old_min_seq <= shards_.size() * kMaxReleaseStep) {
+      for (uint64_t seq = old_min_seq; seq < min_seq; ++seq) {
+        Shard& shard = GetShard(seq);
+        std::lock_guard<std::mutex> shard_lk(shard.mutex);
+        shard.regions.erase(seq);
+      }
+      return;
+    }
+    // The water mark jumps too far, sweep the shards instead.
+    for (Shard& shard : shards_) {
+      std::lock_guard<std::mutex> shard_lk(shard.mutex);
+      for (auto it = shard.regions.begin(); it != shard.regions.end();) {
+        if (it->first < min_seq) {
+          it = shard.regions.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+
+  uint64_t GetMinSeq() const { return min_seq_.load(); }
+
+  // Return the number of seqs being tracked.
+  size_t Size() {
+    size_t size = 0;
+    for (Shard& shard : shards_) {
+      std::lock_guard<std::mutex> lk(shard.mutex);
+      size += shard.regions.size();
+    }
+    return size;
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> regions;
+  };
+
+  Shard& GetShard(uint64_t seq) { return shards_[seq % shards_.size()]; }
+
+ private:
+  static constexpr uint64_t kMaxReleaseStep = 1024;
+  std::vector<Shard> shards_;
+  uint64_t max_window_;
+  std::atomic<uint64_t> min_seq_;
+  std::mutex release_mutex_;
+};
+
+}  // namespace resdb
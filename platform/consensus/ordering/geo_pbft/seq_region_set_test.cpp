@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/geo_pbft/seq_region_set.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace resdb {
+namespace {
+
+TEST(SeqRegionSetTest, AddAndRelease) {
+  SeqRegionSet set(4);
+  EXPECT_EQ(set.Add(1, 1), SeqRegionSet::kAdded);
+  EXPECT_EQ(set.Add(1, 2), SeqRegionSet::kAdded);
+  EXPECT_EQ(set.Add(1, 1), SeqRegionSet::kExists);
+  EXPECT_EQ(set.Add(2, 1), SeqRegionSet::kAdded);
+  EXPECT_TRUE(set.Contains(1, 2));
+  EXPECT_EQ(set.Size(), 2);
+
+  set.Release(2);
+  EXPECT_EQ(set.GetMinSeq(), 2);
+  EXPECT_FALSE(set.Contains(1, 1));
+  EXPECT_EQ(set.Add(1, 3), SeqRegionSet::kExists);
+  EXPECT_TRUE(set.Contains(2, 1));
+  EXPECT_EQ(set.Size(), 1);
+
+  // Releasing an older seq is a no-op.
+  set.Release(1);
+  EXPECT_EQ(set.GetMinSeq(), 2);
+}
+
+TEST(SeqRegionSetTest, ReleaseLargeStep) {
+  SeqRegionSet set(2);
+  for (uint64_t seq = 1; seq <= 100; ++seq) {
+    EXPECT_EQ(set.Add(seq * 1000, 1), SeqRegionSet::kAdded);
+  }
+  set.Release(50001);
+  EXPECT_EQ(set.Size(), 50);
+  EXPECT_FALSE(set.Contains(50000, 1));
+  EXPECT_TRUE(set.Contains(51000, 1));
+}
+
+TEST(SeqRegionSetTest, AheadOfWindow) {
+  SeqRegionSet set(4, /*max_window=*/100);
+  EXPECT_EQ(set.Add(99, 1), SeqRegionSet::kAdded);
+  EXPECT_EQ(set.Add(100, 1), SeqRegionSet::kAhead);
+  EXPECT_EQ(set.Add(UINT64_MAX, 1), SeqRegionSet::kAhead);
+
+  // The window moves with the low water mark.
+  set.Release(50);
+  EXPECT_EQ(set.Add(149, 1), SeqRegionSet::kAdded);
+  EXPECT_EQ(set.Add(150, 1), SeqRegionSet::kAhead);
+  EXPECT_EQ(set.Size(), 2);
+}
+
+TEST(SeqRegionSetTest, ConcurrentAdd) {
+  SeqRegionSet set;
+  std::atomic<int> added = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (uint64_t seq = 1; seq <= 1000; ++seq) {
+        for (uint32_t region = 1; region <= 3; ++region) {
+          if (set.Add(seq, region) == SeqRegionSet::kAdded) {
+            added++;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(added, 3000);
+  set.Release(1001);
+  EXPECT_EQ(set.Size(), 0);
+}
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/adaptive_controller.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace resdb {
+
+AdaptiveController::AdaptiveController(uint32_t min_window,
+                                       uint32_t max_window,
+                                       uint32_t min_batch, uint32_t max_batch,
+                                       uint64_t target_latency_us,
+                                       uint32_t sample_num)
+    : min_window_(std::max(1u, std::min(min_window, max_window))),
+      max_window_(std::max(1u, max_window)),
+      min_batch_(std::max(1u, std::min(min_batch, max_batch))),
+      max_batch_(std::max(1u, max_batch)),
+      target_latency_us_(target_latency_us),
+      sample_num_(std::max(1u, sample_num)),
+      window_step_(std::max(1u, (max_window_ - min_window_) / 16)),
+      batch_step_(std::max(1u, (max_batch_ - min_batch_) / 16)),
+      window_(max_window_),
+      batch_size_(min_batch_),
+      queue_depth_(0) {}
+
+void AdaptiveController::AddLatency(uint64_t latency_us) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (min_latency_us_ == 0 || latency_us < min_latency_us_) {
+    min_latency_us_ = std::max<uint64_t>(latency_us, 1);
+  }
+  latency_sum_ += latency_us;
+  if (++latency_num_ < sample_num_) {
+    return;
+  }
+  Update(latency_sum_ / latency_num_);
+  latency_sum_ = 0;
+  latency_num_ = 0;
+}
+
+void AdaptiveController::SetQueueDepth(uint64_t depth) {
+  queue_depth_.store(depth, std::memory_order_relaxed);
+}
+
+uint32_t AdaptiveController::GetWindow() const {
+  return window_.load(std::memory_order_relaxed);
+}
+
+uint32_t AdaptiveController::GetBatchSize() const {
+  return batch_size_.load(std::memory_order_relaxed);
+}
+
+void AdaptiveController::Update(uint64_t avg_latency_us) {
+  uint64_t target_latency_us =
+      target_latency_us_ > 0 ? target_latency_us_ : min_latency_us_ * 2;
+
+  uint32_t window = window_.load(std::memory_order_relaxed);
+  uint32_t batch_size = batch_size_.load(std::memory_order_relaxed);
+  bool backlog = queue_depth_.load(std::memory_order_relaxed) > batch_size;
+  if (avg_latency_us > target_latency_us) {
+    window = std::max(min_window_, window / 2);
+    if (!backlog) {
+      batch_size = std::max(min_batch_, batch_size / 2);
+    }
+  } else {
+    window = std::min(max_window_, window + window_step_);
+    if (backlog) {
+      batch_size = std::min(max_batch_, batch_size + batch_step_);
+    }
+  }
+  window_.store(window, std::memory_order_relaxed);
+  batch_size_.store(batch_size, std::memory_order_relaxed);
+  LOG(INFO) << "avg latency:" << avg_latency_us
+            << " target:" << target_latency_us << " window:" << window
+            << " batch size:" << batch_size;
+}
+
+}  // namespace resdb
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace resdb {
+
+// AdaptiveController tunes the number of sequences in flight and the client
+// batch size with AIMD, within [min, max] bounds.
+// Every `sample_num` commit latencies it compares the average latency with
+// the target: below the target the window grows by a fixed step, above it
+// the window is halved. The batch size grows while the queue has a backlog
+// of more than one batch and is halved when latency is high without one.
+// The window starts at max and the batch size at min, so batches only grow
+// once a backlog shows up.
+// If target_latency_us is 0, twice the lowest latency observed is used.
+class AdaptiveController {
+ public:
+  AdaptiveController(uint32_t min_window, uint32_t max_window,
+                     uint32_t min_batch, uint32_t max_batch,
+                     uint64_t target_latency_us, uint32_t sample_num = 64);
+
+  // Record the latency of a committed sequence.
+  void AddLatency(uint64_t latency_us);
+
+  // Record the number of requests waiting to be batched.
+  void SetQueueDepth(uint64_t depth);
+
+  uint32_t GetWindow() const;
+  uint32_t GetBatchSize() const;
+
+ private:
+  // Called with mutex_ held.
+  void Update(uint64_t avg_latency_us);
+
+ private:
+  const uint32_t min_window_, max_window_;
+  const uint32_t min_batch_, max_batch_;
+  const uint64_t target_latency_us_;
+  const uint32_t sample_num_;
+  const uint32_t window_step_, batch_step_;
+
+  std::atomic<uint32_t> window_, batch_size_;
+  std::atomic<uint64_t> queue_depth_;
+
+  std::mutex mutex_;
+  uint64_t latency_sum_ = 0;
+  uint32_t latency_num_ = 0;
+  uint64_t min_latency_us_ = 0;
+};
+
+}  // namespace resdb
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/adaptive_controller.h"
+
+#include <gtest/gtest.h>
+
+namespace resdb {
+namespace {
+
+void AddLatency(AdaptiveController* controller, uint64_t latency_us,
+                int num) {
+  for (int i = 0; i < num; ++i) {
+    controller->AddLatency(latency_us);
+  }
+}
+
+TEST(AdaptiveControllerTest, StartBounds) {
+  AdaptiveController controller(8, 64, 10, 100, 1000, 4);
+  EXPECT_EQ(controller.GetWindow(), 64);
+  EXPECT_EQ(controller.GetBatchSize(), 10);
+}
+
+TEST(AdaptiveControllerTest, DecreaseOnHighLatency) {
+  AdaptiveController controller(8, 64, 10, 100, 1000, 4);
+  AddLatency(&controller, 2000, 4);
+  EXPECT_EQ(controller.GetWindow(), 32);
+  EXPECT_EQ(controller.GetBatchSize(), 10);
+
+  AddLatency(&controller, 2000, 12);
+  EXPECT_EQ(controller.GetWindow(), 8);
+  EXPECT_EQ(controller.GetBatchSize(), 10);
+
+  // Not updated until 4 samples are received.
+  AddLatency(&controller, 100, 3);
+  EXPECT_EQ(controller.GetWindow(), 8);
+  // (64 - 8) / 16 = 3 per update.
+  AddLatency(&controller, 100, 1);
+  EXPECT_EQ(controller.GetWindow(), 11);
+  EXPECT_EQ(controller.GetBatchSize(), 10);
+
+  AddLatency(&controller, 100, 4 * 100);
+  EXPECT_EQ(controller.GetWindow(), 64);
+}
+
+TEST(AdaptiveControllerTest, GrowBatchWithBacklog) {
+  AdaptiveController controller(8, 64, 10, 100, 1000, 4);
+  // Low latency without a backlog keeps the batch size.
+  AddLatency(&controller, 100, 4);
+  EXPECT_EQ(controller.GetBatchSize(), 10);
+
+  // (100 - 10) / 16 = 5 per update.
+  controller.SetQueueDepth(1000);
+  AddLatency(&controller, 100, 8);
+  EXPECT_EQ(controller.GetBatchSize(), 20);
+
+  // High latency with a backlog keeps the batch size.
+  AddLatency(&controller, 2000, 4);
+  EXPECT_EQ(controller.GetBatchSize(), 20);
+
+  AddLatency(&controller, 100, 4 * 100);
+  EXPECT_EQ(controller.GetBatchSize(), 100);
+
+  controller.SetQueueDepth(0);
+  AddLatency(&controller, 2000, 4);
+  EXPECT_EQ(controller.GetBatchSize(), 50);
+}
+
+TEST(AdaptiveControllerTest, TargetFromMinLatency) {
+  AdaptiveController controller(1, 16, 1, 16, 0, 2);
+  AddLatency(&controller, 100, 2);
+  EXPECT_EQ(controller.GetWindow(), 16);
+
+  AddLatency(&controller, 300, 2);
+  EXPECT_EQ(controller.GetWindow(), 8);
+
+  AddLatency(&controller, 150, 2);
+  EXPECT_EQ(controller.GetWindow(), 9);
+}
+
+}  // namespace
+}  // namespace resdb
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/checkpoint_digest.h"
+
+#include "common/crypto/signature_verifier.h"
+
+namespace resdb {
+
+CheckPointDigest::CheckPointDigest(const std::string& digest)
+    : digest_(digest) {}
+
+const std::string& CheckPointDigest::HashPair(const std::string& left,
+                                              const std::string& right) {
+  buffer_.assign(left);
+  buffer_.append(right);
+  result_ = SignatureVerifier::CalculateHash(buffer_);
+  return result_;
+}
+
+void CheckPointDigest::Add(const std::string& hash) {
+  frontier_.push_back({hash, 0});
+  while (frontier_.size() > 1 &&
+         frontier_[frontier_.size() - 2].height == frontier_.back().height) {
+    SubTree right = std::move(frontier_.back());
+    frontier_.pop_back();
+    SubTree& left = frontier_.back();
+    left.root = HashPair(left.root, right.root);
+    left.height++;
+  }
+  pending_num_++;
+}
+
+const std::string& CheckPointDigest::Seal() {
+  std::string root;
+  for (auto it = frontier_.rbegin(); it != frontier_.rend(); ++it) {
+    root = it == frontier_.rbegin() ? it->root : HashPair(it->root, root);
+  }
+  digest_ = HashPair(digest_, root);
+  frontier_.clear();
+  pending_num_ = 0;
+  return digest_;
+}
+
+const std::string& CheckPointDigest::GetDigest() const { return digest_; }
+
+uint64_t CheckPointDigest::GetPendingNum() const { return pending_num_; }
+
+}  // namespace resdb
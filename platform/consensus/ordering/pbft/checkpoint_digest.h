@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace resdb {
+
+// CheckPointDigest computes the checkpoint hash incrementally. The request
+// hashes between two checkpoints are the leaves of a Merkle tree whose
+// complete subtrees are merged as soon as they are formed, so adding a hash
+// costs amortized one SHA256 over two digests. Seal() folds the remaining
+// subtrees into the root of the interval and chains it with the previous
+// checkpoint digest.
+//
+// The object is copyable so that a replica can replay the requests fetched
+// from others on top of a snapshot of its own state.
+class CheckPointDigest {
+ public:
+  CheckPointDigest() = default;
+  // Start from the digest of a sealed interval.
+  explicit CheckPointDigest(const std::string& digest);
+
+  void Add(const std::string& hash);
+
+  // Close the current interval and return the new checkpoint digest.
+  const std::string& Seal();
+
+  // The digest of the last sealed interval.
+  const std::string& GetDigest() const;
+
+  // The number of hashes added since the last Seal().
+  uint64_t GetPendingNum() const;
+
+ private:
+  const std::string& HashPair(const std::string& left,
+                              const std::string& right);
+
+ private:
+  struct SubTree {
+    std::string root;
+    int height;
+  };
+  // The roots of the complete subtrees, the heights are decreasing.
+  std::vector<SubTree> frontier_;
+  std::string digest_;
+  uint64_t pending_num_ = 0;
+  std::string buffer_, result_;
+};
+
+}  // namespace resdb
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/checkpoint_digest.h"
+
+#include <gtest/gtest.h>
+
+#include "common/crypto/signature_verifier.h"
+
+namespace resdb {
+namespace {
+
+std::string Hash(const std::string& data) {
+  return SignatureVerifier::CalculateHash(data);
+}
+
+TEST(CheckPointDigestTest, MerkleRoot) {
+  CheckPointDigest digest;
+  digest.Add("a");
+  digest.Add("b");
+  digest.Add("c");
+  EXPECT_EQ(digest.GetPendingNum(), 3);
+
+  std::string root = Hash(Hash("ab") + "c");
+  EXPECT_EQ(digest.Seal(), Hash(root));
+  EXPECT_EQ(digest.GetPendingNum(), 0);
+
+  digest.Add("d");
+  EXPECT_EQ(digest.Seal(), Hash(Hash(root) + "d"));
+}
+
+TEST(CheckPointDigestTest, ReplayFromCopy) {
+  CheckPointDigest digest;
+  for (int i = 0; i < 7; ++i) {
+    digest.Add(Hash(std::to_string(i)));
+  }
+
+  CheckPointDigest replay = digest;
+  for (int i = 7; i < 13; ++i) {
+    digest.Add(Hash(std::to_string(i)));
+    replay.Add(Hash(std::to_string(i)));
+  }
+  EXPECT_EQ(digest.Seal(), replay.Seal());
+
+  CheckPointDigest other;
+  for (int i = 0; i < 13; ++i) {
+    other.Add(Hash(std::to_string(i == 5 ? 100 : i)));
+  }
+  EXPECT_NE(other.Seal(), digest.GetDigest());
+}
+
+}  // namespace
+}  // namespace resdb
@@ -27,6 +27,7 @@
 
 #include <glog/logging.h>
 
+#include "chain/state/state_merkle_tree.h"
 #include "platform/consensus/ordering/pbft/transaction_utils.h"
 #include "platform/proto/checkpoint_info.pb.h"
 
@@ -40,7 +41,9 @@ CheckPointManager::CheckPointManager(const ResDBConfig& config,
       txn_db_(std::make_unique<TxnMemoryDB>()),
       verifier_(verifier),
       stop_(false),
-      txn_accessor_(config),
+      data_queue_("checkpoint_data"),
+      stable_hash_queue_("stable_hash"),
+      txn_accessor_(std::make_unique<ResDBTxnAccessor>(config)),
       highest_prepared_seq_(0) {
   current_stable_seq_ = 0;
   if (config_.GetConfigData().enable_viewchange()) {
@@ -67,8 +70,42 @@ void CheckPointManager::Stop() {
   }
 }
 
-std::string GetHash(const std::string& h1, const std::string& h2) {
-  return SignatureVerifier::CalculateHash(h1 + h2);
+namespace {
+
+// A replica at least this many checkpoint intervals behind fetches the state
+// instead of the requests.
+constexpr uint64_t kStateSyncIntervals = 16;
+
+// The checkpoint hash covers the state digest if the state has one.
+std::string GetCheckPointHash(const std::string& txn_digest,
+                              const std::string& state_digest) {
+  if (state_digest.empty()) {
+    return txn_digest;
+  }
+  return SignatureVerifier::CalculateHash(txn_digest + state_digest);
+}
+
+bool VerifyStateChunk(const std::string& state_digest,
+                      const StateChunk& state_chunk) {
+  if (state_chunk.keys_size() != state_chunk.values_size()) {
+    return false;
+  }
+  StateMerkleTree::Chunk chunk;
+  chunk.index = state_chunk.index();
+  for (int i = 0; i < state_chunk.keys_size(); ++i) {
+    chunk.kvs.push_back(
+        std::make_pair(state_chunk.keys(i), state_chunk.values(i)));
+  }
+  chunk.proof.assign(state_chunk.proof().begin(), state_chunk.proof().end());
+  return StateMerkleTree::VerifyChunk(state_digest, state_chunk.chunk_num(),
+                                      chunk);
+}
+
+}  // namespace
+
+void CheckPointManager::SetTxnAccessor(
+    std::unique_ptr<ResDBTxnAccessor> txn_accessor) {
+  txn_accessor_ = std::move(txn_accessor);
 }
 
 TxnMemoryDB* CheckPointManager::GetTxnDB() { return txn_db_.get(); }
@@ -104,6 +141,11 @@ bool CheckPointManager::IsValidCheckpointProof(
     }
     senders.insert(signature.node_id());
   }
+  if (!stable_ckpt.state_digest().empty() &&
+      stable_ckpt.hash() != GetCheckPointHash(stable_ckpt.txn_digest(),
+                                              stable_ckpt.state_digest())) {
+    return false;
+  }
 
   return (senders.size() >= config_.GetMinDataReceiveNum()) ||
          (stable_ckpt.seq() == 0 && senders.size() == 0);
@@ -118,11 +160,19 @@ int CheckPointManager::ProcessCheckPoint(std::unique_ptr<Context> context,
   }
   uint64_t checkpoint_seq = checkpoint_data.seq();
   uint32_t sender_id = request->sender_id();
-  int water_mark = config_.GetCheckPointWaterMark();
-  if (checkpoint_seq % water_mark) {
+  int interval = config_.GetCheckPointInterval();
+  if (checkpoint_seq % interval) {
     LOG(ERROR) << "checkpoint seq not invalid:" << checkpoint_seq;
     return -2;
   }
+  if (!checkpoint_data.state_digest().empty() &&
+      checkpoint_data.hash() !=
+          GetCheckPointHash(checkpoint_data.txn_digest(),
+                            checkpoint_data.state_digest())) {
+    LOG(ERROR) << "checkpoint hash does not match the digests:"
+               << checkpoint_seq;
+    return -2;
+  }
 
   if (verifier_) {
     // check signatures
@@ -151,6 +201,11 @@ int CheckPointManager::ProcessCheckPoint(std::unique_ptr<Context> context,
         hash_ckpt_[std::make_pair(checkpoint_seq, checkpoint_data.hash())]
             .push_back(hash_);
       }
+      if (!checkpoint_data.state_digest().empty()) {
+        digest_ckpt_[std::make_pair(checkpoint_seq, checkpoint_data.hash())] =
+            std::make_pair(checkpoint_data.txn_digest(),
+                           checkpoint_data.state_digest());
+      }
     }
     Notify();
   }
@@ -171,13 +226,17 @@ bool CheckPointManager::Wait() {
 
 void CheckPointManager::UpdateStableCheckPointStatus() {
   uint64_t last_committable_seq = 0;
-  int water_mark = config_.GetCheckPointWaterMark();
   while (!stop_) {
     if (!Wait()) {
       continue;
     }
     uint64_t stable_seq = 0;
     std::string stable_hash;
+    // The latest committable checkpoint ahead of this replica. Catching up
+    // to it goes over the network, so it runs after releasing mutex_.
+    uint64_t sync_seq = 0;
+    std::set<uint32_t> sync_senders;
+    std::string sync_txn_digest, sync_state_digest;
     {
       std::lock_guard<std::mutex> lk(mutex_);
       for (auto it : sender_ckpt_) {
@@ -185,58 +244,17 @@ void CheckPointManager::UpdateStableCheckPointStatus() {
             static_cast<size_t>(config_.GetMinCheckpointReceiveNum())) {
           committable_seq_ = it.first.first;
           committable_hash_ = it.first.second;
-          std::set<uint32_t> senders_ =
-              sender_ckpt_[std::make_pair(committable_seq_, committable_hash_)];
           sem_post(&committable_seq_signal_);
           if (last_seq_ < committable_seq_ &&
               last_committable_seq < committable_seq_) {
-            auto replicas_ = config_.GetReplicaInfos();
-            for (auto& replica_ : replicas_) {
-              std::string last_hash;
-              uint64_t last_seq;
-              {
-                std::lock_guard<std::mutex> lk(lt_mutex_);
-                last_hash = last_hash_;
-                // last_seq_ = last_seq > last_committable_seq ? last_seq :
-                // last_committable_seq;
-                last_seq = last_seq_;
-              }
-              if (senders_.count(replica_.id()) &&
-                  last_seq < committable_seq_) {
-                // LOG(ERROR) << "GetRequestFromReplica " << last_seq_ + 1 << "
-                // " << committable_seq_;
-                auto requests = txn_accessor_.GetRequestFromReplica(
-                    last_seq + 1, committable_seq_, replica_);
-                if (requests.ok()) {
-                  bool fail = false;
-                  for (auto& request : *requests) {
-                    if (SignatureVerifier::CalculateHash(request.data()) !=
-                        request.hash()) {
-                      LOG(ERROR)
-                          << "The hash of the request does not match the data.";
-                      fail = true;
-                      break;
-                    }
-                    last_hash = GetHash(last_hash, request.hash());
-                  }
-                  if (fail) {
-                    continue;
-                  } else if (last_hash != committable_hash_) {
-                    LOG(ERROR) << "The hash of requests returned do not match. "
-                               << last_seq + 1 << " " << committable_seq_;
-                  } else {
-                    last_committable_seq = committable_seq_;
-                    for (auto& request : *requests) {
-                      if (executor_) {
-                        executor_->Commit(std::make_unique<Request>(request));
-                      }
-                    }
-                    SetHighestPreparedSeq(committable_seq_);
-                    // LOG(ERROR) << "[4]";
-                    break;
-                  }
-                }
-              }
+            sync_seq = committable_seq_;
+            sync_senders = it.second;
+            sync_txn_digest = committable_hash_;
+            sync_state_digest.clear();
+            auto digest_it = digest_ckpt_.find(it.first);
+            if (digest_it != digest_ckpt_.end()) {
+              sync_txn_digest = digest_it->second.first;
+              sync_state_digest = digest_it->second.second;
             }
           }
         }
@@ -248,20 +266,29 @@ void CheckPointManager::UpdateStableCheckPointStatus() {
       }
       new_data_ = 0;
     }
+    if (sync_seq > 0 &&
+        CatchUp(sync_seq, sync_senders, sync_txn_digest, sync_state_digest)) {
+      last_committable_seq = sync_seq;
+      SetHighestPreparedSeq(sync_seq);
+    }
 
     // LOG(ERROR) << "current stable seq:" << current_stable_seq_
     //  << " stable seq:" << stable_seq;
     std::vector<SignatureInfo> votes;
-    if (current_stable_seq_ < stable_seq) {
+    bool is_new_stable = current_stable_seq_ < stable_seq;
+    if (is_new_stable) {
       std::lock_guard<std::mutex> lk(mutex_);
       votes = sign_ckpt_[std::make_pair(stable_seq, stable_hash)];
       std::set<uint32_t> senders_ =
           sender_ckpt_[std::make_pair(stable_seq, stable_hash)];
+      std::pair<std::string, std::string> digests =
+          digest_ckpt_[std::make_pair(stable_seq, stable_hash)];
 
       auto it = sender_ckpt_.begin();
       while (it != sender_ckpt_.end()) {
         if (it->first.first <= stable_seq) {
           sign_ckpt_.erase(sign_ckpt_.find(it->first));
+          digest_ckpt_.erase(it->first);
           auto tmp = it++;
           sender_ckpt_.erase(tmp);
         } else {
@@ -270,6 +297,8 @@ void CheckPointManager::UpdateStableCheckPointStatus() {
       }
       stable_ckpt_.set_seq(stable_seq);
       stable_ckpt_.set_hash(stable_hash);
+      stable_ckpt_.set_txn_digest(digests.first);
+      stable_ckpt_.set_state_digest(digests.second);
       stable_ckpt_.mutable_signatures()->Clear();
       for (auto vote : votes) {
         *stable_ckpt_.add_signatures() = vote;
@@ -279,6 +308,9 @@ void CheckPointManager::UpdateStableCheckPointStatus() {
       //           << " votes:" << stable_ckpt_.DebugString();
       // LOG(INFO) << "done. stable seq:" << current_stable_seq_;
     }
+    if (is_new_stable && stable_checkpoint_handler_) {
+      stable_checkpoint_handler_(stable_seq);
+    }
     UpdateStableCheckPointCallback(current_stable_seq_);
   }
 }
@@ -288,6 +320,11 @@ void CheckPointManager::SetTimeoutHandler(
   timeout_handler_ = timeout_handler;
 }
 
+void CheckPointManager::SetStableCheckPointHandler(
+    std::function<void(uint64_t)> stable_checkpoint_handler) {
+  stable_checkpoint_handler_ = stable_checkpoint_handler;
+}
+
 void CheckPointManager::TimeoutHandler() {
   if (timeout_handler_) {
     timeout_handler_();
@@ -295,8 +332,7 @@ void CheckPointManager::TimeoutHandler() {
 }
 
 void CheckPointManager::UpdateCheckPointStatus() {
-  uint64_t last_ckpt_seq = 0;
-  int water_mark = config_.GetCheckPointWaterMark();
+  int interval = config_.GetCheckPointInterval();
   int timeout_ms = config_.GetViewchangeCommitTimeout();
   std::vector<std::string> stable_hashs;
   std::vector<uint64_t> stable_seqs;
@@ -314,30 +350,40 @@ void CheckPointManager::UpdateCheckPointStatus() {
       LOG(ERROR) << "seq invalid:" << last_seq_ << " current:" << current_seq;
       continue;
     }
+    std::string txn_digest, state_digest = request->state_digest();
     {
       std::lock_guard<std::mutex> lk(lt_mutex_);
-      last_hash_ = GetHash(last_hash_, request->hash());
+      digest_.Add(request->hash());
       last_seq_++;
+      if (current_seq % interval == 0) {
+        txn_digest = digest_.Seal();
+      }
     }
     txn_db_->Put(std::move(request));
 
-    if (current_seq == last_ckpt_seq + water_mark) {
-      last_ckpt_seq = current_seq;
-      BroadcastCheckPoint(last_ckpt_seq, last_hash_, stable_hashs, stable_seqs);
+    if (current_seq % interval == 0) {
+      BroadcastCheckPoint(current_seq, txn_digest, state_digest, stable_hashs,
+                          stable_seqs);
     }
   }
   return;
 }
 
 void CheckPointManager::BroadcastCheckPoint(
-    uint64_t seq, const std::string& hash,
+    uint64_t seq, const std::string& txn_digest,
+    const std::string& state_digest,
     const std::vector<std::string>& stable_hashs,
     const std::vector<uint64_t>& stable_seqs) {
   CheckPointData checkpoint_data;
   std::unique_ptr<Request> checkpoint_request = NewRequest(
       Request::TYPE_CHECKPOINT, Request(), config_.GetSelfInfo().id());
+  std::string hash = GetCheckPointHash(txn_digest, state_digest);
   checkpoint_data.set_seq(seq);
   checkpoint_data.set_hash(hash);
+  if (!state_digest.empty()) {
+    checkpoint_data.set_txn_digest(txn_digest);
+    checkpoint_data.set_state_digest(state_digest);
+  }
   if (verifier_) {
     auto signature_or = verifier_->SignMessage(hash);
     if (!signature_or.ok()) {
@@ -351,6 +397,111 @@ void CheckPointManager::BroadcastCheckPoint(
   replica_communicator_->BroadCast(*checkpoint_request);
 }
 
+bool CheckPointManager::CatchUp(uint64_t committable_seq,
+                                const std::set<uint32_t>& senders,
+                                const std::string& txn_digest,
+                                const std::string& state_digest) {
+  int interval = config_.GetCheckPointInterval();
+  for (auto& replica : config_.GetReplicaInfos()) {
+    CheckPointDigest digest;
+    uint64_t last_seq;
+    {
+      std::lock_guard<std::mutex> lk(lt_mutex_);
+      digest = digest_;
+      last_seq = last_seq_;
+    }
+    if (last_seq >= committable_seq) {
+      return false;
+    }
+    if (!senders.count(replica.id())) {
+      continue;
+    }
+    // Fetch the state instead of the requests if it is far behind.
+    if (!state_digest.empty() && executor_ &&
+        committable_seq - last_seq >= kStateSyncIntervals * interval) {
+      if (SyncState(replica, committable_seq, txn_digest, state_digest) == 0) {
+        return true;
+      }
+    }
+    auto requests = txn_accessor_->GetRequestFromReplica(
+        last_seq + 1, committable_seq, replica);
+    if (!requests.ok()) {
+      continue;
+    }
+    bool fail = false;
+    uint64_t seq = last_seq;
+    for (auto& request : *requests) {
+      if (SignatureVerifier::CalculateHash(request.data()) != request.hash()) {
+        LOG(ERROR) << "The hash of the request does not match the data.";
+        fail = true;
+        break;
+      }
+      // Only the data is covered by the hash, so a state query returned by
+      // a faulty replica would pass the digest check.
+      if (request.type() == Request::TYPE_STATE_QUERY) {
+        LOG(ERROR) << "The request replayed is a state query.";
+        fail = true;
+        break;
+      }
+      digest.Add(request.hash());
+      if (++seq % interval == 0) {
+        digest.Seal();
+      }
+    }
+    if (fail) {
+      continue;
+    }
+    if (seq != committable_seq || digest.GetDigest() != txn_digest) {
+      LOG(ERROR) << "The hash of requests returned do not match. "
+                 << last_seq + 1 << " " << committable_seq;
+      continue;
+    }
+    for (auto& request : *requests) {
+      if (executor_) {
+        executor_->Commit(std::make_unique<Request>(request));
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+int CheckPointManager::SyncState(const ReplicaInfo& replica, uint64_t seq,
+                                 const std::string& txn_digest,
+                                 const std::string& state_digest) {
+  std::vector<StateChunk> chunks;
+  uint32_t chunk_num = 1;
+  for (uint32_t i = 0; i < chunk_num; ++i) {
+    auto chunk = txn_accessor_->GetStateChunkFromReplica(seq, i, replica);
+    if (!chunk.ok()) {
+      LOG(ERROR) << "get state chunk " << i << " at seq:" << seq
+                 << " from replica:" << replica.id()
+                 << " fail:" << chunk.status();
+      return -1;
+    }
+    if ((i > 0 && chunk->chunk_num() != chunk_num) ||
+        !VerifyStateChunk(state_digest, *chunk)) {
+      LOG(ERROR) << "state chunk " << i << " at seq:" << seq
+                 << " from replica:" << replica.id() << " is not valid";
+      return -1;
+    }
+    chunk_num = chunk->chunk_num();
+    chunks.push_back(std::move(*chunk));
+  }
+  std::lock_guard<std::mutex> lk(lt_mutex_);
+  // The requests up to seq may have been committed during the download.
+  if (last_seq_ >= seq) {
+    LOG(INFO) << "skip the state at seq:" << seq
+              << " already reached:" << last_seq_;
+    return 0;
+  }
+  LOG(INFO) << "install state at seq:" << seq << " chunks:" << chunk_num;
+  executor_->InstallState(seq, std::move(chunks));
+  digest_ = CheckPointDigest(txn_digest);
+  last_seq_ = seq;
+  return 0;
+}
+
 void CheckPointManager::WaitSignal() {
   std::unique_lock<std::mutex> lk(mutex_);
   signal_.wait(lk, [&] { return !stable_hash_queue_.Empty(); });
@@ -33,6 +33,7 @@
 #include "platform/config/resdb_config.h"
 #include "platform/consensus/checkpoint/checkpoint.h"
 #include "platform/consensus/execution/transaction_executor.h"
+#include "platform/consensus/ordering/pbft/checkpoint_digest.h"
 #include "platform/networkstrate/replica_communicator.h"
 #include "platform/networkstrate/server_comm.h"
 #include "platform/proto/checkpoint_info.pb.h"
@@ -59,6 +60,9 @@ class CheckPointManager : public CheckPoint {
   bool IsValidCheckpointProof(const StableCheckPoint& stable_ckpt);
 
   void SetTimeoutHandler(std::function<void()> timeout_handler);
+  // The handler is called with the seq of each new stable checkpoint.
+  void SetStableCheckPointHandler(
+      std::function<void(uint64_t)> stable_checkpoint_handler);
   virtual void UpdateStableCheckPointCallback(
       int64_t current_stable_checkpoint) {}
 
@@ -71,6 +75,10 @@ class CheckPointManager : public CheckPoint {
 
   void SetExecutor(TransactionExecutor* executor) { executor_ = executor; }
 
+  // Replace the accessor fetching the requests and the state from the other
+  // replicas. It must be called before any checkpoint is processed.
+  void SetTxnAccessor(std::unique_ptr<ResDBTxnAccessor> txn_accessor);
+
   uint64_t GetHighestPreparedSeq();
 
   void SetHighestPreparedSeq(uint64_t seq);
@@ -82,10 +90,23 @@ class CheckPointManager : public CheckPoint {
  private:
   void UpdateCheckPointStatus();
   void UpdateStableCheckPointStatus();
-  void BroadcastCheckPoint(uint64_t seq, const std::string& hash,
+  void BroadcastCheckPoint(uint64_t seq, const std::string& txn_digest,
+                           const std::string& state_digest,
                            const std::vector<std::string>& stable_hashs,
                            const std::vector<uint64_t>& stable_seqs);
 
+  // Bring this replica to the committable checkpoint by fetching the state
+  // or the requests from one of its senders. Return true if it succeeds.
+  // It goes over the network, so it must not be called under mutex_.
+  bool CatchUp(uint64_t committable_seq, const std::set<uint32_t>& senders,
+               const std::string& txn_digest, const std::string& state_digest);
+
+  // Download the state at the checkpoint seq from the replica, verify each
+  // chunk against the state digest and install it in the executor, unless
+  // the requests up to seq have been committed during the download.
+  int SyncState(const ReplicaInfo& replica, uint64_t seq,
+                const std::string& txn_digest, const std::string& state_digest);
+
   void Notify();
   bool Wait();
 
@@ -101,23 +122,29 @@ class CheckPointManager : public CheckPoint {
       sign_ckpt_;
   std::map<std::pair<uint64_t, std::string>, std::vector<std::string>>
       hash_ckpt_;
+  // The transaction digest and the state digest of each checkpoint hash.
+  std::map<std::pair<uint64_t, std::string>,
+           std::pair<std::string, std::string>>
+      digest_ckpt_;
   std::atomic<uint64_t> current_stable_seq_;
   std::mutex mutex_;
   LockFreeQueue<Request> data_queue_;
   std::mutex cv_mutex_;
   std::condition_variable cv_;
   std::function<void()> timeout_handler_;
+  std::function<void(uint64_t)> stable_checkpoint_handler_;
   StableCheckPoint stable_ckpt_;
   int new_data_ = 0;
   LockFreeQueue<std::pair<uint64_t, std::string>> stable_hash_queue_;
   std::condition_variable signal_;
-  ResDBTxnAccessor txn_accessor_;
+  std::unique_ptr<ResDBTxnAccessor> txn_accessor_;
   std::mutex lt_mutex_;
   uint64_t last_seq_ = 0;
   TransactionExecutor* executor_;
   std::atomic<uint64_t> highest_prepared_seq_;
   uint64_t committable_seq_ = 0;
-  std::string last_hash_, committable_hash_;
+  CheckPointDigest digest_;
+  std::string committable_hash_;
   sem_t committable_seq_signal_;
 };
 
@@ -31,9 +31,13 @@
 
 #include <future>
 
+#include "chain/state/state_merkle_tree.h"
 #include "common/crypto/mock_signature_verifier.h"
 #include "common/test/test_macros.h"
+#include "executor/common/mock_transaction_manager.h"
+#include "interface/common/mock_resdb_txn_accessor.h"
 #include "platform/config/resdb_config_utils.h"
+#include "platform/consensus/ordering/pbft/checkpoint_digest.h"
 #include "platform/consensus/ordering/pbft/transaction_utils.h"
 #include "platform/networkstrate/mock_replica_communicator.h"
 #include "platform/proto/checkpoint_info.pb.h"
@@ -103,6 +107,7 @@ class CheckPointManagerTest : public Test {
         config_(GetConfigData(), GenerateReplicaInfo(1, "127.0.0.1", 1234),
                 KeyInfo(), CertificateInfo()) {
     config_.EnableCheckPoint(true);
+    config_.SetCheckPointInterval(5);
   }
 
  protected:
@@ -130,6 +135,36 @@ TEST_F(CheckPointManagerTest, SendCheckPoint) {
   LOG(ERROR) << "done";
 }
 
+TEST_F(CheckPointManagerTest, SendCheckPointWithStateDigest) {
+  CheckPointManager manager(config_, &replica_communicator_, nullptr);
+
+  for (int i = 1; i <= 5; ++i) {
+    std::unique_ptr<Request> request = std::make_unique<Request>();
+    request->set_seq(i);
+    if (i == 5) {
+      request->set_state_digest("state");
+    }
+    manager.AddCommitData(std::move(request));
+  }
+
+  std::promise<bool> propose_done;
+  std::future<bool> propose_done_future = propose_done.get_future();
+  EXPECT_CALL(replica_communicator_, BroadCast)
+      .WillOnce(Invoke([&](const google::protobuf::Message& message) {
+        Request request;
+        request.CopyFrom(message);
+        CheckPointData checkpoint_data;
+        EXPECT_TRUE(checkpoint_data.ParseFromString(request.data()));
+        EXPECT_EQ(checkpoint_data.seq(), 5);
+        EXPECT_EQ(checkpoint_data.state_digest(), "state");
+        EXPECT_EQ(checkpoint_data.hash(),
+                  SignatureVerifier::CalculateHash(
+                      checkpoint_data.txn_digest() + "state"));
+        propose_done.set_value(true);
+      }));
+  propose_done_future.get();
+}
+
 TEST_F(CheckPointManagerTest, SendCheckPointOnce) {
   std::promise<bool> propose_done;
   std::future<bool> propose_done_future = propose_done.get_future();
@@ -289,6 +324,204 @@ TEST_F(CheckPointManagerTest, Votes) {
   EXPECT_EQ(ckpt.signatures_size(), 3);
 }
 
+// Split the key-values into the chunks of a state at seq and return the
+// state digest.
+std::string GenerateStateChunks(
+    uint64_t seq, const std::map<std::string, std::string>& kvs,
+    std::vector<StateChunk>* chunks) {
+  StateMerkleTree tree(/*depth=*/2);
+  for (const auto& kv : kvs) {
+    tree.Update(kv.first, kv.second);
+  }
+  std::vector<std::string> nodes = tree.GetNodes();
+  for (uint32_t i = 0; i < tree.GetLeafNum(); ++i) {
+    StateChunk chunk;
+    chunk.set_seq(seq);
+    chunk.set_index(i);
+    chunk.set_chunk_num(tree.GetLeafNum());
+    for (const std::string& key : tree.GetKeys(i)) {
+      chunk.add_keys(key);
+      chunk.add_values(kvs.at(key));
+    }
+    for (const std::string& hash : StateMerkleTree::GetProof(nodes, i)) {
+      chunk.add_proof(hash);
+    }
+    chunks->push_back(chunk);
+  }
+  return tree.GetRoot();
+}
+
+std::unique_ptr<Request> GenerateCheckPoint(uint32_t sender_id, uint64_t seq,
+                                            const std::string& txn_digest,
+                                            const std::string& state_digest) {
+  std::unique_ptr<Request> checkpoint_request =
+      NewRequest(Request::TYPE_CHECKPOINT, Request(), sender_id);
+  CheckPointData checkpoint_data;
+  checkpoint_data.set_seq(seq);
+  if (state_digest.empty()) {
+    checkpoint_data.set_hash(txn_digest);
+  } else {
+    checkpoint_data.set_hash(
+        SignatureVerifier::CalculateHash(txn_digest + state_digest));
+    checkpoint_data.set_txn_digest(txn_digest);
+    checkpoint_data.set_state_digest(state_digest);
+  }
+  checkpoint_data.SerializeToString(checkpoint_request->mutable_data());
+  return checkpoint_request;
+}
+
+TEST_F(CheckPointManagerTest, SyncState) {
+  SystemInfo system_info(config_);
+  std::vector<StateChunk> chunks;
+  std::string state_digest = GenerateStateChunks(
+      80, {{"key1", "value1"}, {"key2", "value2"}}, &chunks);
+
+  std::promise<bool> done;
+  std::future<bool> done_future = done.get_future();
+  size_t applied = 0;
+  auto transaction_manager = std::make_unique<MockTransactionManager>();
+  EXPECT_CALL(*transaction_manager, ApplyStateChunk)
+      .Times(chunks.size())
+      .WillRepeatedly(Invoke([&](const StateChunk& chunk) {
+        EXPECT_THAT(chunk, EqualsProto(chunks[applied]));
+        if (++applied == chunks.size()) {
+          done.set_value(true);
+        }
+        return 0;
+      }));
+  TransactionExecutor executor(
+      config_,
+      [](std::unique_ptr<Request>, std::unique_ptr<BatchUserResponse>) {},
+      &system_info, std::move(transaction_manager));
+
+  auto txn_accessor = std::make_unique<MockResDBTxnAccessor>(config_);
+  EXPECT_CALL(*txn_accessor, GetStateChunkFromReplica(80, _, _))
+      .WillRepeatedly(Invoke([&](uint64_t, uint32_t index, const ReplicaInfo&)
+                                 -> absl::StatusOr<StateChunk> {
+        return chunks[index];
+      }));
+  EXPECT_CALL(*txn_accessor, GetRequestFromReplica).Times(0);
+
+  CheckPointManager manager(config_, &replica_communicator_, nullptr);
+  manager.SetExecutor(&executor);
+  manager.SetTxnAccessor(std::move(txn_accessor));
+  // The checkpoint is 16 intervals ahead, so the state is fetched instead of
+  // the requests.
+  for (int i = 2; i <= 3; ++i) {
+    EXPECT_EQ(manager.ProcessCheckPoint(
+                  std::make_unique<Context>(),
+                  GenerateCheckPoint(i, 80, "txn_digest", state_digest)),
+              0);
+  }
+  done_future.get();
+  EXPECT_EQ(executor.GetMaxPendingExecutedSeq(), 80);
+}
+
+TEST_F(CheckPointManagerTest, SyncStateAlreadyCaughtUp) {
+  config_.SetViewchangeCommitTimeout(100);
+  SystemInfo system_info(config_);
+  std::vector<StateChunk> chunks;
+  std::string state_digest =
+      GenerateStateChunks(80, {{"key1", "value1"}}, &chunks);
+
+  auto transaction_manager = std::make_unique<MockTransactionManager>();
+  EXPECT_CALL(*transaction_manager, ApplyStateChunk).Times(0);
+  TransactionExecutor executor(
+      config_,
+      [](std::unique_ptr<Request>, std::unique_ptr<BatchUserResponse>) {},
+      &system_info, std::move(transaction_manager));
+  EXPECT_CALL(replica_communicator_, BroadCast).Times(16);
+
+  CheckPointManager manager(config_, &replica_communicator_, nullptr);
+  auto txn_accessor = std::make_unique<MockResDBTxnAccessor>(config_);
+  EXPECT_CALL(*txn_accessor, GetStateChunkFromReplica(80, _, _))
+      .WillRepeatedly(Invoke([&](uint64_t, uint32_t index, const ReplicaInfo&)
+                                 -> absl::StatusOr<StateChunk> {
+        if (index + 1 == chunks.size()) {
+          // The requests up to the checkpoint are committed during the
+          // download.
+          for (int i = 1; i <= 80; ++i) {
+            std::unique_ptr<Request> request = std::make_unique<Request>();
+            request->set_seq(i);
+            manager.AddCommitData(std::move(request));
+          }
+          while (manager.GetMaxTxnSeq() < 80) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          }
+        }
+        return chunks[index];
+      }));
+  manager.SetExecutor(&executor);
+  manager.SetTxnAccessor(std::move(txn_accessor));
+  for (int i = 2; i <= 3; ++i) {
+    EXPECT_EQ(manager.ProcessCheckPoint(
+                  std::make_unique<Context>(),
+                  GenerateCheckPoint(i, 80, "txn_digest", state_digest)),
+              0);
+  }
+  while (manager.GetHighestPreparedSeq() < 80) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // The state is not installed over the requests committed.
+  EXPECT_EQ(executor.GetMaxPendingExecutedSeq(), 0);
+}
+
+TEST_F(CheckPointManagerTest, CatchUpRejectsStateQuery) {
+  SystemInfo system_info(config_);
+  std::vector<Request> requests;
+  CheckPointDigest digest;
+  for (int i = 1; i <= 5; ++i) {
+    Request request;
+    request.set_seq(i);
+    request.set_data("data" + std::to_string(i));
+    request.set_hash(SignatureVerifier::CalculateHash(request.data()));
+    digest.Add(request.hash());
+    requests.push_back(request);
+  }
+  std::string txn_digest = digest.Seal();
+
+  std::promise<bool> done;
+  std::future<bool> done_future = done.get_future();
+  auto transaction_manager = std::make_unique<MockTransactionManager>();
+  EXPECT_CALL(*transaction_manager, ExecuteBatch)
+      .Times(5)
+      .WillRepeatedly(Invoke([&](const BatchUserRequest& request) {
+        if (request.seq() == 5) {
+          done.set_value(true);
+        }
+        return nullptr;
+      }));
+  TransactionExecutor executor(
+      config_,
+      [](std::unique_ptr<Request>, std::unique_ptr<BatchUserResponse>) {},
+      &system_info, std::move(transaction_manager));
+
+  // Replica 2 returns the requests with one typed as a state query, which
+  // passes the digest check, and replica 3 returns them as they are.
+  auto txn_accessor = std::make_unique<MockResDBTxnAccessor>(config_);
+  EXPECT_CALL(*txn_accessor, GetRequestFromReplica(1, 5, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](uint64_t, uint64_t, const ReplicaInfo& replica)
+                                 -> absl::StatusOr<std::vector<Request>> {
+        std::vector<Request> ret = requests;
+        if (replica.id() == 2) {
+          ret[2].set_type(Request::TYPE_STATE_QUERY);
+        }
+        return ret;
+      }));
+
+  CheckPointManager manager(config_, &replica_communicator_, nullptr);
+  manager.SetExecutor(&executor);
+  manager.SetTxnAccessor(std::move(txn_accessor));
+  for (int i = 2; i <= 3; ++i) {
+    EXPECT_EQ(
+        manager.ProcessCheckPoint(std::make_unique<Context>(),
+                                  GenerateCheckPoint(i, 5, txn_digest, "")),
+        0);
+  }
+  done_future.get();
+}
+
 /*
 TEST_F(CheckPointManagerTest, SetTimeoutHandler) {
   CheckPointManager manager(config_, &replica_communicator_, nullptr);
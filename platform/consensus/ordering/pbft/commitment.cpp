@@ -28,11 +28,19 @@
 #include <glog/logging.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "common/utils/utils.h"
 #include "platform/consensus/ordering/pbft/transaction_utils.h"
 
 namespace resdb {
 
+namespace {
+// How long a proposal waits for its payload before fetching it from the
+// proposer.
+constexpr std::chrono::milliseconds kPayloadFetchDelay(10);
+}  // namespace
+
 Commitment::Commitment(const ResDBConfig& config,
                        MessageManager* message_manager,
                        ReplicaCommunicator* replica_communicator,
@@ -44,8 +52,18 @@ Commitment::Commitment(const ResDBConfig& config,
       verifier_(verifier) {
   executed_thread_ = std::thread(&Commitment::PostProcessExecutedMsg, this);
   global_stats_ = Stats::GetGlobalStats();
+  tracer_ = SeqTracer::GetGlobalTracer();
   duplicate_manager_ = std::make_unique<DuplicateManager>(config);
   message_manager_->SetDuplicateManager(duplicate_manager_.get());
+  if (config_.IsDigestPrePrepareEnabled()) {
+    payload_store_ =
+        std::make_unique<PayloadStore>(config_.GetMaxProcessTxn() * 4);
+    if (config_.IsErasureCodedPayloadEnabled()) {
+      payload_codec_ = std::make_unique<PayloadCodec>(config_);
+    }
+    payload_fetch_thread_ =
+        std::thread(&Commitment::FetchMissingPayloads, this);
+  }
 }
 
 Commitment::~Commitment() {
@@ -53,6 +71,9 @@ Commitment::~Commitment() {
   if (executed_thread_.joinable()) {
     executed_thread_.join();
   }
+  if (payload_fetch_thread_.joinable()) {
+    payload_fetch_thread_.join();
+  }
 }
 
 void Commitment::SetPreVerifyFunc(
@@ -95,12 +116,14 @@ int Commitment::ProcessNewRequest(std::unique_ptr<Context> context,
     return -3;
   }
 
-  /*
-  if(SignatureVerifier::CalculateHash(user_request->data()) !=
-  user_request->hash()){ LOG(ERROR) << "the hash and data of the user request
-  don't match, reject"; return -2;
+  // Only the digest is proposed when the payload is kept in payload_store_,
+  // so the replicas trust the hash to match the data.
+  if (payload_store_ &&
+      SignatureVerifier::CalculateHash(user_request->data()) !=
+          user_request->hash()) {
+    LOG(ERROR) << "the hash and data of the user request don't match, reject";
+    return -2;
   }
-  */
 
   // check signatures
   bool valid = verifier_->VerifyMessage(user_request->data(),
@@ -143,9 +166,19 @@ int Commitment::ProcessNewRequest(std::unique_ptr<Context> context,
   user_request->set_type(Request::TYPE_PRE_PREPARE);
   user_request->set_current_view(message_manager_->GetCurrentView());
   user_request->set_seq(*seq);
+  tracer_->AddEvent(*seq, "propose");
   user_request->set_sender_id(config_.GetSelfInfo().id());
   user_request->set_primary_id(config_.GetSelfInfo().id());
 
+  if (payload_store_) {
+    // The proxy has sent the batch to the other replicas. Keep it for the
+    // ones missing it and only propose the digest.
+    ProcessWaitingProposals(payload_store_->AddPayload(*user_request));
+    user_request->clear_data();
+    user_request->clear_data_signature();
+    user_request->set_digest_only(true);
+  }
+
   replica_communicator_->BroadCast(*user_request);
 
   return 0;
@@ -159,6 +192,12 @@ int Commitment::ProcessProposeMsg(std::unique_ptr<Context> context,
     LOG(ERROR) << "user request doesn't contain signature, reject";
     return -2;
   }
+  if (request->digest_only()) {
+    int ret = FillPayload(&context, &request);
+    if (ret != 0) {
+      return ret;
+    }
+  }
   if (request->is_recovery()) {
     if (request->seq() >= message_manager_->GetNextSeq()) {
       message_manager_->SetNextSeq(request->seq() + 1);
@@ -284,7 +323,150 @@ int Commitment::ProcessCommitMsg(std::unique_ptr<Context> context,
   return ret == CollectorResultCode::INVALID ? -2 : 0;
 }
 
+int Commitment::ProcessPayloadMsg(std::unique_ptr<Context> context,
+                                  std::unique_ptr<Request> request) {
+  if (payload_store_ == nullptr) {
+    LOG(ERROR) << "digest pre-prepare is not enabled";
+    return -2;
+  }
+  if (SignatureVerifier::CalculateHash(request->data()) != request->hash()) {
+    LOG(ERROR) << "the hash and data of the payload don't match, reject";
+    return -2;
+  }
+  ProcessWaitingProposals(payload_store_->AddPayload(*request));
+  return 0;
+}
+
+int Commitment::ProcessPayloadFetchMsg(std::unique_ptr<Context> context,
+                                       std::unique_ptr<Request> request) {
+  if (payload_store_ == nullptr) {
+    LOG(ERROR) << "digest pre-prepare is not enabled";
+    return -2;
+  }
+  std::unique_ptr<Request> payload =
+      payload_store_->GetPayload(request->hash());
+  if (payload == nullptr) {
+    LOG(ERROR) << "payload not found, seq:" << request->seq()
+               << " from:" << request->sender_id();
+    return -2;
+  }
+  payload->set_type(Request::TYPE_PAYLOAD);
+  payload->set_seq(request->seq());
+  payload->set_sender_id(config_.GetSelfInfo().id());
+  replica_communicator_->SendMessage(*payload, request->sender_id());
+  return 0;
+}
+
+int Commitment::ProcessPayloadChunkMsg(std::unique_ptr<Context> context,
+                                       std::unique_ptr<Request> request) {
+  if (payload_store_ == nullptr || payload_codec_ == nullptr) {
+    LOG(ERROR) << "erasure coded payload is not enabled";
+    return -2;
+  }
+  // The proxy sends each replica its own chunk, which is forwarded to the
+  // other replicas except the primary, which has the whole payload. The
+  // sender is taken from the verified signature since sender_id is not
+  // signed.
+  bool from_proxy = context != nullptr &&
+                    context->signature.node_id() == request->proxy_id();
+  if (from_proxy) {
+    Request chunk_request(*request);
+    chunk_request.set_sender_id(config_.GetSelfInfo().id());
+    for (const auto& replica : config_.GetReplicaInfos()) {
+      if (replica.id() != config_.GetSelfInfo().id() &&
+          replica.id() != message_manager_->GetCurrentPrimary()) {
+        replica_communicator_->SendMessage(chunk_request, replica.id());
+      }
+    }
+  }
+  std::unique_ptr<Request> payload =
+      payload_codec_->AddChunk(*request, from_proxy);
+  if (payload == nullptr) {
+    return 0;
+  }
+  return ProcessPayloadMsg(std::move(context), std::move(payload));
+}
+
+int Commitment::FillPayload(std::unique_ptr<Context>* context,
+                            std::unique_ptr<Request>* request) {
+  if (payload_store_ == nullptr) {
+    LOG(ERROR) << "digest pre-prepare is not enabled";
+    return -2;
+  }
+  PayloadStore::Proposal proposal;
+  proposal.context = std::move(*context);
+  proposal.request = std::move(*request);
+  switch (payload_store_->FillProposal(&proposal)) {
+    case PayloadStore::FillResult::FILLED:
+      proposal.request->set_digest_only(false);
+      *context = std::move(proposal.context);
+      *request = std::move(proposal.request);
+      return 0;
+    case PayloadStore::FillResult::WAITING:
+      // Without erasure coding the payload is not rebuilt from the chunks
+      // still on the way, so fetch it right away.
+      if (payload_codec_ == nullptr) {
+        SendPayloadFetches(std::chrono::milliseconds(0));
+      }
+      return 1;
+    case PayloadStore::FillResult::DROPPED:
+      break;
+  }
+  return -2;
+}
+
+void Commitment::ProcessWaitingProposals(
+    std::vector<PayloadStore::Proposal> proposals) {
+  for (auto& proposal : proposals) {
+    ProcessProposeMsg(std::move(proposal.context),
+                      std::move(proposal.request));
+  }
+}
+
 // =========== private threads ===========================
+// Fetch the payloads that proposals have waited for too long from the
+// proposers, which keep the payloads they proposed, and drop the proposals
+// that no longer need them.
+void Commitment::FetchMissingPayloads() {
+  while (!stop_) {
+    usleep(kPayloadFetchDelay.count() * 1000 / 2);
+    size_t expired_num =
+        payload_store_->ExpireWaiting(message_manager_->GetStableCheckpoint(),
+                                      message_manager_->GetCurrentView());
+    if (expired_num > 0) {
+      LOG(ERROR) << "drop proposals waiting for payloads:" << expired_num;
+    }
+    SendPayloadFetches(kPayloadFetchDelay);
+  }
+}
+
+void Commitment::SendPayloadFetches(std::chrono::milliseconds delay) {
+  // The replicas a retry can ask, since the proposer may be faulty and the
+  // other replicas keep the payloads they received.
+  std::vector<int64_t> replica_ids;
+  for (const auto& replica : config_.GetReplicaInfos()) {
+    if (replica.id() != config_.GetSelfInfo().id()) {
+      replica_ids.push_back(replica.id());
+    }
+  }
+  for (const PayloadStore::FetchTarget& target :
+       payload_store_->GetFetchTargets(delay)) {
+    int64_t replica_id = target.sender_id;
+    if (target.attempt > 0 && !replica_ids.empty()) {
+      auto it =
+          std::find(replica_ids.begin(), replica_ids.end(), target.sender_id);
+      size_t pos = it == replica_ids.end() ? 0 : it - replica_ids.begin();
+      replica_id = replica_ids[(pos + target.attempt) % replica_ids.size()];
+    }
+    Request fetch_request;
+    fetch_request.set_type(Request::TYPE_PAYLOAD_FETCH);
+    fetch_request.set_hash(target.hash);
+    fetch_request.set_seq(target.seq);
+    fetch_request.set_sender_id(config_.GetSelfInfo().id());
+    replica_communicator_->SendMessage(fetch_request, replica_id);
+  }
+}
+
 // If the transaction is executed, send back to the proxy.
 int Commitment::PostProcessExecutedMsg() {
   while (!stop_) {
@@ -300,6 +482,7 @@ int Commitment::PostProcessExecutedMsg() {
     request.set_current_view(batch_resp->current_view());
     request.set_proxy_id(batch_resp->proxy_id());
     request.set_primary_id(batch_resp->primary_id());
+    tracer_->AddEvent(batch_resp->seq(), "response");
     // LOG(ERROR)<<"send back to proxy:"<<batch_resp->proxy_id();
     batch_resp->SerializeToString(request.mutable_data());
     replica_communicator_->SendMessage(request, request.proxy_id());
@@ -29,8 +29,11 @@
 #include "platform/config/resdb_config.h"
 #include "platform/consensus/execution/duplicate_manager.h"
 #include "platform/consensus/ordering/pbft/message_manager.h"
+#include "platform/consensus/ordering/pbft/payload_codec.h"
+#include "platform/consensus/ordering/pbft/payload_store.h"
 #include "platform/consensus/ordering/pbft/response_manager.h"
 #include "platform/networkstrate/replica_communicator.h"
+#include "platform/statistic/seq_tracer.h"
 #include "platform/statistic/stats.h"
 
 namespace resdb {
@@ -52,6 +55,18 @@ class Commitment {
   virtual int ProcessCommitMsg(std::unique_ptr<Context> context,
                                std::unique_ptr<Request> request);
 
+  // Receive a batch disseminated by a proxy, or one fetched from the
+  // primary, and resume the digest-only proposals waiting for it.
+  int ProcessPayloadMsg(std::unique_ptr<Context> context,
+                        std::unique_ptr<Request> request);
+  // Collect an erasure-coded chunk of a payload. Chunks received from the
+  // proxy are forwarded to the other replicas.
+  int ProcessPayloadChunkMsg(std::unique_ptr<Context> context,
+                             std::unique_ptr<Request> request);
+  // Send back the payload asked by a replica missing it.
+  int ProcessPayloadFetchMsg(std::unique_ptr<Context> context,
+                             std::unique_ptr<Request> request);
+
   void SetPreVerifyFunc(std::function<bool(const Request& request)> func);
   void SetNeedCommitQC(bool need_qc);
 
@@ -65,6 +80,17 @@ class Commitment {
  protected:
   virtual int PostProcessExecutedMsg();
 
+  void FetchMissingPayloads();
+  // Fetch the payloads that proposals have waited for longer than delay,
+  // from their proposers first and then from the other replicas in turn.
+  void SendPayloadFetches(std::chrono::milliseconds delay);
+
+  // Fill the data of a digest-only proposal. Returns 1 if the payload is
+  // missing and the proposal is kept until it arrives.
+  int FillPayload(std::unique_ptr<Context>* context,
+                  std::unique_ptr<Request>* request);
+  void ProcessWaitingProposals(std::vector<PayloadStore::Proposal> proposals);
+
  protected:
   ResDBConfig config_;
   MessageManager* message_manager_;
@@ -74,12 +100,16 @@ class Commitment {
 
   SignatureVerifier* verifier_;
   Stats* global_stats_;
+  SeqTracer* tracer_;
 
   std::function<bool(const Request& request)> pre_verify_func_;
   bool need_qc_ = false;
 
   std::mutex mutex_;
   std::unique_ptr<DuplicateManager> duplicate_manager_;
+  std::unique_ptr<PayloadStore> payload_store_;
+  std::unique_ptr<PayloadCodec> payload_codec_;
+  std::thread payload_fetch_thread_;
 };
 
 }  // namespace resdb
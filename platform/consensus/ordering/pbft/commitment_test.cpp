@@ -47,9 +47,13 @@ using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::Test;
 
-ResDBConfig GenerateConfig() {
+ResDBConfig GenerateConfig(bool digest_preprepare = false,
+                           bool erasure_coded_payload = false) {
   ResConfigData data;
   data.set_duplicate_check_frequency_useconds(100000);
+  data.set_enable_digest_preprepare(digest_preprepare);
+  data.set_enable_erasure_coded_payload(erasure_coded_payload);
+  data.set_erasure_coded_payload_min_bytes(1);
   return ResDBConfig({GenerateReplicaInfo(1, "127.0.0.1", 1234),
                       GenerateReplicaInfo(2, "127.0.0.1", 1235),
                       GenerateReplicaInfo(3, "127.0.0.1", 1236),
@@ -71,6 +75,16 @@ class CommitmentTest : public Test {
             std::make_unique<Commitment>(config_, message_manager_.get(),
                                          &replica_communicator_, &verifier_)) {}
 
+  void EnableDigestPrePrepare(bool erasure_coded_payload = false) {
+    ResDBConfig config =
+        GenerateConfig(/*digest_preprepare=*/true, erasure_coded_payload);
+    commitment_ = nullptr;
+    message_manager_ = std::make_unique<MessageManager>(
+        config, nullptr, &checkpoint_manager_, &system_info_);
+    commitment_ = std::make_unique<Commitment>(
+        config, message_manager_.get(), &replica_communicator_, &verifier_);
+  }
+
   std::unique_ptr<Context> GetContext() {
     auto context = std::make_unique<Context>();
     context->signature.set_signature("signature");
@@ -180,6 +194,135 @@ TEST_F(CommitmentTest, NewRequest) {
   propose_done_future.get();
 }
 
+TEST_F(CommitmentTest, NewRequestWithDigestOnly) {
+  EnableDigestPrePrepare();
+  Request request;
+  request.set_data("data");
+  request.set_hash(SignatureVerifier::CalculateHash("data"));
+
+  EXPECT_CALL(replica_communicator_, BroadCast)
+      .WillOnce(Invoke([&](const google::protobuf::Message& message) {
+        const Request& propose = dynamic_cast<const Request&>(message);
+        EXPECT_EQ(propose.type(), Request::TYPE_PRE_PREPARE);
+        EXPECT_TRUE(propose.digest_only());
+        EXPECT_TRUE(propose.data().empty());
+        EXPECT_EQ(propose.hash(), SignatureVerifier::CalculateHash("data"));
+      }));
+  EXPECT_CALL(verifier_, VerifyMessage("data", EqualsProto(SignatureInfo())))
+      .WillOnce(Return(true));
+
+  EXPECT_EQ(commitment_->ProcessNewRequest(GetContext(),
+                                           std::make_unique<Request>(request)),
+            0);
+}
+
+TEST_F(CommitmentTest, NewRequestWithDigestOnlyHashMismatch) {
+  EnableDigestPrePrepare();
+  Request request;
+  request.set_data("data");
+  request.set_hash("hash");
+
+  EXPECT_CALL(replica_communicator_, BroadCast).Times(0);
+
+  EXPECT_EQ(commitment_->ProcessNewRequest(GetContext(),
+                                           std::make_unique<Request>(request)),
+            -2);
+}
+
+TEST_F(CommitmentTest, DigestOnlyProposeFetchOnMiss) {
+  EnableDigestPrePrepare();
+  system_info_.SetPrimary(3);
+  BatchUserRequest batch_request;
+  batch_request.add_user_requests();
+  batch_request.SerializeToString(&data_);
+  std::string hash = SignatureVerifier::CalculateHash(data_);
+
+  Request fetch_request;
+  fetch_request.set_type(Request::TYPE_PAYLOAD_FETCH);
+  fetch_request.set_hash(hash);
+  fetch_request.set_seq(1);
+  fetch_request.set_sender_id(1);
+  std::promise<bool> fetch_done;
+  std::future<bool> fetch_done_future = fetch_done.get_future();
+  EXPECT_CALL(replica_communicator_,
+              SendMessage(EqualsProto(fetch_request), 3))
+      .WillOnce(Invoke([&]() { fetch_done.set_value(true); }));
+  EXPECT_CALL(verifier_, VerifyMessage(data_, EqualsProto(SignatureInfo())))
+      .WillOnce(Return(true));
+  EXPECT_CALL(replica_communicator_, BroadCast).Times(1);
+
+  Request request;
+  request.set_current_view(1);
+  request.set_seq(1);
+  request.set_type(Request::TYPE_PRE_PREPARE);
+  request.set_sender_id(3);
+  request.set_hash(hash);
+  request.set_digest_only(true);
+  EXPECT_EQ(commitment_->ProcessProposeMsg(GetContext(),
+                                           std::make_unique<Request>(request)),
+            1);
+  fetch_done_future.get();
+
+  Request payload;
+  payload.set_type(Request::TYPE_PAYLOAD);
+  payload.set_data("bad data");
+  payload.set_hash(hash);
+  EXPECT_EQ(commitment_->ProcessPayloadMsg(GetContext(),
+                                           std::make_unique<Request>(payload)),
+            -2);
+
+  payload.set_data(data_);
+  EXPECT_EQ(commitment_->ProcessPayloadMsg(GetContext(),
+                                           std::make_unique<Request>(payload)),
+            0);
+}
+
+TEST_F(CommitmentTest, DigestOnlyProposeWithPayloadChunks) {
+  EnableDigestPrePrepare(/*erasure_coded_payload=*/true);
+  system_info_.SetPrimary(3);
+  BatchUserRequest batch_request;
+  batch_request.add_user_requests()->mutable_request()->set_data(
+      std::string(1000, 'a'));
+  batch_request.SerializeToString(&data_);
+
+  Request payload;
+  payload.set_type(Request::TYPE_PAYLOAD);
+  payload.set_data(data_);
+  payload.set_hash(SignatureVerifier::CalculateHash(data_));
+  payload.set_sender_id(2);
+  payload.set_proxy_id(2);
+  std::map<int64_t, Request> chunks = PayloadCodec(config_).Encode(payload);
+
+  // The chunk from the proxy is forwarded to replica 2 and 4.
+  EXPECT_CALL(replica_communicator_, SendMessage(::testing::_, 2)).Times(1);
+  EXPECT_CALL(replica_communicator_, SendMessage(::testing::_, 4)).Times(1);
+  EXPECT_CALL(verifier_, VerifyMessage(data_, EqualsProto(SignatureInfo())))
+      .WillOnce(Return(true));
+  EXPECT_CALL(replica_communicator_, BroadCast).Times(1);
+
+  Request request;
+  request.set_current_view(1);
+  request.set_seq(1);
+  request.set_type(Request::TYPE_PRE_PREPARE);
+  request.set_sender_id(3);
+  request.set_hash(payload.hash());
+  request.set_digest_only(true);
+  EXPECT_EQ(commitment_->ProcessProposeMsg(GetContext(),
+                                           std::make_unique<Request>(request)),
+            1);
+
+  std::unique_ptr<Context> proxy_context = GetContext();
+  proxy_context->signature.set_node_id(2);
+  EXPECT_EQ(commitment_->ProcessPayloadChunkMsg(
+                std::move(proxy_context), std::make_unique<Request>(chunks[1])),
+            0);
+  // A replica claiming to be the proxy is not forwarded.
+  chunks[4].set_sender_id(2);
+  EXPECT_EQ(commitment_->ProcessPayloadChunkMsg(
+                GetContext(), std::make_unique<Request>(chunks[4])),
+            0);
+}
+
 TEST_F(CommitmentTest, SeqConsumeAll) {
   config_.SetMaxProcessTxn(2);
   commitment_ = nullptr;
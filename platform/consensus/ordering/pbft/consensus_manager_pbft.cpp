@@ -66,6 +66,9 @@ ConsensusManagerPBFT::ConsensusManagerPBFT(
   LOG(INFO) << "is running is performance mode:"
             << config_.IsPerformanceRunning();
   global_stats_ = Stats::GetGlobalStats();
+  SeqTracer::GetGlobalTracer()->Start(config_.GetTraceSampleRate(),
+                                      config_.GetTraceFile(),
+                                      config_.GetSelfInfo().id());
 
   view_change_manager_->SetDuplicateManager(commitment_->GetDuplicateManager());
 
@@ -238,6 +241,15 @@ int ConsensusManagerPBFT::InternalConsensusCommit(
     case Request::TYPE_COMMIT:
       return commitment_->ProcessCommitMsg(std::move(context),
                                            std::move(request));
+    case Request::TYPE_PAYLOAD:
+      return commitment_->ProcessPayloadMsg(std::move(context),
+                                            std::move(request));
+    case Request::TYPE_PAYLOAD_CHUNK:
+      return commitment_->ProcessPayloadChunkMsg(std::move(context),
+                                                 std::move(request));
+    case Request::TYPE_PAYLOAD_FETCH:
+      return commitment_->ProcessPayloadFetchMsg(std::move(context),
+                                                 std::move(request));
     case Request::TYPE_CHECKPOINT:
       return checkpoint_manager_->ProcessCheckPoint(std::move(context),
                                                     std::move(request));
@@ -254,6 +266,8 @@ int ConsensusManagerPBFT::InternalConsensusCommit(
                                             std::move(request));
     case Request::TYPE_CUSTOM_QUERY:
       return query_->ProcessCustomQuery(std::move(context), std::move(request));
+    case Request::TYPE_STATE_QUERY:
+      return query_->ProcessStateQuery(std::move(context), std::move(request));
   }
   return 0;
 }
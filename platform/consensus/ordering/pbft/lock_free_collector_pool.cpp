@@ -41,16 +41,18 @@ uint32_t GetCapacity(uint32_t size) {
 LockFreeCollectorPool::LockFreeCollectorPool(const std::string& name,
                                              uint32_t size,
                                              TransactionExecutor* executor,
-                                             bool enable_viewchange)
+                                             bool enable_viewchange,
+                                             uint32_t replica_num)
     : name_(name),
       capacity_(GetCapacity(size * 2)),
       mask_((capacity_ << 1) - 1),
       executor_(executor),
-      enable_viewchange_(enable_viewchange) {
+      enable_viewchange_(enable_viewchange),
+      replica_num_(replica_num) {
   collector_.resize(capacity_ << 1);
   for (size_t i = 0; i < (capacity_ << 1); ++i) {
-    collector_[i] = std::make_unique<TransactionCollector>(i, executor_,
-                                                           enable_viewchange_);
+    collector_[i] = std::make_unique<TransactionCollector>(
+        i, executor_, enable_viewchange_, replica_num_);
   }
   LOG(ERROR) << "name:" << name_ << " create pool done. capacity:" << capacity_
              << " enable viewchange:" << enable_viewchange_ << " done";
@@ -64,8 +66,7 @@ void LockFreeCollectorPool::Update(uint64_t seq) {
   }
   // LOG(ERROR)<<" update:"<<(idx^capacity_)<<" seq:"<<seq+capacity_<<
   // 	  " cap:"<<capacity_<<" update seq:"<<seq;
-  collector_[idx ^ capacity_] = std::make_unique<TransactionCollector>(
-      seq + capacity_, executor_, enable_viewchange_);
+  collector_[idx ^ capacity_]->Reset(seq + capacity_);
 }
 
 TransactionCollector* LockFreeCollectorPool::GetCollector(uint64_t seq) {
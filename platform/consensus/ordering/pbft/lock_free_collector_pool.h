@@ -35,7 +35,8 @@ class LockFreeCollectorPool {
  public:
   LockFreeCollectorPool(const std::string& name, uint32_t size,
                         TransactionExecutor* executor,
-                        bool enable_viewchange = false);
+                        bool enable_viewchange = false,
+                        uint32_t replica_num = 128);
 
   TransactionCollector* GetCollector(uint64_t seq);
   void Update(uint64_t seq);
@@ -47,6 +48,7 @@ class LockFreeCollectorPool {
   TransactionExecutor* executor_;
   std::vector<std::unique_ptr<TransactionCollector>> collector_;
   bool enable_viewchange_;
+  uint32_t replica_num_;
 };
 
 }  // namespace resdb
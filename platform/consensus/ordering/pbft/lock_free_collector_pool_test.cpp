@@ -65,6 +65,20 @@ TEST_F(CollectorPoolTest, AddRequest) {
   EXPECT_EQ(AddRequest(&pool, 16), 0);
 }
 
+TEST_F(CollectorPoolTest, ReuseCollector) {
+  LockFreeCollectorPool pool("test", 2, nullptr);
+  TransactionCollector* collector = pool.GetCollector(0);
+  EXPECT_EQ(AddRequest(&pool, 0), 0);
+  pool.Update(8);
+
+  // The collector of seq 0 is reused for seq 16.
+  EXPECT_EQ(pool.GetCollector(16), collector);
+  EXPECT_EQ(collector->Seq(), 16);
+  EXPECT_EQ(collector->GetStatus(), TransactionStatue::None);
+  EXPECT_EQ(AddRequest(&pool, 0), -2);
+  EXPECT_EQ(AddRequest(&pool, 16), 0);
+}
+
 }  // namespace
 
 }  // namespace resdb
@@ -40,6 +40,15 @@ MessageManager::MessageManager(
       txn_db_(checkpoint_manager->GetTxnDB()),
       system_info_(system_info),
       checkpoint_manager_(checkpoint_manager),
+      adaptive_controller_(
+          config_.IsAdaptiveWindowEnabled()
+              ? std::make_unique<AdaptiveController>(
+                    config_.GetMinProcessTxn(), config_.GetMaxProcessTxn(),
+                    config_.GetMinClientBatchNum(),
+                    config_.GetMaxClientBatchNum(),
+                    config_.GetTargetCommitLatencyUs())
+              : nullptr),
+      assign_time_size_(config_.GetMaxProcessTxn() * 2 + 2),
       transaction_executor_(std::make_unique<TransactionExecutor>(
           config,
           [&](std::unique_ptr<Request> request,
@@ -47,6 +56,8 @@ MessageManager::MessageManager(
             if (request->is_recovery()) {
               return;
             }
+            AddCommitLatency(request->seq());
+            AddPhaseLatency(request->seq(), COMMIT_LATENCY);
             resp_msg->set_proxy_id(request->proxy_id());
             resp_msg->set_seq(request->seq());
             resp_msg->set_current_view(request->current_view());
@@ -62,11 +73,27 @@ MessageManager::MessageManager(
           system_info_, std::move(transaction_manager))),
       collector_pool_(std::make_unique<LockFreeCollectorPool>(
           "txn", config_.GetMaxProcessTxn(), transaction_executor_.get(),
-          config_.GetConfigData().enable_viewchange())) {
+          config_.GetConfigData().enable_viewchange(),
+          config_.GetReplicaNum())) {
   global_stats_ = Stats::GetGlobalStats();
+  tracer_ = SeqTracer::GetGlobalTracer();
+  phase_time_ = std::make_unique<std::atomic<uint64_t>[]>(assign_time_size_);
+  for (uint32_t i = 0; i < assign_time_size_; ++i) {
+    phase_time_[i] = 0;
+  }
+  if (adaptive_controller_) {
+    assign_time_ = std::make_unique<std::atomic<uint64_t>[]>(assign_time_size_);
+    for (uint32_t i = 0; i < assign_time_size_; ++i) {
+      assign_time_[i] = 0;
+    }
+  }
   transaction_executor_->SetSeqUpdateNotifyFunc(
       [&](uint64_t seq) { collector_pool_->Update(seq - 1); });
   checkpoint_manager_->SetExecutor(transaction_executor_.get());
+  if (config_.GetConfigData().enable_viewchange()) {
+    checkpoint_manager_->SetStableCheckPointHandler(
+        [&](uint64_t stable_seq) { prepared_certs_.Prune(stable_seq); });
+  }
 }
 
 MessageManager::~MessageManager() {
@@ -87,6 +114,10 @@ uint64_t MessageManager ::GetCurrentView() const {
   return system_info_->GetCurrentView();
 }
 
+uint64_t MessageManager::GetStableCheckpoint() {
+  return checkpoint_manager_->GetStableCheckpoint();
+}
+
 void MessageManager::SetNextSeq(uint64_t seq) {
   next_seq_ = seq;
   LOG(ERROR) << "set next seq:" << next_seq_;
@@ -98,15 +129,48 @@ absl::StatusOr<uint64_t> MessageManager::AssignNextSeq() {
   std::unique_lock<std::mutex> lk(seq_mutex_);
   uint32_t max_executed_seq = transaction_executor_->GetMaxPendingExecutedSeq();
   global_stats_->SeqGap(next_seq_ - max_executed_seq);
-  if (next_seq_ - max_executed_seq >
-      static_cast<uint64_t>(config_.GetMaxProcessTxn())) {
+  if (next_seq_ - max_executed_seq > static_cast<uint64_t>(GetWindowSize())) {
     // LOG(ERROR) << "next_seq_: " << next_seq_ << " max_executed_seq: " <<
     // max_executed_seq;
     return absl::InvalidArgumentError("Seq has been used up.");
   }
+  if (assign_time_) {
+    assign_time_[next_seq_ % assign_time_size_] = GetCurrentTime();
+  }
   return next_seq_++;
 }
 
+uint32_t MessageManager::GetWindowSize() const {
+  if (adaptive_controller_) {
+    return adaptive_controller_->GetWindow();
+  }
+  return config_.GetMaxProcessTxn();
+}
+
+void MessageManager::AddCommitLatency(uint64_t seq) {
+  if (assign_time_ == nullptr) {
+    return;
+  }
+  // Only the primary assigns seqs, so other replicas find no time here.
+  uint64_t assign_time = assign_time_[seq % assign_time_size_].exchange(0);
+  if (assign_time == 0) {
+    return;
+  }
+  adaptive_controller_->AddLatency(GetCurrentTime() - assign_time);
+}
+
+void MessageManager::AddPhaseLatency(uint64_t seq, LatencyName name) {
+  std::atomic<uint64_t>& phase_time = phase_time_[seq % assign_time_size_];
+  uint64_t current_time = GetCurrentTime();
+  // Each phase starts when the last one ends. Executing is the last phase.
+  uint64_t start_time =
+      phase_time.exchange(name == COMMIT_LATENCY ? 0 : current_time);
+  if (start_time == 0 || start_time > current_time) {
+    return;
+  }
+  global_stats_->AddLatency(name, current_time - start_time);
+}
+
 std::vector<ReplicaInfo> MessageManager::GetReplicas() {
   return system_info_->GetReplicas();
 }
@@ -184,6 +248,7 @@ CollectorResultCode MessageManager::AddConsensusMsg(
   uint64_t seq = request->seq();
   int resp_received_count = 0;
   int proxy_id = request->proxy_id();
+  std::string prepared_hash;
 
   int ret = collector_pool_->GetCollector(seq)->AddRequest(
       std::move(request), signature, type == Request::TYPE_PRE_PREPARE,
@@ -192,6 +257,17 @@ CollectorResultCode MessageManager::AddConsensusMsg(
           std::atomic<TransactionStatue>* status, bool force) {
         if (MayConsensusChangeStatus(type, received_count, status, force)) {
           resp_received_count = 1;
+          prepared_hash = request.hash();
+          if (type == Request::TYPE_PRE_PREPARE) {
+            phase_time_[seq % assign_time_size_] = GetCurrentTime();
+            tracer_->AddEvent(seq, "pre_prepare");
+          } else if (type == Request::TYPE_PREPARE) {
+            AddPhaseLatency(seq, PROPOSE_LATENCY);
+            tracer_->AddEvent(seq, "prepared");
+          } else if (type == Request::TYPE_COMMIT) {
+            AddPhaseLatency(seq, PREPARE_LATENCY);
+            tracer_->AddEvent(seq, "committed");
+          }
         }
       });
   if (ret == 1) {
@@ -200,6 +276,12 @@ CollectorResultCode MessageManager::AddConsensusMsg(
     return CollectorResultCode::INVALID;
   }
   if (resp_received_count > 0) {
+    if (type == Request::TYPE_PREPARE &&
+        config_.GetConfigData().enable_viewchange()) {
+      // Keep the certificate now so that a view change does not need to
+      // collect it from the collectors.
+      prepared_certs_.Add(seq, prepared_hash, GetPreparedProof(seq));
+    }
     return CollectorResultCode::STATE_CHANGED;
   }
   return CollectorResultCode::OK;
@@ -228,8 +310,17 @@ RequestSet MessageManager::GetRequestSet(uint64_t min_seq, uint64_t max_seq) {
 // Get the transactions that have been execuited.
 Request* MessageManager::GetRequest(uint64_t seq) { return txn_db_->Get(seq); }
 
+std::unique_ptr<StateChunk> MessageManager::GetStateChunk(uint64_t seq,
+                                                          uint32_t index) {
+  return transaction_executor_->GetStateChunk(seq, index);
+}
+
 std::vector<RequestInfo> MessageManager::GetPreparedProof(uint64_t seq) {
-  return collector_pool_->GetCollector(seq)->GetPreparedProof();
+  return collector_pool_->GetCollector(seq)->GetPreparedProof(seq);
+}
+
+PreparedCertificateStore* MessageManager::GetPreparedCertificateStore() {
+  return &prepared_certs_;
 }
 
 TransactionStatue MessageManager::GetTransactionState(uint64_t seq) {
@@ -36,13 +36,16 @@
 #include "executor/common/transaction_manager.h"
 #include "platform/common/queue/lock_free_queue.h"
 #include "platform/config/resdb_config.h"
+#include "platform/consensus/ordering/pbft/adaptive_controller.h"
 #include "platform/consensus/ordering/pbft/checkpoint_manager.h"
 #include "platform/consensus/ordering/pbft/lock_free_collector_pool.h"
+#include "platform/consensus/ordering/pbft/prepared_certificate_store.h"
 #include "platform/consensus/ordering/pbft/transaction_collector.h"
 #include "platform/consensus/ordering/pbft/transaction_utils.h"
 #include "platform/networkstrate/server_comm.h"
 #include "platform/proto/checkpoint_info.pb.h"
 #include "platform/proto/resdb.pb.h"
+#include "platform/statistic/seq_tracer.h"
 #include "platform/statistic/stats.h"
 
 namespace resdb {
@@ -84,10 +87,16 @@ class MessageManager {
   // Get the transactions that have been execuited.
   Request* GetRequest(uint64_t seq);
 
+  // Get the chunk `index` of the state kept at the checkpoint seq.
+  std::unique_ptr<StateChunk> GetStateChunk(uint64_t seq, uint32_t index);
+
   // Get the proof info containing the request and signatures
   // if the request has been prepared, having received 2f+1
   // pre-prepare messages.
   std::vector<RequestInfo> GetPreparedProof(uint64_t seq);
+  // The certificates of the prepared seqs above the stable checkpoint,
+  // kept only if view change is enabled.
+  PreparedCertificateStore* GetPreparedCertificateStore();
   TransactionStatue GetTransactionState(uint64_t seq);
 
   // =============  System information ========
@@ -95,6 +104,7 @@ class MessageManager {
   std::vector<ReplicaInfo> GetReplicas();
 
   uint64_t GetCurrentView() const;
+  uint64_t GetStableCheckpoint();
 
   // Replica State
   int GetReplicaState(ReplicaState* state);
@@ -118,6 +128,10 @@ class MessageManager {
 
   LockFreeCollectorPool* GetCollectorPool();
 
+  // The number of sequences allowed in flight. It is GetMaxProcessTxn()
+  // unless the adaptive window is enabled.
+  uint32_t GetWindowSize() const;
+
  private:
   bool IsValidMsg(const Request& request);
 
@@ -125,6 +139,13 @@ class MessageManager {
                                 std::atomic<TransactionStatue>* status,
                                 bool force);
 
+  // Feed the latency from assigning the seq to executing it to the
+  // adaptive controller.
+  void AddCommitLatency(uint64_t seq);
+
+  // Record the latency of the consensus phase of seq ending now.
+  void AddPhaseLatency(uint64_t seq, LatencyName name);
+
  private:
   ResDBConfig config_;
   uint64_t next_seq_ = 1;
@@ -138,10 +159,19 @@ class MessageManager {
   std::map<uint64_t, Request> committed_data_;
 
   std::mutex data_mutex_, seq_mutex_;
+  std::unique_ptr<AdaptiveController> adaptive_controller_;
+  // The time each in-flight seq was assigned, indexed by seq % its size.
+  std::unique_ptr<std::atomic<uint64_t>[]> assign_time_;
+  uint32_t assign_time_size_ = 0;
+  // The time each in-flight seq entered its current consensus phase, indexed
+  // the same way.
+  std::unique_ptr<std::atomic<uint64_t>[]> phase_time_;
   std::unique_ptr<TransactionExecutor> transaction_executor_;
   std::unique_ptr<LockFreeCollectorPool> collector_pool_;
+  PreparedCertificateStore prepared_certs_;
 
   Stats* global_stats_;
+  SeqTracer* tracer_;
 
   std::mutex lct_lock_;
   std::map<uint64_t, uint64_t> last_committed_time_;
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/payload_codec.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "common/crypto/signature_verifier.h"
+
+namespace resdb {
+
+namespace {
+// The combinations of chunks tried for each chunk received, which bounds the
+// cost of the bad chunks.
+constexpr int kMaxRebuildAttempts = 16;
+}  // namespace
+
+PayloadCodec::PayloadCodec(const ResDBConfig& config)
+    : min_bytes_(config.GetErasureCodedPayloadMinBytes()),
+      codec_(config.GetMinClientReceiveNum(),
+             std::max<int>(config.GetReplicaInfos().size(),
+                           config.GetMinClientReceiveNum())),
+      capacity_(config.GetMaxProcessTxn() * 4) {
+  for (const auto& replica : config.GetReplicaInfos()) {
+    replica_ids_.push_back(replica.id());
+  }
+}
+
+bool PayloadCodec::NeedEncode(const Request& payload) const {
+  return payload.data().size() >= min_bytes_ && replica_ids_.size() > 1;
+}
+
+int PayloadCodec::GetChunkIndex(int64_t replica_id) const {
+  for (size_t i = 0; i < replica_ids_.size(); ++i) {
+    if (replica_ids_[i] == replica_id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+std::map<int64_t, Request> PayloadCodec::Encode(const Request& payload) const {
+  std::map<int64_t, Request> chunk_requests;
+  std::vector<std::string> chunks = codec_.Encode(payload.data());
+  for (size_t i = 0; i < replica_ids_.size(); ++i) {
+    PayloadChunk chunk;
+    chunk.set_index(i);
+    chunk.set_data(std::move(chunks[i]));
+    *chunk.mutable_data_signature() = payload.data_signature();
+
+    Request& request = chunk_requests[replica_ids_[i]];
+    request.set_type(Request::TYPE_PAYLOAD_CHUNK);
+    request.set_hash(payload.hash());
+    request.set_sender_id(payload.sender_id());
+    request.set_proxy_id(payload.proxy_id());
+    chunk.SerializeToString(request.mutable_data());
+  }
+  return chunk_requests;
+}
+
+std::unique_ptr<Request> PayloadCodec::AddChunk(const Request& chunk_request,
+                                               bool from_proxy) {
+  PayloadChunk chunk;
+  if (!chunk.ParseFromString(chunk_request.data())) {
+    LOG(ERROR) << "parse payload chunk fail";
+    return nullptr;
+  }
+  if (chunk.index() >= static_cast<uint32_t>(codec_.TotalShards())) {
+    LOG(ERROR) << "invalid chunk index:" << chunk.index();
+    return nullptr;
+  }
+
+  int index = chunk.index();
+  std::map<int, std::string> chunks;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = partial_.find(chunk_request.hash());
+    if (it == partial_.end()) {
+      it = partial_.insert({chunk_request.hash(), PartialPayload()}).first;
+      partial_order_.push_back(chunk_request.hash());
+      while (partial_order_.size() > capacity_) {
+        partial_.erase(partial_order_.front());
+        partial_order_.pop_front();
+      }
+    }
+    PartialPayload& partial = it->second;
+    if (partial.decoded) {
+      return nullptr;
+    }
+    // The fields outside the coded data are only trusted from the proxy,
+    // since a forwarder can rewrite them in its copy.
+    if (from_proxy && !partial.from_proxy) {
+      partial.from_proxy = true;
+      partial.data_signature = chunk.data_signature();
+      partial.proxy_id = chunk_request.proxy_id();
+      if (partial.rebuilt) {
+        return TakePayload(chunk_request.hash(), &partial);
+      }
+    }
+    if (partial.rebuilt ||
+        !partial.chunks.emplace(index, std::move(*chunk.mutable_data()))
+             .second) {
+      return nullptr;
+    }
+    if (partial.chunks.size() < static_cast<size_t>(codec_.DataShards())) {
+      return nullptr;
+    }
+    chunks = partial.chunks;
+  }
+
+  std::unique_ptr<std::string> data =
+      Rebuild(chunk_request.hash(), index, chunks);
+  if (data == nullptr) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = partial_.find(chunk_request.hash());
+  if (it == partial_.end() || it->second.decoded || it->second.rebuilt) {
+    return nullptr;
+  }
+  PartialPayload& partial = it->second;
+  partial.rebuilt = true;
+  partial.chunks.clear();
+  partial.data = std::move(*data);
+  if (!partial.from_proxy) {
+    // Wait for the chunk of the proxy to fill the data signature.
+    return nullptr;
+  }
+  return TakePayload(chunk_request.hash(), &partial);
+}
+
+std::unique_ptr<Request> PayloadCodec::TakePayload(const std::string& hash,
+                                                   PartialPayload* partial) {
+  partial->decoded = true;
+  auto payload = std::make_unique<Request>();
+  payload->set_type(Request::TYPE_PAYLOAD);
+  payload->set_hash(hash);
+  payload->set_proxy_id(partial->proxy_id);
+  *payload->mutable_data_signature() = partial->data_signature;
+  payload->set_data(std::move(partial->data));
+  partial->data.clear();
+  return payload;
+}
+
+std::unique_ptr<std::string> PayloadCodec::Rebuild(
+    const std::string& hash, int index,
+    const std::map<int, std::string>& chunks) const {
+  const std::string& chunk = chunks.at(index);
+  // The chunks of a payload have the same size.
+  std::vector<int> others;
+  for (const auto& it : chunks) {
+    if (it.first != index && it.second.size() == chunk.size()) {
+      others.push_back(it.first);
+    }
+  }
+  size_t num = codec_.DataShards() - 1;
+  if (others.size() < num) {
+    return nullptr;
+  }
+
+  // Walk the combinations of `num` chunks out of the others, with pos
+  // holding their positions in increasing order.
+  std::vector<size_t> pos(num);
+  for (size_t i = 0; i < num; ++i) {
+    pos[i] = i;
+  }
+  for (int attempt = 0; attempt < kMaxRebuildAttempts; ++attempt) {
+    std::map<int, std::string> shards;
+    shards[index] = chunk;
+    for (size_t p : pos) {
+      shards[others[p]] = chunks.at(others[p]);
+    }
+    absl::StatusOr<std::string> data = codec_.Decode(shards);
+    if (data.ok() && SignatureVerifier::CalculateHash(*data) == hash) {
+      return std::make_unique<std::string>(std::move(*data));
+    }
+
+    int i = static_cast<int>(num) - 1;
+    while (i >= 0 && pos[i] == others.size() - num + i) {
+      --i;
+    }
+    if (i < 0) {
+      break;
+    }
+    ++pos[i];
+    for (size_t j = i + 1; j < num; ++j) {
+      pos[j] = pos[j - 1] + 1;
+    }
+  }
+  LOG(ERROR) << "rebuild payload fail, chunk:" << index
+             << " chunks received:" << chunks.size();
+  return nullptr;
+}
+
+}  // namespace resdb
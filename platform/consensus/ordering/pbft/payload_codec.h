@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/utils/reed_solomon.h"
+#include "platform/config/resdb_config.h"
+#include "platform/proto/resdb.pb.h"
+
+namespace resdb {
+
+// PayloadCodec splits a payload into one erasure-coded chunk per replica,
+// any f+1 of which rebuild the payload, and assembles the chunks received.
+// Chunk i belongs to the i-th replica in the config, which forwards it to
+// the others.
+class PayloadCodec {
+ public:
+  PayloadCodec(const ResDBConfig& config);
+
+  // Whether the payload is large enough to be sent as chunks.
+  bool NeedEncode(const Request& payload) const;
+
+  // Split a TYPE_PAYLOAD request into TYPE_PAYLOAD_CHUNK requests keyed by
+  // the replica each chunk belongs to.
+  std::map<int64_t, Request> Encode(const Request& payload) const;
+
+  // The index of the chunk owned by the replica, or -1 if it is unknown.
+  int GetChunkIndex(int64_t replica_id) const;
+
+  // Add a chunk, from_proxy telling whether it is signed by the proxy rather
+  // than forwarded. Return the TYPE_PAYLOAD request once enough chunks of
+  // the payload rebuild data matching its hash and the chunk of the proxy
+  // has provided the data signature and the proxy id. A bad chunk only
+  // fails the rebuilds it takes part in, and the chunks keep being collected
+  // until a rebuild succeeds. The payload is returned once.
+  std::unique_ptr<Request> AddChunk(const Request& chunk_request,
+                                    bool from_proxy);
+
+ private:
+  struct PartialPayload {
+    std::map<int, std::string> chunks;
+    SignatureInfo data_signature;
+    int64_t proxy_id = 0;
+    bool from_proxy = false;
+    // The data is rebuilt and waits for the chunk of the proxy.
+    bool rebuilt = false;
+    std::string data;
+    bool decoded = false;
+  };
+
+  // Called with mutex_ held. Return the rebuilt payload and mark it decoded.
+  std::unique_ptr<Request> TakePayload(const std::string& hash,
+                                       PartialPayload* partial);
+
+  // Rebuild the data from the new chunk and DataShards() - 1 of the others,
+  // trying the combinations until the data matches the hash.
+  std::unique_ptr<std::string> Rebuild(
+      const std::string& hash, int index,
+      const std::map<int, std::string>& chunks) const;
+
+  std::vector<int64_t> replica_ids_;
+  uint32_t min_bytes_;
+  ReedSolomon codec_;
+  size_t capacity_;
+
+  std::mutex mutex_;
+  std::map<std::string, PartialPayload> partial_;
+  std::deque<std::string> partial_order_;
+};
+
+}  // namespace resdb
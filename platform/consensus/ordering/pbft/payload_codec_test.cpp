@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/payload_codec.h"
+
+#include <gtest/gtest.h>
+
+#include "common/crypto/signature_verifier.h"
+#include "platform/config/resdb_config_utils.h"
+
+namespace resdb {
+namespace {
+
+ResDBConfig GenerateConfig() {
+  ResConfigData data;
+  data.set_erasure_coded_payload_min_bytes(100);
+  return ResDBConfig({GenerateReplicaInfo(1, "127.0.0.1", 1234),
+                      GenerateReplicaInfo(2, "127.0.0.1", 1235),
+                      GenerateReplicaInfo(3, "127.0.0.1", 1236),
+                      GenerateReplicaInfo(4, "127.0.0.1", 1237)},
+                     GenerateReplicaInfo(1, "127.0.0.1", 1234), data);
+}
+
+Request GetPayload(size_t size) {
+  Request payload;
+  payload.set_type(Request::TYPE_PAYLOAD);
+  payload.set_data(std::string(size, 'a'));
+  payload.set_hash(SignatureVerifier::CalculateHash(payload.data()));
+  payload.set_proxy_id(2);
+  payload.set_sender_id(2);
+  payload.mutable_data_signature()->set_signature("sig");
+  return payload;
+}
+
+TEST(PayloadCodecTest, EncodeLargePayload) {
+  PayloadCodec codec(GenerateConfig());
+  EXPECT_FALSE(codec.NeedEncode(GetPayload(10)));
+  EXPECT_TRUE(codec.NeedEncode(GetPayload(1000)));
+  EXPECT_EQ(codec.GetChunkIndex(3), 2);
+  EXPECT_EQ(codec.GetChunkIndex(5), -1);
+}
+
+TEST(PayloadCodecTest, RebuildFromFPlusOneChunks) {
+  PayloadCodec codec(GenerateConfig());
+  Request payload = GetPayload(1000);
+  std::map<int64_t, Request> chunks = codec.Encode(payload);
+  ASSERT_EQ(chunks.size(), 4);
+  for (const auto& it : chunks) {
+    EXPECT_EQ(it.second.type(), Request::TYPE_PAYLOAD_CHUNK);
+    EXPECT_EQ(it.second.hash(), payload.hash());
+    EXPECT_LT(it.second.data().size(), payload.data().size());
+  }
+
+  EXPECT_EQ(codec.AddChunk(chunks[4], /*from_proxy=*/false), nullptr);
+  std::unique_ptr<Request> ret =
+      codec.AddChunk(chunks[1], /*from_proxy=*/true);
+  ASSERT_NE(ret, nullptr);
+  EXPECT_EQ(ret->type(), Request::TYPE_PAYLOAD);
+  EXPECT_EQ(ret->data(), payload.data());
+  EXPECT_EQ(ret->hash(), payload.hash());
+  EXPECT_EQ(ret->proxy_id(), 2);
+  EXPECT_EQ(ret->data_signature().signature(), "sig");
+
+  // The payload is only rebuilt once.
+  EXPECT_EQ(codec.AddChunk(chunks[3], /*from_proxy=*/false), nullptr);
+}
+
+TEST(PayloadCodecTest, SignatureFromProxyChunk) {
+  PayloadCodec codec(GenerateConfig());
+  Request payload = GetPayload(1000);
+  std::map<int64_t, Request> chunks = codec.Encode(payload);
+
+  // A forwarder rewrites the fields outside the coded data.
+  PayloadChunk chunk;
+  ASSERT_TRUE(chunk.ParseFromString(chunks[3].data()));
+  chunk.mutable_data_signature()->set_signature("forged");
+  chunk.SerializeToString(chunks[3].mutable_data());
+  chunks[3].set_proxy_id(3);
+
+  // The data is rebuilt from the forwarded chunks but is only returned once
+  // the chunk of the proxy arrives.
+  EXPECT_EQ(codec.AddChunk(chunks[3], /*from_proxy=*/false), nullptr);
+  EXPECT_EQ(codec.AddChunk(chunks[4], /*from_proxy=*/false), nullptr);
+  std::unique_ptr<Request> ret =
+      codec.AddChunk(chunks[1], /*from_proxy=*/true);
+  ASSERT_NE(ret, nullptr);
+  EXPECT_EQ(ret->data(), payload.data());
+  EXPECT_EQ(ret->proxy_id(), 2);
+  EXPECT_EQ(ret->data_signature().signature(), "sig");
+
+  EXPECT_EQ(codec.AddChunk(chunks[2], /*from_proxy=*/false), nullptr);
+}
+
+TEST(PayloadCodecTest, SkipBadChunk) {
+  PayloadCodec codec(GenerateConfig());
+  Request payload = GetPayload(1000);
+  std::map<int64_t, Request> chunks = codec.Encode(payload);
+
+  // A forwarder corrupts its chunk. The rebuild with it fails and the good
+  // chunks received later still rebuild the payload.
+  PayloadChunk chunk;
+  ASSERT_TRUE(chunk.ParseFromString(chunks[3].data()));
+  (*chunk.mutable_data())[10] ^= 1;
+  chunk.SerializeToString(chunks[3].mutable_data());
+
+  EXPECT_EQ(codec.AddChunk(chunks[3], /*from_proxy=*/false), nullptr);
+  EXPECT_EQ(codec.AddChunk(chunks[4], /*from_proxy=*/false), nullptr);
+  std::unique_ptr<Request> ret =
+      codec.AddChunk(chunks[1], /*from_proxy=*/true);
+  ASSERT_NE(ret, nullptr);
+  EXPECT_EQ(ret->data(), payload.data());
+}
+
+TEST(PayloadCodecTest, InvalidChunk) {
+  PayloadCodec codec(GenerateConfig());
+  Request request;
+  request.set_type(Request::TYPE_PAYLOAD_CHUNK);
+  request.set_data("invalid chunk");
+  EXPECT_EQ(codec.AddChunk(request, /*from_proxy=*/false), nullptr);
+
+  PayloadChunk chunk;
+  chunk.set_index(10);
+  chunk.SerializeToString(request.mutable_data());
+  EXPECT_EQ(codec.AddChunk(request, /*from_proxy=*/false), nullptr);
+}
+
+}  // namespace
+}  // namespace resdb
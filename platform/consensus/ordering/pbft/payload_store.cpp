@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/payload_store.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace resdb {
+
+namespace {
+// The interval before fetching a missing payload again, doubled on each
+// attempt up to kMaxFetchBackoffShift times.
+constexpr std::chrono::milliseconds kFetchRetryInterval(20);
+constexpr uint32_t kMaxFetchBackoffShift = 6;
+}  // namespace
+
+PayloadStore::PayloadStore(size_t capacity) : capacity_(capacity) {}
+
+std::vector<PayloadStore::Proposal> PayloadStore::AddPayload(
+    const Request& payload) {
+  std::vector<Proposal> ready;
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (payloads_.find(payload.hash()) == payloads_.end()) {
+    Request& data = payloads_[payload.hash()];
+    data.set_hash(payload.hash());
+    data.set_data(payload.data());
+    *data.mutable_data_signature() = payload.data_signature();
+    payload_order_.push_back(payload.hash());
+    while (payload_order_.size() > capacity_) {
+      payloads_.erase(payload_order_.front());
+      payload_order_.pop_front();
+    }
+  }
+
+  auto it = waiting_.find(payload.hash());
+  if (it != waiting_.end()) {
+    ready = std::move(it->second.proposals);
+    waiting_.erase(it);
+    waiting_num_ -= ready.size();
+  }
+  return ready;
+}
+
+std::unique_ptr<Request> PayloadStore::GetPayload(const std::string& hash) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = payloads_.find(hash);
+  if (it == payloads_.end()) {
+    return nullptr;
+  }
+  return std::make_unique<Request>(it->second);
+}
+
+PayloadStore::FillResult PayloadStore::FillProposal(Proposal* proposal) {
+  Request* request = proposal->request.get();
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = payloads_.find(request->hash());
+  if (it != payloads_.end()) {
+    request->set_data(it->second.data());
+    *request->mutable_data_signature() = it->second.data_signature();
+    return FillResult::FILLED;
+  }
+  if (waiting_num_ >= capacity_) {
+    LOG(ERROR) << "too many proposals waiting for payloads, drop seq:"
+               << request->seq();
+    return FillResult::DROPPED;
+  }
+  Waiting& waiting = waiting_[request->hash()];
+  if (waiting.proposals.empty()) {
+    waiting.start_time = std::chrono::steady_clock::now();
+  }
+  waiting.proposals.push_back(std::move(*proposal));
+  waiting_num_++;
+  return FillResult::WAITING;
+}
+
+std::vector<PayloadStore::FetchTarget> PayloadStore::GetFetchTargets(
+    std::chrono::milliseconds delay) {
+  std::vector<FetchTarget> targets;
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (auto& it : waiting_) {
+    Waiting& waiting = it.second;
+    if (waiting.fetch_num == 0 ? now - waiting.start_time < delay
+                               : now < waiting.next_fetch_time) {
+      continue;
+    }
+    const Request& request = *waiting.proposals.front().request;
+    targets.push_back(
+        {it.first, request.seq(), request.sender_id(), waiting.fetch_num});
+    waiting.next_fetch_time =
+        now + kFetchRetryInterval *
+                  (1 << std::min(waiting.fetch_num, kMaxFetchBackoffShift));
+    waiting.fetch_num++;
+  }
+  return targets;
+}
+
+size_t PayloadStore::ExpireWaiting(uint64_t stable_seq, uint64_t view) {
+  size_t expired_num = 0;
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (auto it = waiting_.begin(); it != waiting_.end();) {
+    std::vector<Proposal>& proposals = it->second.proposals;
+    size_t size = proposals.size();
+    proposals.erase(
+        std::remove_if(proposals.begin(), proposals.end(),
+                       [&](const Proposal& proposal) {
+                         return proposal.request->seq() <= stable_seq ||
+                                proposal.request->current_view() < view;
+                       }),
+        proposals.end());
+    expired_num += size - proposals.size();
+    if (proposals.empty()) {
+      it = waiting_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  waiting_num_ -= expired_num;
+  return expired_num;
+}
+
+size_t PayloadStore::Size() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return payloads_.size();
+}
+
+size_t PayloadStore::WaitingSize() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return waiting_num_;
+}
+
+}  // namespace resdb
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform/networkstrate/server_comm.h"
+#include "platform/proto/resdb.pb.h"
+
+namespace resdb {
+
+// PayloadStore keeps the payloads disseminated by the proxies before the
+// primary proposes their digests, so that a PrePrepare message only carries
+// the hash of the batch. The oldest payloads are dropped once there are more
+// than `capacity`. PrePrepare messages whose payload has not arrived are kept
+// until it does, and the payload can be fetched if it takes too long. The
+// fetch is retried with a backoff until the payload arrives or the proposals
+// expire.
+class PayloadStore {
+ public:
+  struct Proposal {
+    std::unique_ptr<Context> context;
+    std::unique_ptr<Request> request;
+  };
+
+  enum class FillResult {
+    FILLED = 0,
+    // The payload is missing and the proposal is kept.
+    WAITING = 1,
+    // The payload is missing and there are too many proposals waiting.
+    DROPPED = 2,
+  };
+
+  // A missing payload to fetch. The first attempt goes to the sender of its
+  // proposal, the retries to the other replicas.
+  struct FetchTarget {
+    std::string hash;
+    uint64_t seq;
+    int64_t sender_id;
+    uint32_t attempt;
+  };
+
+  explicit PayloadStore(size_t capacity);
+
+  // Save the payload and return the proposals waiting for it.
+  std::vector<Proposal> AddPayload(const Request& payload);
+
+  // Return a copy of the payload with the hash, or nullptr if not found.
+  std::unique_ptr<Request> GetPayload(const std::string& hash);
+
+  // Fill the data and the data signature of the proposal from its payload.
+  // If the payload is missing, the proposal is moved into the store and will
+  // be returned by AddPayload().
+  FillResult FillProposal(Proposal* proposal);
+
+  // Return the missing payloads that proposals have waited for longer than
+  // `delay`. A payload is returned again if it is still missing after the
+  // retry interval, which doubles on each attempt.
+  std::vector<FetchTarget> GetFetchTargets(std::chrono::milliseconds delay);
+
+  // Drop the waiting proposals at or below the stable checkpoint, which no
+  // longer need to be executed, and those of the views before `view`, which
+  // will be proposed again. Return the number of proposals dropped.
+  size_t ExpireWaiting(uint64_t stable_seq, uint64_t view);
+
+  size_t Size();
+  size_t WaitingSize();
+
+ private:
+  size_t capacity_;
+  std::mutex mutex_;
+  std::map<std::string, Request> payloads_;
+  std::deque<std::string> payload_order_;
+  struct Waiting {
+    std::vector<Proposal> proposals;
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point next_fetch_time;
+    uint32_t fetch_num = 0;
+  };
+  std::map<std::string, Waiting> waiting_;
+  // The number of proposals in waiting_, which is bounded by capacity_.
+  size_t waiting_num_ = 0;
+};
+
+}  // namespace resdb
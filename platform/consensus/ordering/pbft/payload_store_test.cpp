@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/payload_store.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace resdb {
+namespace {
+
+Request GetPayload(const std::string& hash) {
+  Request payload;
+  payload.set_hash(hash);
+  payload.set_data("data_" + hash);
+  payload.mutable_data_signature()->set_signature("sig_" + hash);
+  return payload;
+}
+
+PayloadStore::Proposal GetProposal(const std::string& hash, uint64_t seq) {
+  PayloadStore::Proposal proposal;
+  proposal.context = std::make_unique<Context>();
+  proposal.request = std::make_unique<Request>();
+  proposal.request->set_type(Request::TYPE_PRE_PREPARE);
+  proposal.request->set_hash(hash);
+  proposal.request->set_seq(seq);
+  return proposal;
+}
+
+TEST(PayloadStoreTest, FillFromPayload) {
+  PayloadStore store(10);
+  EXPECT_TRUE(store.AddPayload(GetPayload("h1")).empty());
+
+  PayloadStore::Proposal proposal = GetProposal("h1", 1);
+  EXPECT_EQ(store.FillProposal(&proposal), PayloadStore::FillResult::FILLED);
+  EXPECT_EQ(proposal.request->data(), "data_h1");
+  EXPECT_EQ(proposal.request->data_signature().signature(), "sig_h1");
+  EXPECT_EQ(proposal.request->seq(), 1);
+
+  std::unique_ptr<Request> payload = store.GetPayload("h1");
+  ASSERT_NE(payload, nullptr);
+  EXPECT_EQ(payload->data(), "data_h1");
+  EXPECT_EQ(store.GetPayload("h2"), nullptr);
+}
+
+TEST(PayloadStoreTest, WaitForPayload) {
+  PayloadStore store(10);
+
+  PayloadStore::Proposal proposal1 = GetProposal("h1", 1);
+  EXPECT_EQ(store.FillProposal(&proposal1),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_EQ(proposal1.request, nullptr);
+  PayloadStore::Proposal proposal2 = GetProposal("h1", 2);
+  EXPECT_EQ(store.FillProposal(&proposal2),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_EQ(store.WaitingSize(), 2);
+
+  std::vector<PayloadStore::Proposal> ready =
+      store.AddPayload(GetPayload("h1"));
+  ASSERT_EQ(ready.size(), 2);
+  EXPECT_EQ(ready[0].request->seq(), 1);
+  EXPECT_EQ(ready[1].request->seq(), 2);
+  EXPECT_EQ(store.WaitingSize(), 0);
+
+  EXPECT_EQ(store.FillProposal(&ready[0]), PayloadStore::FillResult::FILLED);
+  EXPECT_EQ(ready[0].request->data(), "data_h1");
+}
+
+TEST(PayloadStoreTest, DropOldPayloads) {
+  PayloadStore store(2);
+  store.AddPayload(GetPayload("h1"));
+  store.AddPayload(GetPayload("h2"));
+  store.AddPayload(GetPayload("h3"));
+  EXPECT_EQ(store.Size(), 2);
+  EXPECT_EQ(store.GetPayload("h1"), nullptr);
+  EXPECT_NE(store.GetPayload("h3"), nullptr);
+
+  PayloadStore::Proposal proposal1 = GetProposal("h4", 1);
+  PayloadStore::Proposal proposal2 = GetProposal("h5", 2);
+  PayloadStore::Proposal proposal3 = GetProposal("h6", 3);
+  EXPECT_EQ(store.FillProposal(&proposal1),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_EQ(store.FillProposal(&proposal2),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_EQ(store.FillProposal(&proposal3),
+            PayloadStore::FillResult::DROPPED);
+  EXPECT_NE(proposal3.request, nullptr);
+}
+
+TEST(PayloadStoreTest, FetchAfterDelay) {
+  PayloadStore store(10);
+  PayloadStore::Proposal proposal1 = GetProposal("h1", 1);
+  proposal1.request->set_sender_id(3);
+  PayloadStore::Proposal proposal2 = GetProposal("h1", 2);
+  store.FillProposal(&proposal1);
+  store.FillProposal(&proposal2);
+
+  EXPECT_TRUE(store.GetFetchTargets(std::chrono::seconds(10)).empty());
+  std::vector<PayloadStore::FetchTarget> targets =
+      store.GetFetchTargets(std::chrono::milliseconds(0));
+  ASSERT_EQ(targets.size(), 1);
+  EXPECT_EQ(targets[0].hash, "h1");
+  EXPECT_EQ(targets[0].seq, 1);
+  EXPECT_EQ(targets[0].sender_id, 3);
+  EXPECT_EQ(targets[0].attempt, 0);
+  // Not fetched again before the retry interval.
+  EXPECT_TRUE(store.GetFetchTargets(std::chrono::milliseconds(0)).empty());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  targets = store.GetFetchTargets(std::chrono::milliseconds(0));
+  ASSERT_EQ(targets.size(), 1);
+  EXPECT_EQ(targets[0].attempt, 1);
+  // The interval doubles.
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  EXPECT_TRUE(store.GetFetchTargets(std::chrono::milliseconds(0)).empty());
+
+  EXPECT_EQ(store.AddPayload(GetPayload("h1")).size(), 2);
+  EXPECT_TRUE(store.GetFetchTargets(std::chrono::milliseconds(0)).empty());
+}
+
+TEST(PayloadStoreTest, ExpireWaiting) {
+  PayloadStore store(3);
+  PayloadStore::Proposal proposal1 = GetProposal("h1", 1);
+  PayloadStore::Proposal proposal2 = GetProposal("h1", 2);
+  PayloadStore::Proposal proposal3 = GetProposal("h2", 3);
+  proposal3.request->set_current_view(2);
+  EXPECT_EQ(store.FillProposal(&proposal1),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_EQ(store.FillProposal(&proposal2),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_EQ(store.FillProposal(&proposal3),
+            PayloadStore::FillResult::WAITING);
+  PayloadStore::Proposal proposal4 = GetProposal("h3", 4);
+  EXPECT_EQ(store.FillProposal(&proposal4),
+            PayloadStore::FillResult::DROPPED);
+
+  // Below the stable checkpoint.
+  EXPECT_EQ(store.ExpireWaiting(1, 0), 1);
+  EXPECT_EQ(store.WaitingSize(), 2);
+  // From an older view.
+  EXPECT_EQ(store.ExpireWaiting(1, 2), 1);
+  EXPECT_EQ(store.WaitingSize(), 1);
+
+  // The expired proposals free the room for new ones.
+  EXPECT_EQ(store.FillProposal(&proposal4),
+            PayloadStore::FillResult::WAITING);
+  EXPECT_TRUE(store.AddPayload(GetPayload("h1")).empty());
+  EXPECT_EQ(store.AddPayload(GetPayload("h2")).size(), 1);
+}
+
+}  // namespace
+}  // namespace resdb
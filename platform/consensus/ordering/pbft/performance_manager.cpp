@@ -54,14 +54,20 @@ PerformanceManager::PerformanceManager(
     : config_(config),
       replica_communicator_(replica_communicator),
       collector_pool_(std::make_unique<LockFreeCollectorPool>(
-          "response", config_.GetMaxProcessTxn(), nullptr)),
+          "response", config_.GetMaxProcessTxn(), nullptr,
+          /*enable_viewchange=*/false, config_.GetReplicaNum())),
       context_pool_(std::make_unique<LockFreeCollectorPool>(
           "context", config_.GetMaxProcessTxn(), nullptr)),
-      batch_queue_("user request"),
+      batch_queue_("user request", config_.GetMaxPendingLoadNum()),
       system_info_(system_info),
-      verifier_(verifier) {
+      verifier_(verifier),
+      load_generator_(std::make_unique<LoadGenerator>(config_)) {
   stop_ = false;
   eval_started_ = false;
+  if (config_.IsDigestPrePrepareEnabled() &&
+      config_.IsErasureCodedPayloadEnabled()) {
+    payload_codec_ = std::make_unique<PayloadCodec>(config_);
+  }
   eval_ready_future_ = eval_ready_promise_.get_future();
   if (config_.GetPublicKeyCertificateInfo()
           .public_key()
@@ -85,6 +91,7 @@ PerformanceManager::PerformanceManager(
 
 PerformanceManager::~PerformanceManager() {
   stop_ = true;
+  load_generator_->Stop();
   for (int i = 0; i < 16; ++i) {
     if (user_req_thread_[i].joinable()) {
       user_req_thread_[i].join();
@@ -113,15 +120,15 @@ int PerformanceManager::StartEval() {
     return 0;
   }
   eval_started_ = true;
-  for (int i = 0; i < 60000000000; ++i) {
-    std::unique_ptr<QueueItem> queue_item = std::make_unique<QueueItem>();
-    queue_item->context = nullptr;
-    queue_item->user_request = GenerateUserRequest();
-    batch_queue_.Push(std::move(queue_item));
-    if (i == 20000000) {
-      eval_ready_promise_.set_value(true);
-    }
-  }
+  load_generator_->Run(
+      [&](uint64_t intended_time) {
+        std::unique_ptr<QueueItem> queue_item = std::make_unique<QueueItem>();
+        queue_item->context = nullptr;
+        queue_item->user_request = GenerateUserRequest();
+        queue_item->intended_time = intended_time;
+        batch_queue_.Push(std::move(queue_item));
+      },
+      [&]() { eval_ready_promise_.set_value(true); });
   LOG(WARNING) << "start eval done";
   return 0;
 }
@@ -224,7 +231,13 @@ void PerformanceManager::SendResponseToClient(
     const BatchUserResponse& batch_response) {
   uint64_t create_time = batch_response.createtime();
   uint64_t local_id = batch_response.local_id();
-  if (create_time > 0) {
+  if (load_generator_->IsOpenLoop()) {
+    // Charge each request from the time it was meant to be sent. It also
+    // counts in the average client latency, like the closed loop.
+    for (uint64_t latency : load_generator_->FinishBatch(local_id)) {
+      global_stats_->AddLatency(latency);
+    }
+  } else if (create_time > 0) {
     uint64_t run_time = GetCurrentTime() - create_time;
     global_stats_->AddLatency(run_time);
   } else {
@@ -256,12 +269,10 @@ int PerformanceManager::BatchProposeMsg() {
       continue;
     }
     if (batch_req.size() < config_.ClientBatchNum()) {
-      std::unique_ptr<QueueItem> item =
-          batch_queue_.Pop(config_.ClientBatchWaitTimeMS());
-      if (item == nullptr) {
-        continue;
-      }
-      batch_req.push_back(std::move(item));
+      size_t num = batch_queue_.PopBatch(
+          &batch_req, config_.ClientBatchNum() - batch_req.size(),
+          config_.ClientBatchWaitTimeMS() * 1000);
+      load_generator_->Consume(num);
       if (batch_req.size() < config_.ClientBatchNum()) {
         continue;
       }
@@ -305,6 +316,7 @@ int PerformanceManager::DoBatch(
   }
 
   batch_request.set_createtime(GetCurrentTime());
+  batch_request.set_local_id(local_id_++);
   batch_request.SerializeToString(new_request->mutable_data());
   if (verifier_) {
     auto signature_or = verifier_->SignMessage(new_request->data());
@@ -318,11 +330,23 @@ int PerformanceManager::DoBatch(
   new_request->set_hash(SignatureVerifier::CalculateHash(new_request->data()));
   new_request->set_proxy_id(config_.GetSelfInfo().id());
 
+  if (load_generator_->IsOpenLoop()) {
+    std::vector<uint64_t> intended_times;
+    for (const auto& item : batch_req) {
+      intended_times.push_back(item->intended_time);
+    }
+    load_generator_->AddBatch(batch_request.local_id(),
+                              std::move(intended_times));
+  }
   replica_communicator_->SendMessage(*new_request, GetPrimary());
+  if (config_.IsDigestPrePrepareEnabled()) {
+    SendPayload(*new_request);
+  }
   global_stats_->BroadCastMsg();
   send_num_[GetPrimary()]++;
   if (total_num_++ == 1000000) {
     stop_ = true;
+    load_generator_->Stop();
     LOG(WARNING) << "total num is done:" << total_num_;
   }
   if (total_num_ % 10000 == 0) {
@@ -401,4 +425,24 @@ void PerformanceManager::MonitoringClientTimeOut() {
   }
 }
 
+// Send the batch to the replicas other than the primary, as a whole or as
+// erasure-coded chunks, so that the primary only needs to propose its digest.
+void PerformanceManager::SendPayload(const Request& request) {
+  Request payload(request);
+  payload.set_type(Request::TYPE_PAYLOAD);
+  if (payload_codec_ && payload_codec_->NeedEncode(payload)) {
+    for (const auto& it : payload_codec_->Encode(payload)) {
+      if (it.first != GetPrimary()) {
+        replica_communicator_->SendMessage(it.second, it.first);
+      }
+    }
+    return;
+  }
+  for (const auto& replica : config_.GetReplicaInfos()) {
+    if (replica.id() != GetPrimary()) {
+      replica_communicator_->SendMessage(payload, replica.id());
+    }
+  }
+}
+
 }  // namespace resdb
@@ -30,8 +30,11 @@
 #include <future>
 #include <queue>
 
+#include "platform/common/queue/mpmc_queue.h"
 #include "platform/config/resdb_config.h"
+#include "platform/consensus/ordering/common/load_generator.h"
 #include "platform/consensus/ordering/pbft/lock_free_collector_pool.h"
+#include "platform/consensus/ordering/pbft/payload_codec.h"
 #include "platform/consensus/ordering/pbft/transaction_utils.h"
 #include "platform/networkstrate/replica_communicator.h"
 #include "platform/statistic/stats.h"
@@ -75,12 +78,15 @@ class PerformanceManager {
   struct QueueItem {
     std::unique_ptr<Context> context;
     std::unique_ptr<Request> user_request;
+    // The time the request was meant to be sent in the open loop.
+    uint64_t intended_time = 0;
   };
   bool MayConsensusChangeStatus(int type, int received_count,
                                 std::atomic<TransactionStatue>* status);
   int DoBatch(const std::vector<std::unique_ptr<QueueItem>>& batch_req);
   int BatchProposeMsg();
   int GetPrimary();
+  void SendPayload(const Request& request);
   std::unique_ptr<Request> GenerateUserRequest();
 
   void AddWaitingResponseRequest(std::unique_ptr<Request> request);
@@ -94,22 +100,24 @@ class PerformanceManager {
   ResDBConfig config_;
   ReplicaCommunicator* replica_communicator_;
   std::unique_ptr<LockFreeCollectorPool> collector_pool_, context_pool_;
-  LockFreeQueue<QueueItem> batch_queue_;
+  MPMCQueue<std::unique_ptr<QueueItem>> batch_queue_;
   std::thread user_req_thread_[16];
   std::atomic<bool> stop_;
-  uint64_t local_id_ = 0;
+  std::atomic<uint64_t> local_id_ = 0;
   Stats* global_stats_;
   std::vector<int> send_num_;
   std::mutex mutex_;
   std::atomic<int> total_num_;
   SystemInfo* system_info_;
   SignatureVerifier* verifier_;
+  std::unique_ptr<PayloadCodec> payload_codec_;
   SignatureInfo sig_;
   std::function<std::string()> data_func_;
   std::future<bool> eval_ready_future_;
   std::promise<bool> eval_ready_promise_;
   std::atomic<bool> eval_started_;
   std::atomic<int> fail_num_;
+  std::unique_ptr<LoadGenerator> load_generator_;
 
   std::thread checking_timeout_thread_;
   std::map<std::string, std::unique_ptr<Request>> waiting_response_batches_;
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/prepared_certificate_store.h"
+
+#include <algorithm>
+
+namespace resdb {
+
+void PreparedCertificateStore::Add(uint64_t seq, const std::string& hash,
+                                   std::vector<RequestInfo> proof) {
+  if (seq <= stable_seq_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  Certificate& cert = certs_[seq];
+  cert.hash = hash;
+  cert.proof = std::move(proof);
+}
+
+std::vector<PreparedMessage> PreparedCertificateStore::Get(uint64_t min_seq,
+                                                           uint64_t max_seq) {
+  std::vector<PreparedMessage> certs;
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (auto it = certs_.upper_bound(std::max<uint64_t>(min_seq, stable_seq_));
+       it != certs_.end() && it->first <= max_seq; ++it) {
+    PreparedMessage message;
+    message.set_seq(it->first);
+    // The prepare messages are kept as they were signed.
+    for (const auto& info : it->second.proof) {
+      if (info.request->hash() != it->second.hash) {
+        continue;
+      }
+      auto prepared_proof = message.add_proof();
+      *prepared_proof->mutable_request() = *info.request;
+      *prepared_proof->mutable_signature() = info.signature;
+    }
+    certs.push_back(std::move(message));
+  }
+  return certs;
+}
+
+void PreparedCertificateStore::Prune(uint64_t stable_seq) {
+  uint64_t current = stable_seq_;
+  while (current < stable_seq &&
+         !stable_seq_.compare_exchange_weak(current, stable_seq)) {
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  certs_.erase(certs_.begin(), certs_.upper_bound(stable_seq_));
+}
+
+size_t PreparedCertificateStore::Size() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return certs_.size();
+}
+
+}  // namespace resdb
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform/consensus/ordering/pbft/transaction_collector.h"
+#include "platform/proto/viewchange_message.pb.h"
+
+namespace resdb {
+
+// PreparedCertificateStore keeps the prepare messages of each seq from the
+// moment it is prepared, so that a view change message only copies the
+// certificates above the stable checkpoint instead of collecting them.
+// Add() only moves the messages in; they are turned into a certificate when
+// a view change reads them.
+class PreparedCertificateStore {
+ public:
+  // Keep the prepare messages of seq with the hash, unless seq is not above
+  // the stable checkpoint.
+  void Add(uint64_t seq, const std::string& hash,
+           std::vector<RequestInfo> proof);
+
+  // Return the certificates in (min_seq, max_seq].
+  std::vector<PreparedMessage> Get(uint64_t min_seq, uint64_t max_seq);
+
+  // Drop the certificates up to the stable checkpoint seq.
+  void Prune(uint64_t stable_seq);
+
+  size_t Size();
+
+ private:
+  struct Certificate {
+    std::string hash;
+    std::vector<RequestInfo> proof;
+  };
+
+ private:
+  std::atomic<uint64_t> stable_seq_ = 0;
+  std::mutex mutex_;
+  std::map<uint64_t, Certificate> certs_;
+};
+
+}  // namespace resdb
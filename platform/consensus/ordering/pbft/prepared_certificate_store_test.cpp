@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/consensus/ordering/pbft/prepared_certificate_store.h"
+
+#include <gtest/gtest.h>
+
+namespace resdb {
+namespace {
+
+std::vector<RequestInfo> GetProof(uint64_t seq, int num,
+                                  const std::string& data) {
+  std::vector<RequestInfo> proof;
+  for (int i = 1; i <= num; ++i) {
+    RequestInfo info;
+    info.request = std::make_unique<Request>();
+    info.request->set_type(Request::TYPE_PREPARE);
+    info.request->set_seq(seq);
+    info.request->set_sender_id(i);
+    info.request->set_data(data);
+    info.request->set_hash("hash" + data);
+    info.signature.set_node_id(i);
+    info.signature.set_signature("sig" + std::to_string(i));
+    proof.push_back(std::move(info));
+  }
+  return proof;
+}
+
+TEST(PreparedCertificateStoreTest, KeepProofAsSigned) {
+  std::vector<RequestInfo> proof = GetProof(1, 3, "data");
+  RequestInfo other;
+  other.request = std::make_unique<Request>(*proof[0].request);
+  other.request->set_hash("other");
+  proof.push_back(std::move(other));
+  std::vector<std::string> requests;
+  for (const auto& info : proof) {
+    requests.push_back(info.request->SerializeAsString());
+  }
+
+  PreparedCertificateStore store;
+  store.Add(1, "hashdata", std::move(proof));
+  std::vector<PreparedMessage> certs = store.Get(0, 1);
+  ASSERT_EQ(certs.size(), 1);
+  EXPECT_EQ(certs[0].seq(), 1);
+  // The prepare message with another hash is not in the certificate.
+  ASSERT_EQ(certs[0].proof_size(), 3);
+  for (int i = 0; i < certs[0].proof_size(); ++i) {
+    EXPECT_EQ(certs[0].proof(i).request().SerializeAsString(), requests[i]);
+    EXPECT_EQ(certs[0].proof(i).signature().node_id(), i + 1);
+  }
+}
+
+TEST(PreparedCertificateStoreTest, GetAndPrune) {
+  PreparedCertificateStore store;
+  for (int seq = 1; seq <= 5; ++seq) {
+    store.Add(seq, "hashdata", GetProof(seq, 3, "data"));
+  }
+  EXPECT_EQ(store.Size(), 5);
+
+  std::vector<PreparedMessage> certs = store.Get(2, 4);
+  ASSERT_EQ(certs.size(), 2);
+  EXPECT_EQ(certs[0].seq(), 3);
+  EXPECT_EQ(certs[1].seq(), 4);
+
+  store.Prune(3);
+  EXPECT_EQ(store.Size(), 2);
+  EXPECT_EQ(store.Get(0, 10)[0].seq(), 4);
+
+  // Seqs up to the stable checkpoint are not kept any more.
+  store.Add(2, "hashdata", GetProof(2, 3, "data"));
+  EXPECT_EQ(store.Size(), 2);
+  store.Prune(1);
+  EXPECT_EQ(store.Get(0, 10)[0].seq(), 4);
+}
+
+}  // namespace
+}  // namespace resdb
@@ -110,4 +110,28 @@ int Query::ProcessCustomQuery(std::unique_ptr<Context> context,
   return 0;
 }
 
+int Query::ProcessStateQuery(std::unique_ptr<Context> context,
+                             std::unique_ptr<Request> request) {
+  StateChunkRequest query;
+  if (!query.ParseFromString(request->data())) {
+    LOG(ERROR) << "parse data fail";
+    return -2;
+  }
+
+  // An empty chunk is returned if the state at seq is not kept.
+  std::unique_ptr<StateChunk> chunk =
+      message_manager_->GetStateChunk(query.seq(), query.index());
+  if (chunk == nullptr) {
+    chunk = std::make_unique<StateChunk>();
+  }
+
+  if (context != nullptr && context->client != nullptr) {
+    int ret = context->client->SendRawMessage(*chunk);
+    if (ret) {
+      LOG(ERROR) << "send resp fail ret:" << ret;
+    }
+  }
+  return 0;
+}
+
 }  // namespace resdb
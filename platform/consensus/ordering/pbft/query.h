@@ -45,6 +45,9 @@ class Query {
   virtual int ProcessCustomQuery(std::unique_ptr<Context> context,
                                  std::unique_ptr<Request> request);
 
+  virtual int ProcessStateQuery(std::unique_ptr<Context> context,
+                                std::unique_ptr<Request> request);
+
  protected:
   ResDBConfig config_;
   MessageManager* message_manager_;
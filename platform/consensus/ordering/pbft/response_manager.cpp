@@ -37,7 +37,8 @@ ResponseManager::ResponseManager(const ResDBConfig& config,
     : config_(config),
       replica_communicator_(replica_communicator),
       collector_pool_(std::make_unique<LockFreeCollectorPool>(
-          "response", config_.GetMaxProcessTxn(), nullptr)),
+          "response", config_.GetMaxProcessTxn(), nullptr,
+          /*enable_viewchange=*/false, config_.GetReplicaNum())),
       context_pool_(std::make_unique<LockFreeCollectorPool>(
           "context", config_.GetMaxProcessTxn(), nullptr)),
       batch_queue_("user request"),
@@ -45,6 +46,17 @@ ResponseManager::ResponseManager(const ResDBConfig& config,
       verifier_(verifier) {
   stop_ = false;
   local_id_ = 1;
+  queue_depth_ = 0;
+  if (config_.IsDigestPrePrepareEnabled() &&
+      config_.IsErasureCodedPayloadEnabled()) {
+    payload_codec_ = std::make_unique<PayloadCodec>(config_);
+  }
+  if (config_.IsAdaptiveWindowEnabled()) {
+    adaptive_controller_ = std::make_unique<AdaptiveController>(
+        config_.GetMinProcessTxn(), config_.GetMaxProcessTxn(),
+        config_.GetMinClientBatchNum(), config_.GetMaxClientBatchNum(),
+        config_.GetTargetCommitLatencyUs());
+  }
 
   if (config_.GetPublicKeyCertificateInfo()
               .public_key()
@@ -90,6 +102,7 @@ int ResponseManager::NewUserRequest(std::unique_ptr<Context> context,
   queue_item->context = std::move(context);
   queue_item->user_request = std::move(user_request);
 
+  queue_depth_++;
   batch_queue_.Push(std::move(queue_item));
   return 0;
 }
@@ -183,6 +196,9 @@ void ResponseManager::SendResponseToClient(
   if (create_time > 0) {
     uint64_t run_time = GetCurrentTime() - create_time;
     global_stats_->AddLatency(run_time);
+    if (adaptive_controller_) {
+      adaptive_controller_->AddLatency(run_time);
+    }
   } else {
     LOG(ERROR) << "seq:" << local_id << " no resp";
   }
@@ -214,22 +230,42 @@ void ResponseManager::SendResponseToClient(
 }
 
 // =================== request ========================
+uint32_t ResponseManager::GetBatchNum() const {
+  if (adaptive_controller_) {
+    return adaptive_controller_->GetBatchSize();
+  }
+  return config_.ClientBatchNum();
+}
+
+uint32_t ResponseManager::GetMaxInFlight() const {
+  if (adaptive_controller_) {
+    return adaptive_controller_->GetWindow();
+  }
+  return config_.GetMaxProcessTxn();
+}
+
 int ResponseManager::BatchProposeMsg() {
   LOG(INFO) << "batch wait time:" << config_.ClientBatchWaitTimeMS()
-            << " batch num:" << config_.ClientBatchNum();
+            << " batch num:" << config_.ClientBatchNum()
+            << " adaptive:" << (adaptive_controller_ != nullptr);
   std::vector<std::unique_ptr<QueueItem>> batch_req;
   while (!stop_) {
-    if (send_num_ > config_.GetMaxProcessTxn()) {
+    if (send_num_ > static_cast<int>(GetMaxInFlight())) {
       LOG(ERROR) << "send num too high, wait:" << send_num_;
       usleep(100);
       continue;
     }
-    if (batch_req.size() < config_.ClientBatchNum()) {
+    if (adaptive_controller_) {
+      adaptive_controller_->SetQueueDepth(queue_depth_);
+    }
+    uint32_t batch_num = GetBatchNum();
+    if (batch_req.size() < batch_num) {
       std::unique_ptr<QueueItem> item =
           batch_queue_.Pop(config_.ClientBatchWaitTimeMS());
       if (item != nullptr) {
+        queue_depth_--;
         batch_req.push_back(std::move(item));
-        if (batch_req.size() < config_.ClientBatchNum()) {
+        if (batch_req.size() < batch_num) {
           continue;
         }
       }
@@ -300,10 +336,33 @@ int ResponseManager::DoBatch(
   new_request->set_hash(SignatureVerifier::CalculateHash(new_request->data()));
   new_request->set_proxy_id(config_.GetSelfInfo().id());
   replica_communicator_->SendMessage(*new_request, GetPrimary());
+  if (config_.IsDigestPrePrepareEnabled()) {
+    SendPayload(*new_request);
+  }
   send_num_++;
   LOG(INFO) << "send msg to primary:" << GetPrimary()
             << " batch size:" << batch_req.size();
   return 0;
 }
 
+// Send the batch to the replicas other than the primary, as a whole or as
+// erasure-coded chunks, so that the primary only needs to propose its digest.
+void ResponseManager::SendPayload(const Request& request) {
+  Request payload(request);
+  payload.set_type(Request::TYPE_PAYLOAD);
+  if (payload_codec_ && payload_codec_->NeedEncode(payload)) {
+    for (const auto& it : payload_codec_->Encode(payload)) {
+      if (it.first != GetPrimary()) {
+        replica_communicator_->SendMessage(it.second, it.first);
+      }
+    }
+    return;
+  }
+  for (const auto& replica : config_.GetReplicaInfos()) {
+    if (replica.id() != GetPrimary()) {
+      replica_communicator_->SendMessage(payload, replica.id());
+    }
+  }
+}
+
 }  // namespace resdb
@@ -26,7 +26,9 @@
 #pragma once
 
 #include "platform/config/resdb_config.h"
+#include "platform/consensus/ordering/pbft/adaptive_controller.h"
 #include "platform/consensus/ordering/pbft/lock_free_collector_pool.h"
+#include "platform/consensus/ordering/pbft/payload_codec.h"
 #include "platform/consensus/ordering/pbft/transaction_utils.h"
 #include "platform/networkstrate/replica_communicator.h"
 #include "platform/statistic/stats.h"
@@ -70,6 +72,11 @@ class ResponseManager {
   int DoBatch(const std::vector<std::unique_ptr<QueueItem>>& batch_req);
   int BatchProposeMsg();
   int GetPrimary();
+  void SendPayload(const Request& request);
+  // The batch size and the number of batches in flight, adjusted by the
+  // adaptive controller if it is enabled.
+  uint32_t GetBatchNum() const;
+  uint32_t GetMaxInFlight() const;
 
  private:
   ResDBConfig config_;
@@ -83,6 +90,9 @@ class ResponseManager {
   SystemInfo* system_info_;
   std::atomic<int> send_num_;
   SignatureVerifier* verifier_;
+  std::unique_ptr<AdaptiveController> adaptive_controller_;
+  std::unique_ptr<PayloadCodec> payload_codec_;
+  std::atomic<uint64_t> queue_depth_;
 };
 
 }  // namespace resdb
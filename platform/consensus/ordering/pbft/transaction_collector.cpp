@@ -27,12 +27,43 @@
 
 #include <glog/logging.h>
 
+#include <thread>
+
 #include "common/crypto/signature_verifier.h"
 
 namespace resdb {
 
 uint64_t TransactionCollector::Seq() { return seq_; }
 
+void TransactionCollector::Reset(uint64_t seq) {
+  std::lock_guard<std::shared_mutex> lk(mutex_);
+  // Reject the requests of the old seq still in flight while the data is
+  // cleared: they fail the seq check against the invalid seq, and the ones
+  // racing with the new seq fail the committed check.
+  is_committed_ = true;
+  seq_ = kInvalidSeq;
+  status_ = TransactionStatue::None;
+  is_prepared_ = false;
+  context_list_.clear();
+  digest_num_ = 0;
+  for (int i = 0; i < Request::NUM_OF_TYPE; ++i) {
+    for (SenderSet& senders : senders_[i]) {
+      senders.Clear();
+    }
+    fast_votes_[i]->senders.Clear();
+    fast_votes_[i]->state.store(kDigestEmpty, std::memory_order_release);
+  }
+  prepared_proof_.clear();
+  atomic_mian_request_.Clear();
+  commit_certs_.clear();
+  other_main_request_.clear();
+  view_ = 0;
+  // Update the seq at last so that the requests of the new seq are not
+  // accepted before the old data is cleared.
+  seq_ = seq;
+  is_committed_ = false;
+}
+
 bool TransactionCollector::IsPrepared() { return is_prepared_; }
 
 TransactionStatue TransactionCollector::GetStatus() const { return status_; }
@@ -61,8 +92,13 @@ std::vector<std::unique_ptr<Context>> TransactionCollector::FetchContextList(
   return std::move(context_list_);
 }
 
-std::vector<RequestInfo> TransactionCollector::GetPreparedProof() {
+std::vector<RequestInfo> TransactionCollector::GetPreparedProof(
+    uint64_t seq) {
   std::vector<RequestInfo> prepared_info;
+  std::lock_guard<std::shared_mutex> lk(mutex_);
+  if (seq_ != seq) {
+    return prepared_info;
+  }
   for (const auto& proof : prepared_proof_) {
     RequestInfo info;
     info.signature = proof->signature;
@@ -82,6 +118,10 @@ int TransactionCollector::AddRequest(
     LOG(ERROR) << "request empty";
     return -2;
   }
+  if (request->type() < 0 || request->type() >= Request::NUM_OF_TYPE) {
+    LOG(ERROR) << "invalid request type:" << request->type();
+    return -2;
+  }
 
   int32_t sender_id = request->sender_id();
   std::string hash = request->hash();
@@ -105,6 +145,10 @@ int TransactionCollector::AddRequest(
     auto request_info = std::make_unique<RequestInfo>();
     request_info->signature = signature;
     request_info->request = std::move(request);
+    std::lock_guard<std::shared_mutex> lk(mutex_);
+    if (seq_ != seq) {
+      return -2;
+    }
     bool force = false;
     if (view_ && view_ < view && !is_prepared_) {
       force = true;
@@ -132,17 +176,17 @@ int TransactionCollector::AddRequest(
           auto request_info = std::make_unique<RequestInfo>();
           request_info->signature = signature;
           request_info->request = std::make_unique<Request>(*request);
-          std::lock_guard<std::mutex> lk(mutex_);
+          std::lock_guard<std::shared_mutex> lk(mutex_);
+          if (seq_ != seq) {
+            return -2;
+          }
           if (is_prepared_) {
             return 0;
           }
           prepared_proof_.push_back(std::move(request_info));
-          if (senders_[type].count(hash) == 0) {
-            senders_[type].insert(std::make_pair(hash, std::bitset<128>()));
-          }
-          senders_[type][hash][sender_id] = 1;
-          call_back(*request, senders_[type][hash].count(), nullptr, &status_,
-                    false);
+          SenderSet& senders = GetSenders(type, GetDigestId(hash));
+          senders.Add(sender_id);
+          call_back(*request, senders.Count(), nullptr, &status_, false);
           if (status_.load() == TransactionStatue::READY_COMMIT) {
             is_prepared_ = true;
             if (atomic_mian_request_.Reference() != nullptr &&
@@ -176,30 +220,93 @@ int TransactionCollector::AddRequest(
     if (request->type() == Request::TYPE_COMMIT) {
       if (request->has_data_signature() &&
           request->data_signature().node_id() > 0) {
-        std::lock_guard<std::mutex> lk(mutex_);
+        std::lock_guard<std::shared_mutex> lk(mutex_);
+        if (seq_ != seq) {
+          return -2;
+        }
         LOG(ERROR) << "add qc signature";
         commit_certs_.push_back(request->data_signature());
       }
     }
 
-    {
-      std::lock_guard<std::mutex> lk(mutex_);
-      if (senders_[type].count(hash) == 0) {
-        senders_[type].insert(std::make_pair(hash, std::bitset<128>()));
+    // The fast path only takes the shared lock so that the votes are still
+    // counted concurrently, while Reset() cannot clear them underneath.
+    std::shared_lock<std::shared_mutex> lk(mutex_);
+    if (seq_ != seq) {
+      return -2;
+    }
+    AtomicSenderSet* fast_senders = GetFastSenders(type, hash);
+    if (fast_senders != nullptr) {
+      fast_senders->Add(sender_id);
+      call_back(*request, fast_senders->Count(), nullptr, &status_, false);
+    } else {
+      lk.unlock();
+      std::lock_guard<std::shared_mutex> slow_lk(mutex_);
+      if (seq_ != seq) {
+        return -2;
       }
-      senders_[type][hash][sender_id] = 1;
-      call_back(*request, senders_[type][hash].count(), nullptr, &status_,
-                false);
+      SenderSet& senders = GetSenders(type, GetDigestId(hash));
+      senders.Add(sender_id);
+      call_back(*request, senders.Count(), nullptr, &status_, false);
     }
-
-    if (status_.load() == TransactionStatue::READY_EXECUTE) {
-      Commit();
-      return 1;
+  }
+  if (status_.load() == TransactionStatue::READY_EXECUTE) {
+    std::shared_lock<std::shared_mutex> lk(mutex_);
+    if (seq_ != seq) {
+      return -2;
     }
+    Commit();
+    return 1;
   }
   return 0;
 }
 
+AtomicSenderSet* TransactionCollector::GetFastSenders(int type,
+                                                      const std::string& hash) {
+  FastVotes* votes = fast_votes_[type].get();
+  int state = votes->state.load(std::memory_order_acquire);
+  if (state == kDigestEmpty) {
+    if (votes->state.compare_exchange_strong(state, kDigestWriting,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+      votes->digest = hash;
+      votes->state.store(kDigestReady, std::memory_order_release);
+      return &votes->senders;
+    }
+  }
+  // Another thread is binding the digest, which only copies the hash.
+  while (state == kDigestWriting) {
+    std::this_thread::yield();
+    state = votes->state.load(std::memory_order_acquire);
+  }
+  if (state == kDigestReady && votes->digest == hash) {
+    return &votes->senders;
+  }
+  return nullptr;
+}
+
+size_t TransactionCollector::GetDigestId(const std::string& hash) {
+  for (size_t i = 0; i < digest_num_; ++i) {
+    if (digests_[i] == hash) {
+      return i;
+    }
+  }
+  if (digest_num_ == digests_.size()) {
+    digests_.push_back(hash);
+  } else {
+    digests_[digest_num_] = hash;
+  }
+  return digest_num_++;
+}
+
+SenderSet& TransactionCollector::GetSenders(int type, size_t digest_id) {
+  std::vector<SenderSet>& senders = senders_[type];
+  while (senders.size() <= digest_id) {
+    senders.emplace_back(replica_num_);
+  }
+  return senders[digest_id];
+}
+
 int TransactionCollector::Commit() {
   TransactionStatue old_status = TransactionStatue::READY_EXECUTE;
   bool res = status_.compare_exchange_strong(
@@ -231,6 +338,7 @@ int TransactionCollector::Commit() {
 
 std::vector<std::string> TransactionCollector::GetAllStoredHash() {
   std::vector<std::string> v;
+  std::lock_guard<std::shared_mutex> lk(mutex_);
   auto main_request = atomic_mian_request_.Reference();
   if (main_request) {
     v.push_back(main_request->request->hash());
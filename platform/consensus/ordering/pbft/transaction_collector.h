@@ -25,9 +25,10 @@
 
 #pragma once
 
-#include <bitset>
+#include <shared_mutex>
 
 #include "platform/consensus/execution/transaction_executor.h"
+#include "platform/consensus/ordering/common/sender_set.h"
 #include "platform/networkstrate/server_comm.h"
 #include "platform/proto/resdb.pb.h"
 #include "platform/statistic/stats.h"
@@ -84,16 +85,27 @@ class AtomicUniquePtr {
 
 class TransactionCollector {
  public:
+  // Senders are identified by the replica ids in [0, replica_num].
   TransactionCollector(uint64_t seq, TransactionExecutor* executor,
-                       bool enable_viewchange = false)
+                       bool enable_viewchange = false,
+                       uint32_t replica_num = 128)
       : seq_(seq),
         executor_(executor),
         status_(TransactionStatue::None),
         enable_viewchange_(enable_viewchange),
-        view_(0) {}
+        view_(0),
+        replica_num_(replica_num) {
+    for (int i = 0; i < Request::NUM_OF_TYPE; ++i) {
+      fast_votes_.push_back(std::make_unique<FastVotes>(replica_num_));
+    }
+  }
 
   ~TransactionCollector() = default;
 
+  // Clear the collected data and reuse the collector for a new seq.
+  // The digests and the sender sets keep their memory for reuse.
+  void Reset(uint64_t seq);
+
   // TODO split the context list.
   // context contains the client channel used for sending back the response.
   int SetContextList(uint64_t seq,
@@ -113,7 +125,8 @@ class TransactionCollector {
                          std::atomic<TransactionStatue>* status, bool force)>
           call_back);
 
-  std::vector<RequestInfo> GetPreparedProof();
+  // Return an empty proof if the collector no longer holds seq.
+  std::vector<RequestInfo> GetPreparedProof(uint64_t seq);
   TransactionStatue GetStatus() const;
 
   uint64_t Seq();
@@ -125,23 +138,53 @@ class TransactionCollector {
  private:
   int Commit();
 
+  // Return the lock-free sender set of the type if hash is the first digest
+  // voted for that type, otherwise return nullptr and the vote has to go to
+  // the slow path under mutex_.
+  AtomicSenderSet* GetFastSenders(int type, const std::string& hash);
+
+  // Return the compact id of the hash inside this collector. A new id is
+  // assigned if the hash has not been seen.
+  size_t GetDigestId(const std::string& hash);
+  // Return the senders of the type voting for the digest.
+  SenderSet& GetSenders(int type, size_t digest_id);
+
  private:
-  uint64_t seq_;
+  // The seq held while the collector is being reset.
+  static constexpr uint64_t kInvalidSeq = UINT64_MAX;
+
+  std::atomic<uint64_t> seq_;
   TransactionExecutor* executor_;
   std::atomic<bool> is_committed_ = false;
   std::atomic<bool> is_prepared_ = false;
   std::vector<std::unique_ptr<Context>> context_list_;
-  std::map<std::string, std::list<std::unique_ptr<RequestInfo>>>
-      data_[Request::NUM_OF_TYPE];
   std::vector<std::unique_ptr<RequestInfo>> prepared_proof_;
   AtomicUniquePtr<RequestInfo> atomic_mian_request_;
   std::atomic<TransactionStatue> status_ = TransactionStatue::None;
   bool enable_viewchange_;
-  std::mutex mutex_;
+  // Taken shared by the lock-free vote counting and exclusively elsewhere.
+  std::shared_mutex mutex_;
   std::vector<SignatureInfo> commit_certs_;
-  std::map<std::string, std::bitset<128>> senders_[Request::NUM_OF_TYPE];
   std::set<std::unique_ptr<RequestInfo>> other_main_request_;
   uint64_t view_;
+  uint32_t replica_num_;
+  // The hashes seen by this collector, indexed by digest id. Only the first
+  // digest_num_ are in use; the rest are kept for reuse.
+  std::vector<std::string> digests_;
+  size_t digest_num_ = 0;
+  // Senders of each type, indexed by digest id.
+  std::vector<SenderSet> senders_[Request::NUM_OF_TYPE];
+
+  enum DigestState { kDigestEmpty = 0, kDigestWriting = 1, kDigestReady = 2 };
+  // Votes of one type for the first digest of that type. Honest replicas
+  // vote for the same digest, so they are counted without taking mutex_.
+  struct FastVotes {
+    FastVotes(uint32_t replica_num) : senders(replica_num) {}
+    std::atomic<int> state = kDigestEmpty;
+    std::string digest;
+    AtomicSenderSet senders;
+  };
+  std::vector<std::unique_ptr<FastVotes>> fast_votes_;
 };
 
 }  // namespace resdb
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+// Cost of collecting the messages of a seq through the PBFT phases, with
+// one thread, with threads running different seqs from the collector pool
+// and with threads voting on the same seq.
+
+#include <benchmark/benchmark.h>
+
+#include "platform/consensus/ordering/pbft/lock_free_collector_pool.h"
+#include "platform/consensus/ordering/pbft/transaction_collector.h"
+
+namespace resdb {
+namespace {
+
+// Move the status forward like MessageManager once 2f+1 messages arrive.
+void ChangeStatus(const Request& request, int received_count,
+                  std::atomic<TransactionStatue>* status, int min_num) {
+  TransactionStatue old_status = TransactionStatue::None;
+  switch (request.type()) {
+    case Request::TYPE_PRE_PREPARE:
+      status->compare_exchange_strong(old_status,
+                                      TransactionStatue::READY_PREPARE);
+      break;
+    case Request::TYPE_PREPARE:
+      old_status = TransactionStatue::READY_PREPARE;
+      if (received_count >= min_num) {
+        status->compare_exchange_strong(old_status,
+                                        TransactionStatue::READY_COMMIT);
+      }
+      break;
+    case Request::TYPE_COMMIT:
+      old_status = TransactionStatue::READY_COMMIT;
+      if (received_count >= min_num) {
+        status->compare_exchange_strong(old_status,
+                                        TransactionStatue::READY_EXECUTE);
+      }
+      break;
+  }
+}
+
+// Add the pre-prepare message and the prepare and commit messages of all
+// the replicas. Return true if the seq is committed.
+bool RunSeq(TransactionCollector* collector, uint64_t seq, int replica_num) {
+  int min_num = replica_num / 3 * 2 + 1;
+  auto call_back = [&](const Request& request, int received_count,
+                       TransactionCollector::CollectorDataType*,
+                       std::atomic<TransactionStatue>* status, bool) {
+    ChangeStatus(request, received_count, status, min_num);
+  };
+
+  Request request;
+  request.set_seq(seq);
+  request.set_hash(std::string(32, 'h'));
+  request.set_type(Request::TYPE_PRE_PREPARE);
+  request.set_sender_id(1);
+  SignatureInfo signature;
+  collector->AddRequest(std::make_unique<Request>(request), signature, true,
+                        call_back);
+  bool committed = false;
+  for (int type : {Request::TYPE_PREPARE, Request::TYPE_COMMIT}) {
+    request.set_type(type);
+    for (int i = 1; i <= replica_num; ++i) {
+      request.set_sender_id(i);
+      committed |= collector->AddRequest(std::make_unique<Request>(request),
+                                         signature, false, call_back) == 1;
+    }
+  }
+  return committed;
+}
+
+// Arg: replica num.
+void BM_AddRequest(benchmark::State& state) {
+  int replica_num = state.range(0);
+  TransactionCollector collector(0, nullptr, false, replica_num);
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    collector.Reset(++seq);
+    benchmark::DoNotOptimize(RunSeq(&collector, seq, replica_num));
+  }
+  state.SetItemsProcessed(state.iterations() * (2 * replica_num + 1));
+}
+BENCHMARK(BM_AddRequest)->Arg(4)->Arg(16)->Arg(64);
+
+// Each thread takes the next seq from the pool, like the worker threads.
+LockFreeCollectorPool* pool = nullptr;
+std::atomic<uint64_t> next_seq;
+
+void BM_CollectorPool(benchmark::State& state) {
+  constexpr int kReplicaNum = 4;
+  if (state.thread_index() == 0) {
+    pool = new LockFreeCollectorPool("benchmark", 1 << 14, nullptr, false,
+                                     kReplicaNum);
+    next_seq = 0;
+  }
+  for (auto _ : state) {
+    uint64_t seq = next_seq++;
+    RunSeq(pool->GetCollector(seq), seq, kReplicaNum);
+    pool->Update(seq);
+  }
+  if (state.thread_index() == 0) {
+    delete pool;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CollectorPool)->ThreadRange(1, 8)->UseRealTime();
+
+// The threads vote on the same seq, each for its own senders.
+TransactionCollector* shared_collector = nullptr;
+
+void BM_AddVoteContended(benchmark::State& state) {
+  constexpr int kReplicaNum = 128;
+  if (state.thread_index() == 0) {
+    shared_collector =
+        new TransactionCollector(1, nullptr, false, kReplicaNum);
+  }
+  Request request;
+  request.set_seq(1);
+  request.set_hash(std::string(32, 'h'));
+  request.set_type(Request::TYPE_COMMIT);
+  SignatureInfo signature;
+  int sender = state.thread_index();
+  for (auto _ : state) {
+    request.set_sender_id(sender);
+    sender = (sender + state.threads()) % kReplicaNum;
+    shared_collector->AddRequest(
+        std::make_unique<Request>(request), signature, false,
+        [](const Request&, int, TransactionCollector::CollectorDataType*,
+           std::atomic<TransactionStatue>*, bool) {});
+  }
+  if (state.thread_index() == 0) {
+    delete shared_collector;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddVoteContended)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
+}  // namespace resdb
@@ -29,6 +29,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "common/test/test_macros.h"
 
 namespace resdb {
@@ -398,6 +400,157 @@ TEST(TransactionCollectorTest, DelayMainRequest) {
   }
 }
 
+TEST(TransactionCollectorTest, MoreThan128Replicas) {
+  int64_t seq = 11111;
+  TransactionCollector collector(seq, nullptr, /*enable_viewchange=*/false,
+                                 /*replica_num=*/200);
+
+  Request expect_request;
+  expect_request.set_seq(seq);
+  expect_request.set_hash("hash_main");
+  expect_request.set_type(Request::TYPE_PREPARE);
+
+  // Duplicated senders and senders beyond the replica number are not
+  // counted.
+  std::vector<std::pair<int, int>> votes = {
+      {150, 1}, {200, 2}, {150, 2}, {201, 2}, {1000, 2}};
+  for (auto [sender_id, expect_count] : votes) {
+    expect_request.set_sender_id(sender_id);
+    std::unique_ptr<Request> request =
+        std::make_unique<Request>(expect_request);
+    SignatureInfo signature;
+    bool is_called = false;
+    EXPECT_EQ(collector.AddRequest(
+                  std::move(request), signature,
+                  /* is_main_request =*/false,
+                  [&](const Request& request, int received_count,
+                      TransactionCollector::CollectorDataType* data,
+                      std::atomic<TransactionStatue>* status, bool) {
+                    EXPECT_EQ(received_count, expect_count);
+                    is_called = true;
+                  }),
+              0);
+    EXPECT_TRUE(is_called);
+  }
+
+  // Votes for a different digest are counted separately.
+  expect_request.set_hash("hash_other");
+  expect_request.set_sender_id(150);
+  std::unique_ptr<Request> request = std::make_unique<Request>(expect_request);
+  SignatureInfo signature;
+  EXPECT_EQ(collector.AddRequest(
+                std::move(request), signature,
+                /* is_main_request =*/false,
+                [&](const Request& request, int received_count,
+                    TransactionCollector::CollectorDataType* data,
+                    std::atomic<TransactionStatue>* status,
+                    bool) { EXPECT_EQ(received_count, 1); }),
+            0);
+}
+
+TEST(TransactionCollectorTest, ConcurrentVotes) {
+  int64_t seq = 11111;
+  TransactionCollector collector(seq, nullptr, /*enable_viewchange=*/false,
+                                 /*replica_num=*/200);
+
+  std::atomic<int> max_count = 0;
+  auto add_votes = [&](int start) {
+    for (int sender_id = start; sender_id < start + 50; ++sender_id) {
+      auto request = std::make_unique<Request>();
+      request->set_seq(seq);
+      request->set_hash("hash_main");
+      request->set_type(Request::TYPE_COMMIT);
+      request->set_sender_id(sender_id);
+      SignatureInfo signature;
+      EXPECT_EQ(collector.AddRequest(
+                    std::move(request), signature,
+                    /* is_main_request =*/false,
+                    [&](const Request& request, int received_count,
+                        TransactionCollector::CollectorDataType* data,
+                        std::atomic<TransactionStatue>* status, bool) {
+                      int count = max_count.load();
+                      while (count < received_count &&
+                             !max_count.compare_exchange_weak(
+                                 count, received_count)) {
+                      }
+                    }),
+                0);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(add_votes, i * 50 + 1);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(max_count, 200);
+}
+
+TEST(TransactionCollectorTest, Reset) {
+  int64_t seq = 11111;
+  TransactionCollector collector(seq, nullptr);
+
+  auto add_vote = [&](int64_t vote_seq, int sender_id, int expect_count) {
+    auto request = std::make_unique<Request>();
+    request->set_seq(vote_seq);
+    request->set_hash("hash_main");
+    request->set_type(Request::TYPE_PREPARE);
+    request->set_sender_id(sender_id);
+    SignatureInfo signature;
+    return collector.AddRequest(
+        std::move(request), signature,
+        /* is_main_request =*/false,
+        [&](const Request& request, int received_count,
+            TransactionCollector::CollectorDataType* data,
+            std::atomic<TransactionStatue>* status,
+            bool) { EXPECT_EQ(received_count, expect_count); });
+  };
+
+  EXPECT_EQ(add_vote(seq, 1, 1), 0);
+  EXPECT_EQ(add_vote(seq, 2, 2), 0);
+
+  collector.Reset(seq + 1);
+  EXPECT_EQ(collector.Seq(), seq + 1);
+  // The votes of the old seq are rejected and the new seq starts over.
+  EXPECT_EQ(add_vote(seq, 3, 3), -2);
+  EXPECT_EQ(add_vote(seq + 1, 1, 1), 0);
+  EXPECT_EQ(add_vote(seq + 1, 2, 2), 0);
+}
+
+TEST(TransactionCollectorTest, ResetDropsOldSeq) {
+  int64_t seq = 11111;
+  TransactionCollector collector(seq, nullptr, /*enable_viewchange=*/true);
+
+  auto add_request = [&](int64_t request_seq, int type, int sender_id) {
+    auto request = std::make_unique<Request>();
+    request->set_seq(request_seq);
+    request->set_hash("hash_main");
+    request->set_type(type);
+    request->set_sender_id(sender_id);
+    SignatureInfo signature;
+    return collector.AddRequest(
+        std::move(request), signature,
+        /* is_main_request =*/type == Request::TYPE_PRE_PREPARE,
+        [&](const Request& request, int received_count,
+            TransactionCollector::CollectorDataType* data,
+            std::atomic<TransactionStatue>* status, bool) {});
+  };
+
+  EXPECT_EQ(add_request(seq, Request::TYPE_PREPARE, 1), 0);
+  EXPECT_EQ(add_request(seq, Request::TYPE_PREPARE, 2), 0);
+  EXPECT_EQ(collector.GetPreparedProof(seq).size(), 2);
+
+  collector.Reset(seq + 1);
+  EXPECT_TRUE(collector.GetPreparedProof(seq).empty());
+  EXPECT_TRUE(collector.GetPreparedProof(seq + 1).empty());
+  EXPECT_EQ(add_request(seq, Request::TYPE_PRE_PREPARE, 1), -2);
+  EXPECT_TRUE(collector.GetAllStoredHash().empty());
+  EXPECT_EQ(add_request(seq + 1, Request::TYPE_PRE_PREPARE, 1), 0);
+  EXPECT_EQ(collector.GetAllStoredHash().size(), 1);
+}
+
 }  // namespace
 
 }  // namespace resdb
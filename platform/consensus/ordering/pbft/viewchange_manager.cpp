@@ -89,9 +89,9 @@ ViewChangeManager::ViewChangeManager(const ResDBConfig& config,
       started_(false),
       stop_(false) {
   view_change_counter_ = 1;
+  timeout_backoff_ = 0;
   if (config_.GetConfigData().enable_viewchange()) {
     collector_pool_ = message_manager->GetCollectorPool();
-    sem_init(&viewchange_timer_signal_, 0, 0);
     server_checking_timeout_thread_ =
         std::thread(&ViewChangeManager::MonitoringViewChangeTimeOut, this);
     checkpoint_state_thread_ =
@@ -100,6 +100,11 @@ ViewChangeManager::ViewChangeManager(const ResDBConfig& config,
 }
 
 ViewChangeManager::~ViewChangeManager() {
+  {
+    std::lock_guard<std::mutex> lk(vc_mutex_);
+    stop_ = true;
+  }
+  viewchange_timer_cv_.notify_all();
   checkpoint_manager_->Stop();
   if (server_checking_timeout_thread_.joinable()) {
     server_checking_timeout_thread_.join();
@@ -138,13 +143,13 @@ void ViewChangeManager::MayStart() {
       auto viewchange_timer = std::make_shared<ViewChangeTimeout>(
           ViewChangeTimerType::TYPE_VIEWCHANGE, system_info_->GetCurrentView(),
           config_.GetSelfInfo().id(), "null", GetCurrentTime(),
-          timeout_length_);
+          GetTimeoutLength());
       std::lock_guard<std::mutex> lk(vc_mutex_);
       if (viewchange_timeout_min_heap_[config_.GetSelfInfo().id()].size() <
           config_.GetMaxClientComplaintNum()) {
         viewchange_timeout_min_heap_[config_.GetSelfInfo().id()].push(
             viewchange_timer);
-        sem_post(&viewchange_timer_signal_);
+        viewchange_timer_cv_.notify_one();
       }
     }
   });
@@ -165,6 +170,15 @@ bool ViewChangeManager::IsInViewChange() {
   return status_ != ViewChangeStatus::NONE;
 }
 
+uint64_t ViewChangeManager::GetTimeoutLength() {
+  uint64_t timeout = config_.GetViewChangeFirstTimeoutMs();
+  uint64_t max_timeout = config_.GetViewChangeMaxTimeoutMs();
+  for (uint32_t i = 0; i < timeout_backoff_ && timeout < max_timeout; ++i) {
+    timeout <<= 1;
+  }
+  return std::min(timeout, max_timeout) * 1000;
+}
+
 bool ViewChangeManager::IsValidViewChangeMsg(
     const ViewChangeMessage& view_change_message) {
   if (view_change_message.view_number() <= system_info_->GetCurrentView()) {
@@ -192,11 +206,16 @@ bool ViewChangeManager::IsValidViewChangeMsg(
                  << "] not enough:" << config_.GetMinDataReceiveNum();
       return false;
     }
+    std::set<uint32_t> senders;
     for (const auto& proof : prepared_msg.proof()) {
       if (proof.request().seq() != prepared_msg.seq()) {
         LOG(ERROR) << "proof seq not match";
         return false;
       }
+      if (!senders.insert(proof.request().sender_id()).second) {
+        LOG(ERROR) << "duplicated proof from:" << proof.request().sender_id();
+        return false;
+      }
       std::string data;
       proof.request().SerializeToString(&data);
       if (!verifier_->VerifyMessage(data, proof.signature())) {
@@ -375,6 +394,7 @@ int ViewChangeManager::ProcessNewView(std::unique_ptr<Context> context,
   }
 
   ChangeStatue(ViewChangeStatus::NONE);
+  timeout_backoff_ = 0;
   return config_.GetSelfInfo().id() == system_info_->GetPrimaryId() ? -4 : 0;
 }
 
@@ -403,13 +423,13 @@ int ViewChangeManager::ProcessViewChange(std::unique_ptr<Context> context,
       auto newview_timer = std::make_shared<ViewChangeTimeout>(
           ViewChangeTimerType::TYPE_NEWVIEW, system_info_->GetCurrentView(),
           config_.GetSelfInfo().id(), "null", GetCurrentTime(),
-          timeout_length_);
+          GetTimeoutLength());
       std::lock_guard<std::mutex> lk(vc_mutex_);
       if (viewchange_timeout_min_heap_[config_.GetSelfInfo().id()].size() <
           config_.GetMaxClientComplaintNum()) {
         viewchange_timeout_min_heap_[config_.GetSelfInfo().id()].push(
             newview_timer);
-        sem_post(&viewchange_timer_signal_);
+        viewchange_timer_cv_.notify_one();
       }
     }
     ChangeStatue(ViewChangeStatus::READY_NEW_VIEW);
@@ -480,26 +500,17 @@ void ViewChangeManager::SendViewChangeMsg() {
       checkpoint_manager_->GetStableCheckpointWithVotes();
 
   // P - P is a set containing a set Pm for each request m that prepared at i
-  // with a sequence number higher than n.
-  int max_seq = checkpoint_manager_->GetHighestPreparedSeq();
-  LOG(INFO) << "Check prepared or committed txns from "
-            << view_change_message.stable_ckpt().seq() + 1 << " to " << max_seq;
-
-  for (int i = view_change_message.stable_ckpt().seq() + 1; i <= max_seq; ++i) {
-    // seq i has been prepared or committed.
-    if (message_manager_->GetTransactionState(i) >=
-        TransactionStatue::READY_COMMIT) {
-      std::vector<RequestInfo> proof_info =
-          message_manager_->GetPreparedProof(i);
-      assert(proof_info.size() >= config_.GetMinDataReceiveNum());
-      auto txn = view_change_message.add_prepared_msg();
-      txn->set_seq(i);
-      for (const auto& info : proof_info) {
-        auto proof = txn->add_proof();
-        *proof->mutable_request() = *info.request;
-        *proof->mutable_signature() = info.signature;
-      }
-    }
+  // with a sequence number higher than n. The certificates are kept by the
+  // message manager when each seq is prepared.
+  uint64_t stable_seq = view_change_message.stable_ckpt().seq();
+  uint64_t max_seq = checkpoint_manager_->GetHighestPreparedSeq();
+  LOG(INFO) << "Check prepared or committed txns from " << stable_seq + 1
+            << " to " << max_seq;
+
+  PreparedCertificateStore* prepared_certs =
+      message_manager_->GetPreparedCertificateStore();
+  for (auto& cert : prepared_certs->Get(stable_seq, max_seq)) {
+    *view_change_message.add_prepared_msg() = std::move(cert);
   }
 
   // Broadcast my view change request.
@@ -513,43 +524,50 @@ void ViewChangeManager::AddComplaintTimer(uint64_t proxy_id, std::string hash) {
   std::lock_guard<std::mutex> lk(vc_mutex_);
   if (complaining_clients_.count(proxy_id) == 0) {
     complaining_clients_[proxy_id].set_proxy_id(proxy_id);
+    complaining_clients_[proxy_id].set_timeout_length(
+        config_.GetViewChangeFirstTimeoutMs() * 1000);
   }
   auto complaint_ = complaining_clients_[proxy_id].SetComplaining(
       hash, system_info_->GetCurrentView());
   if (viewchange_timeout_min_heap_[proxy_id].size() <
       config_.GetMaxClientComplaintNum()) {
     viewchange_timeout_min_heap_[proxy_id].push(complaint_);
-    sem_post(&viewchange_timer_signal_);
+    viewchange_timer_cv_.notify_one();
   } else {
     // LOG(INFO) << "The number of complaints reaches the maximum value";
   }
 }
 
 void ViewChangeManager::MonitoringViewChangeTimeOut() {
+  std::unique_lock<std::mutex> lk(vc_mutex_);
   while (!stop_) {
     // [DK3] After timer is out, the client will check if the corresponding
     // client request has recevied sufficient valid responses
-    sem_wait(&viewchange_timer_signal_);
-    vc_mutex_.lock();
-    bool empty = true;
-    std::shared_ptr<ViewChangeTimeout> viewchange_timeout;
+    // Take the timer expiring first among all the proxies.
+    ViewChangeTimeoutHeap* earliest = nullptr;
     for (auto& heap : viewchange_timeout_min_heap_) {
-      if (!heap.second.empty()) {
-        viewchange_timeout = heap.second.top();
-        heap.second.pop();
-        vc_mutex_.unlock();
-        empty = false;
-        break;
+      if (!heap.second.empty() &&
+          (earliest == nullptr || heap.second.top()->timeout_time <
+                                      earliest->top()->timeout_time)) {
+        earliest = &heap.second;
       }
     }
-    if (empty) {
-      vc_mutex_.unlock();
+    if (earliest == nullptr) {
+      viewchange_timer_cv_.wait(lk);
       continue;
     }
     auto current_time = GetCurrentTime();
-    if (viewchange_timeout->timeout_time > current_time) {
-      usleep(viewchange_timeout->timeout_time - current_time);
+    if (earliest->top()->timeout_time > current_time) {
+      // A timer added in the meantime may expire earlier, so look again
+      // once woken up.
+      viewchange_timer_cv_.wait_for(
+          lk, std::chrono::microseconds(earliest->top()->timeout_time -
+                                        current_time));
+      continue;
     }
+    std::shared_ptr<ViewChangeTimeout> viewchange_timeout = earliest->top();
+    earliest->pop();
+    lk.unlock();
     // [DK3] if not enough responses are received, the client broadcasts the
     // client request to all replicas
     if (viewchange_timeout->type == ViewChangeTimerType::TYPE_NEWVIEW) {
@@ -560,6 +578,7 @@ void ViewChangeManager::MonitoringViewChangeTimeOut() {
         // viewchange. SetCurrentViewAndNewPrimary(viewchange_timeout->view +
         // 1);
         LOG(ERROR) << "It is time to start a new viewchange";
+        timeout_backoff_++;
         checkpoint_manager_->TimeoutHandler();
       }
     } else if (viewchange_timeout->type ==
@@ -570,6 +589,7 @@ void ViewChangeManager::MonitoringViewChangeTimeOut() {
       if (status_ == ViewChangeStatus::READY_VIEW_CHANGE &&
           viewchange_timeout->view == system_info_->GetCurrentView()) {
         LOG(ERROR) << "It is time to rebroacast viewchange messages";
+        timeout_backoff_++;
         ChangeStatue(ViewChangeStatus::VIEW_CHANGE_FAIL);
         checkpoint_manager_->TimeoutHandler();
       }
@@ -582,7 +602,7 @@ void ViewChangeManager::MonitoringViewChangeTimeOut() {
         complaining_clients_[viewchange_timeout->proxy_id]
             .EraseViewChangeTimeout(viewchange_timeout->hash);
       }
-      std::lock_guard<std::mutex> lk(status_mutex_);
+      std::lock_guard<std::mutex> status_lk(status_mutex_);
       if (status_ == ViewChangeStatus::NONE &&
           viewchange_timeout->view == system_info_->GetCurrentView()) {
         if (viewchange_timeout->start_time >=
@@ -594,6 +614,7 @@ void ViewChangeManager::MonitoringViewChangeTimeOut() {
         }
       }
     }
+    lk.lock();
   }
 }
 
@@ -604,6 +625,7 @@ void ViewChangeManager::MonitoringCheckpointState() {
     auto value = checkpoint_manager_->GetCommittableSeq();
     if (last_seq_value != value) {
       last_seq_value = value;
+      timeout_backoff_ = 0;
       if (IsInViewChange()) {
         ChangeStatue(ViewChangeStatus::NONE);
       }
@@ -27,11 +27,15 @@
 
 #include <semaphore.h>
 
+#include <condition_variable>
+#include <queue>
+
 #include "common/crypto/signature_verifier.h"
 #include "platform/config/resdb_config.h"
 #include "platform/consensus/execution/system_info.h"
 #include "platform/consensus/ordering/pbft/checkpoint_manager.h"
 #include "platform/consensus/ordering/pbft/message_manager.h"
+#include "platform/consensus/ordering/pbft/prepared_certificate_store.h"
 #include "platform/networkstrate/replica_communicator.h"
 #include "platform/proto/viewchange_message.pb.h"
 
@@ -63,6 +67,20 @@ class ViewChangeTimeout {
   }
 };
 
+// Orders the timers held by shared_ptr so that the priority queue pops the
+// one expiring first.
+struct ViewChangeTimeoutCompare {
+  bool operator()(const std::shared_ptr<ViewChangeTimeout>& a,
+                  const std::shared_ptr<ViewChangeTimeout>& b) const {
+    return *a < *b;
+  }
+};
+
+typedef std::priority_queue<std::shared_ptr<ViewChangeTimeout>,
+                            std::vector<std::shared_ptr<ViewChangeTimeout>>,
+                            ViewChangeTimeoutCompare>
+    ViewChangeTimeoutHeap;
+
 class ComplaningClients {
  public:
   ComplaningClients();
@@ -71,6 +89,9 @@ class ComplaningClients {
                                                     uint64_t view);
   void ReleaseComplaining(std::string hash);
   void set_proxy_id(uint64_t proxy_id) { this->proxy_id = proxy_id; }
+  void set_timeout_length(uint64_t timeout_length) {
+    this->timeout_length_ = timeout_length;
+  }
 
   uint CountViewChangeTimeout(std::string hash);
   void EraseViewChangeTimeout(std::string hash);
@@ -129,6 +150,10 @@ class ViewChangeManager {
   void MonitoringViewChangeTimeOut();
   bool CheckTimeOut(ViewChangeTimeout& info);
   void MonitoringCheckpointState();
+  // The timeout of the view change and new view timers in microseconds. It
+  // starts from the first timeout and doubles on each view change that
+  // times out, up to the max timeout.
+  uint64_t GetTimeoutLength();
 
  protected:
   ResDBConfig config_;
@@ -149,13 +174,14 @@ class ViewChangeManager {
   std::thread server_checking_timeout_thread_;
   std::thread checkpoint_state_thread_;
   sem_t timeout_cnt_;
-  sem_t viewchange_timer_signal_;
+  // Notified under vc_mutex_ when a timer is added or the manager stops.
+  std::condition_variable viewchange_timer_cv_;
   // LockFreeQueue<ViewChangeTimeout> timeout_info_queue;
-  std::map<uint64_t, std::priority_queue<std::shared_ptr<ViewChangeTimeout>>>
-      viewchange_timeout_min_heap_;
+  std::map<uint64_t, ViewChangeTimeoutHeap> viewchange_timeout_min_heap_;
   std::map<uint64_t, ComplaningClients> complaining_clients_;
   std::atomic<bool> stop_;
-  uint64_t timeout_length_ = 10000000;
+  // The number of view changes timed out since the last progress.
+  std::atomic<uint32_t> timeout_backoff_;
 
   LockFreeCollectorPool* collector_pool_;
   DuplicateManager* duplicate_manager_;
@@ -27,6 +27,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 #include "platform/consensus/ordering/poe/common/poe_utils.h"
 
 namespace resdb {
@@ -45,6 +47,7 @@ MessageManager::MessageManager(
             // collector_pool_->Update(request->seq());
             resp_msg->set_proxy_id(request->proxy_id());
             resp_msg->set_seq(request->seq());
+            GarbageCollect(request->seq());
             queue_.Push(std::move(resp_msg));
             // new committed req, reset viewchange timer.
             if (viewchange_callback_) {
@@ -123,20 +126,90 @@ void MessageManager::SetRequest(std::unique_ptr<POERequest> poe_request) {
   int64_t seq = poe_request->seq();
 
   std::lock_guard<std::mutex> lk(mutex_);
+  if (seq <= static_cast<int64_t>(stable_seq_)) {
+    // The seq has been executed and released.
+    return;
+  }
   if (poe_request->type() == POERequest::TYPE_CERTIFY) {
     commit_req_[seq] = std::move(poe_request);
   } else if (poe_request->type() == POERequest::TYPE_PROPOSE) {
-    data_[hash] = poe_request->data();
+    auto& data = data_[hash];
+    data.first = std::max(data.first, static_cast<uint64_t>(seq));
+    data.second = poe_request->data();
+    propose_hash_[seq] = hash;
+  }
+  auto commit_it = commit_req_.find(seq);
+  auto data_it = data_.find(hash);
+  if (commit_it != commit_req_.end() && data_it != data_.end()) {
+    CommitInternal(*commit_it->second, data_it->second.second);
+  }
+}
+
+void MessageManager::GarbageCollect(uint64_t executed_seq) {
+  // Keep the certified requests of the recent seqs so that they can be
+  // re-committed by the replicas falling behind during a view change.
+  uint64_t window = static_cast<uint64_t>(config_.GetMaxProcessTxn()) * 2;
+  if (executed_seq <= window) {
+    return;
+  }
+  uint64_t stable_seq = executed_seq - window;
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (stable_seq <= stable_seq_) {
+    return;
   }
-  if (commit_req_.find(seq) != commit_req_.end() &&
-      data_.find(hash) != data_.end()) {
-    CommitInternal(*commit_req_[seq], data_[hash]);
+  while (!commit_req_.empty() && commit_req_.begin()->first <= stable_seq) {
+    commit_req_.erase(commit_req_.begin());
   }
+  while (!propose_hash_.empty() && propose_hash_.begin()->first <= stable_seq) {
+    auto data_it = data_.find(propose_hash_.begin()->second);
+    // The data is still used if it is proposed again by a larger seq.
+    if (data_it != data_.end() && data_it->second.first <= stable_seq) {
+      data_.erase(data_it);
+    }
+    propose_hash_.erase(propose_hash_.begin());
+  }
+  committed_seq_.erase(committed_seq_.begin(),
+                       committed_seq_.upper_bound(stable_seq));
+  stable_seq_ = stable_seq;
+}
+
+int MessageManager::CommitCertifyRequests(
+    const std::vector<POERequest>& requests) {
+  // Hold mutex_ so that committed_seq_ is not released by GarbageCollect
+  // while the requests are committed.
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (!requests.empty()) {
+    uint64_t first_seq = requests[0].seq();
+    // The seqs between the local stable seq and the first request must
+    // have been committed locally.
+    uint64_t missing_num =
+        first_seq > stable_seq_ + 1 ? first_seq - stable_seq_ - 1 : 0;
+    if (missing_num > 0 &&
+        (missing_num > committed_seq_.size() ||
+         static_cast<uint64_t>(
+             std::distance(committed_seq_.upper_bound(stable_seq_),
+                           committed_seq_.lower_bound(first_seq))) !=
+             missing_num)) {
+      LOG(ERROR) << "certify requests start from:" << first_seq
+                 << " missing seqs after stable seq:" << stable_seq_;
+      return -2;
+    }
+  }
+  for (const POERequest& request : requests) {
+    if (request.seq() <= stable_seq_ ||
+        committed_seq_.find(request.seq()) != committed_seq_.end()) {
+      continue;
+    }
+    LOG(INFO) << " recommit seq:" << request.seq();
+    CommitInternal(request, request.data());
+  }
+  return 0;
 }
 
 bool MessageManager::IsCommitted(uint64_t seq) {
   std::lock_guard<std::mutex> lk(mutex_);
-  return committed_seq_.find(seq) != committed_seq_.end();
+  return seq <= stable_seq_ || committed_seq_.find(seq) != committed_seq_.end();
 }
 
 std::unique_ptr<BatchUserResponse> MessageManager::GetResponseMsg() {
@@ -146,15 +219,17 @@ std::unique_ptr<BatchUserResponse> MessageManager::GetResponseMsg() {
 CertifyRequests MessageManager::GetCertifyRequests() {
   std::lock_guard<std::mutex> lk(mutex_);
   CertifyRequests msg;
-  for (uint64_t seq = 1;; seq++) {
-    if (commit_req_.find(seq) == commit_req_.end()) {
-      break;
-    }
-    POERequest request = *commit_req_[seq];
-    if (data_.find(request.hash()) == data_.end()) {
+  // Only the requests after stable_seq_ are kept, so the cost is bounded by
+  // the window instead of the total number of seqs.
+  uint64_t seq = stable_seq_ + 1;
+  for (auto it = commit_req_.find(seq);
+       it != commit_req_.end() && it->first == seq; ++it, ++seq) {
+    auto data_it = data_.find(it->second->hash());
+    if (data_it == data_.end()) {
       break;
     }
-    request.set_data(data_[request.hash()]);
+    POERequest request = *it->second;
+    request.set_data(data_it->second.second);
     *msg.add_certify_requests() = request;
   }
   LOG(ERROR) << "get data seq:" << msg.certify_requests_size();
@@ -31,6 +31,7 @@
 #include <memory>
 #include <queue>
 #include <set>
+#include <vector>
 
 #include "platform/common/queue/lock_free_queue.h"
 #include "platform/config/resdb_config.h"
@@ -55,6 +56,10 @@ class MessageManager {
   void SetExexecutedCallBack(std::function<void()> callback);
   CertifyRequests GetCertifyRequests();
   void CommitInternal(const POERequest& poe_request, const std::string& data);
+  // Commit the certified requests carried by a new view, which hold
+  // consecutive seqs. Return -2 if they leave a gap after the local stable
+  // seq that has not been committed.
+  int CommitCertifyRequests(const std::vector<POERequest>& requests);
 
   void RollBack(uint64_t seq);
 
@@ -78,15 +83,24 @@ class MessageManager {
   void WaitOrStop();
   void Monitor();
   void TriggerViewChange();
+  // Release the requests that have been executed and are out of the window
+  // kept for view changes.
+  void GarbageCollect(uint64_t executed_seq);
 
  private:
   ResDBConfig config_;
   uint64_t next_seq_ = 1;
   SystemInfo* system_info_;
   LockFreeQueue<BatchUserResponse> queue_;
-  std::map<std::string, std::string> data_;
+  // hash -> (the latest seq proposing it, data)
+  std::map<std::string, std::pair<uint64_t, std::string>> data_;
+  // seq -> hash of the proposal, used to release data_ by seq.
+  std::map<uint64_t, std::string> propose_hash_;
   std::map<uint64_t, std::unique_ptr<POERequest>> commit_req_;
   std::set<uint64_t> committed_seq_;
+  // All the seqs not larger than stable_seq_ have been executed and their
+  // requests have been released.
+  uint64_t stable_seq_ = 0;
   std::mutex mutex_;
   std::unique_ptr<TransactionExecutor> transaction_executor_;
   std::function<void()> viewchange_callback_;
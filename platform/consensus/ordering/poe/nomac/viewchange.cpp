@@ -203,7 +203,10 @@ void ViewChange::SendNewView(uint64_t new_view) {
       }
     }
   }
-  for (uint64_t seq = 1;; seq++) {
+  // Replicas release the executed requests out of their windows, so the
+  // requests start from the smallest seq received.
+  int64_t seq = certify_reqs.empty() ? 1 : certify_reqs.begin()->first;
+  for (;; seq++) {
     if (certify_reqs.find(seq) == certify_reqs.end()) {
       break;
     }
@@ -278,9 +281,14 @@ int ViewChange::ProcessNewView(std::unique_ptr<NewViewChangeMsg> new_vc) {
   }
   std::vector<POERequest> certify_requests;
   uint64_t max_seq = 0;
+  uint64_t first_seq = 1;
+  if (new_vc->certify_requests().certify_requests_size() > 0) {
+    first_seq = new_vc->certify_requests().certify_requests(0).seq();
+  }
   for (uint64_t i = 0; i < new_vc->certify_requests().certify_requests_size();
        ++i) {
-    if (new_vc->certify_requests().certify_requests(i).seq() != i + 1) {
+    if (new_vc->certify_requests().certify_requests(i).seq() !=
+        first_seq + i) {
       LOG(ERROR) << " seq not valid";
       return -2;
     }
@@ -298,12 +306,11 @@ int ViewChange::ProcessNewView(std::unique_ptr<NewViewChangeMsg> new_vc) {
   }
 
   for (auto& req : certify_requests) {
-    if (message_manager_->IsCommitted(req.seq())) {
-      continue;
-    }
-    LOG(INFO) << " recommit seq:" << req.seq();
     req.set_current_view(new_vc->view());
-    message_manager_->CommitInternal(req, req.data());
+  }
+  if (message_manager_->CommitCertifyRequests(certify_requests) != 0) {
+    LOG(ERROR) << " certify requests not valid";
+    return -2;
   }
   message_manager_->RollBack(max_seq + 1);
   system_info_->SetCurrentView(new_vc->view());
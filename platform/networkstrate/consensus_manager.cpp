@@ -28,6 +28,7 @@
 #include <glog/logging.h>
 #include <unistd.h>
 
+#include "platform/common/queue/queue_metrics.h"
 #include "platform/proto/broadcast.pb.h"
 
 namespace resdb {
@@ -48,11 +49,42 @@ bool ReplicaExisted(const ReplicaInfo& replica_info,
 
 ConsensusManager::ConsensusManager(const ResDBConfig& config)
     : config_(config), global_stats_(Stats::GetGlobalStats()) {
+  // Enable before the queues of the subclasses are constructed.
+  QueueMetrics::Enable(config_.IsQueueMetricsEnabled());
   if (config_.SignatureVerifierEnabled()) {
     verifier_ = std::make_unique<SignatureVerifier>(
         config_.GetPrivateKey(), config_.GetPublicKeyCertificateInfo());
   }
   bc_client_ = GetReplicaClient(config_.GetReplicaInfos(), true);
+  RegisterMetrics();
+}
+
+void ConsensusManager::RegisterMetrics() {
+  PrometheusHandler* prometheus = global_stats_->GetPrometheus();
+  if (prometheus == nullptr) {
+    return;
+  }
+  for (int i = 0; i < Request::NUM_OF_TYPE; ++i) {
+    if (!Request::Type_IsValid(i)) {
+      recv_msg_counter_.push_back(nullptr);
+      recv_bytes_counter_.push_back(nullptr);
+      continue;
+    }
+    PrometheusHandler::Labels labels = {{"type", Request::Type_Name(i)}};
+    recv_msg_counter_.push_back(prometheus->RegisterCounter(
+        "messages_received_total", "messages received by type", labels));
+    recv_bytes_counter_.push_back(prometheus->RegisterCounter(
+        "bytes_received_total", "bytes received by message type", labels));
+  }
+}
+
+void ConsensusManager::AddRecvMetrics(int type, size_t size) {
+  if (type < 0 || static_cast<size_t>(type) >= recv_msg_counter_.size() ||
+      recv_msg_counter_[type] == nullptr) {
+    return;
+  }
+  recv_msg_counter_[type]->Increment();
+  recv_bytes_counter_[type]->Increment(size);
 }
 
 ConsensusManager::~ConsensusManager() {
@@ -186,6 +218,7 @@ int ConsensusManager::Process(std::unique_ptr<Context> context,
   if (!request->SerializeToString(&tmp)) {
     return -1;
   }
+  AddRecvMetrics(request->type(), request_info->data_len);
 
   // forward the signature to the request so that it can be included in the
   // request/response set if needed.
@@ -331,7 +364,8 @@ std::unique_ptr<ReplicaCommunicator> ConsensusManager::GetReplicaClient(
       verifier_ == nullptr || config_.GetConfigData().not_need_signature()
           ? nullptr
           : verifier_.get(),
-      is_use_long_conn, config_.GetOutputWorkerNum(), config_.GetTcpBatchNum());
+      is_use_long_conn, config_.GetOutputWorkerNum(), config_.GetTcpBatchNum(),
+      config_.GetBroadcastQueueCapacity());
 }
 
 void ConsensusManager::AddNewReplica(const ReplicaInfo& info) {}
@@ -96,6 +96,8 @@ class ConsensusManager : public ServiceInterface {
  private:
   void HeartBeat();
   void BroadCastThread();
+  void RegisterMetrics();
+  void AddRecvMetrics(int type, size_t size);
 
  protected:
   ResDBConfig config_;
@@ -111,6 +113,8 @@ class ConsensusManager : public ServiceInterface {
   std::unique_ptr<ReplicaCommunicator> bc_client_;
   std::vector<ReplicaInfo> clients_;
   Stats* global_stats_;
+  // The messages and bytes received of each type, if Prometheus is enabled.
+  std::vector<prometheus::Counter*> recv_msg_counter_, recv_bytes_counter_;
 };
 
 }  // namespace resdb
@@ -35,11 +35,11 @@ namespace resdb {
 
 ReplicaCommunicator::ReplicaCommunicator(
     const std::vector<ReplicaInfo>& replicas, SignatureVerifier* verifier,
-    bool is_use_long_conn, int epoll_num, int tcp_batch)
+    bool is_use_long_conn, int epoll_num, int tcp_batch, int queue_capacity)
     : replicas_(replicas),
       verifier_(verifier),
       is_running_(false),
-      batch_queue_("bc_batch", tcp_batch),
+      batch_queue_("bc_batch", tcp_batch, queue_capacity),
       is_use_long_conn_(is_use_long_conn) {
   global_stats_ = Stats::GetGlobalStats();
   if (is_use_long_conn_) {
@@ -195,6 +195,7 @@ int ReplicaCommunicator::SendMessageFromPool(
       continue;
     }
     if (client->SendMessage(data) == 0) {
+      AddSentBytes(replica, data.size());
       ret++;
     } else {
       LOG(ERROR) << "send to:" << replica.ip() << " fail";
@@ -216,12 +217,32 @@ int ReplicaCommunicator::SendMessageInternal(
       client->SetSignatureVerifier(verifier_);
     }
     if (client->SendRawMessage(message) == 0) {
+      AddSentBytes(replica, message.ByteSizeLong());
       ret++;
     }
   }
   return ret;
 }
 
+void ReplicaCommunicator::AddSentBytes(const ReplicaInfo& replica,
+                                       size_t size) {
+  PrometheusHandler* prometheus = global_stats_->GetPrometheus();
+  if (prometheus == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(metric_mutex_);
+  auto it = sent_bytes_counter_.find(replica.id());
+  if (it == sent_bytes_counter_.end()) {
+    it = sent_bytes_counter_
+             .insert({replica.id(),
+                      prometheus->RegisterCounter(
+                          "bytes_sent_total", "bytes sent to each peer",
+                          {{"peer", std::to_string(replica.id())}})})
+             .first;
+  }
+  it->second->Increment(size);
+}
+
 AsyncReplicaClient* ReplicaCommunicator::GetClientFromPool(
     const std::string& ip, int port) {
   if (client_pools_.find(std::make_pair(ip, port)) == client_pools_.end()) {
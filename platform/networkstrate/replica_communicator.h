@@ -43,7 +43,7 @@ class ReplicaCommunicator {
   ReplicaCommunicator(const std::vector<ReplicaInfo>& replicas,
                       SignatureVerifier* verifier = nullptr,
                       bool is_use_long_conn = false, int epoll_num = 1,
-                      int tcp_batch = 100);
+                      int tcp_batch = 100, int queue_capacity = 1 << 16);
   virtual ~ReplicaCommunicator();
 
   // HeartBeat message is used to broadcast public keys.
@@ -78,6 +78,7 @@ class ReplicaCommunicator {
 
   bool IsRunning() const;
   bool IsInPool(const ReplicaInfo& replica_info);
+  void AddSentBytes(const ReplicaInfo& replica, size_t size);
 
  private:
   std::vector<ReplicaInfo> replicas_;
@@ -90,6 +91,10 @@ class ReplicaCommunicator {
     std::string data;
     std::vector<ReplicaInfo> dest_replicas;
   };
+  // Bounded by queue_capacity. The senders, which are the consensus
+  // workers, wait once it is full rather than dropping a consensus message,
+  // which would stall the seq until a view change; the waits are counted in
+  // the "full" metric of the bc_batch queue.
   BatchQueue<std::unique_ptr<QueueItem>> batch_queue_;
   bool is_use_long_conn_ = false;
 
@@ -99,6 +104,9 @@ class ReplicaCommunicator {
   std::vector<std::thread> worker_threads_;
   std::vector<ReplicaInfo> clients_;
   std::mutex mutex_;
+  // The bytes sent to each replica, if Prometheus is enabled.
+  std::mutex metric_mutex_;
+  std::map<int64_t, prometheus::Counter*> sent_bytes_counter_;
 };
 
 }  // namespace resdb
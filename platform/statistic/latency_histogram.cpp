@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/statistic/latency_histogram.h"
+
+namespace resdb {
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(std::make_unique<std::atomic<uint64_t>[]>(kBucketNum)),
+      sum_(0) {
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    counts_[i] = 0;
+  }
+}
+
+uint32_t LatencyHistogram::GetBucket(uint64_t value) {
+  if (value < kSubBucketNum) {
+    return value;
+  }
+  uint32_t shift = 63 - __builtin_clzll(value) - kSubBucketBits;
+  uint32_t sub_bucket = (value >> shift) & (kSubBucketNum - 1);
+  return (shift + 1) * kSubBucketNum + sub_bucket;
+}
+
+uint64_t LatencyHistogram::GetBucketValue(uint32_t bucket) {
+  if (bucket < kSubBucketNum) {
+    return bucket;
+  }
+  uint32_t shift = bucket / kSubBucketNum - 1;
+  uint64_t sub_bucket = bucket % kSubBucketNum + kSubBucketNum;
+  return (sub_bucket << shift) + ((1ull << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value, uint64_t count) {
+  counts_[GetBucket(value)].fetch_add(count, std::memory_order_relaxed);
+  sum_.fetch_add(value * count, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.counts.resize(kBucketNum);
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.counts[i];
+  }
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::operator-(
+    const Snapshot& other) const {
+  Snapshot diff = *this;
+  if (other.counts.size() != counts.size()) {
+    return diff;
+  }
+  for (size_t i = 0; i < counts.size(); ++i) {
+    diff.counts[i] -= other.counts[i];
+  }
+  diff.count -= other.count;
+  diff.sum -= other.sum;
+  return diff;
+}
+
+uint64_t LatencyHistogram::Snapshot::GetPercentile(double percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+  // The rank of the value, counting from 1.
+  uint64_t rank = static_cast<uint64_t>(percentile / 100 * count + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint64_t total = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    total += counts[i];
+    if (total >= rank) {
+      return GetBucketValue(i);
+    }
+  }
+  return GetBucketValue(counts.size() - 1);
+}
+
+double LatencyHistogram::Snapshot::GetMean() const {
+  return count == 0 ? 0 : static_cast<double>(sum) / count;
+}
+
+std::string LatencyHistogram::Snapshot::GetBuckets() const {
+  std::string buckets;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (counts[i] == 0) {
+      continue;
+    }
+    if (!buckets.empty()) {
+      buckets.append(" ");
+    }
+    buckets.append(std::to_string(GetBucketValue(i)) + ":" +
+                   std::to_string(counts[i]));
+  }
+  return buckets;
+}
+
+}  // namespace resdb
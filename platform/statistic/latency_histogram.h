@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace resdb {
+
+// LatencyHistogram records values in log-linear buckets like HdrHistogram:
+// each power of two is split into kSubBucketNum buckets, so a percentile is
+// reported within 1/kSubBucketNum of the real value whatever the scale.
+// Recording only increments atomic counters and never blocks.
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 4;
+  static constexpr uint32_t kSubBucketNum = 1 << kSubBucketBits;
+  static constexpr uint32_t kBucketNum = (64 - kSubBucketBits + 1) *
+                                         kSubBucketNum;
+
+  // The counts at some time. Subtracting an older snapshot gives the values
+  // recorded in between.
+  struct Snapshot {
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    Snapshot operator-(const Snapshot& other) const;
+    // Return the highest value equivalent to the percentile, in [0, 100].
+    uint64_t GetPercentile(double percentile) const;
+    double GetMean() const;
+    // Return the non-empty buckets as "value:count" separated by spaces,
+    // where value is the highest in the bucket, so that the snapshots of
+    // several processes can be merged.
+    std::string GetBuckets() const;
+  };
+
+  LatencyHistogram();
+
+  void Record(uint64_t value, uint64_t count = 1);
+  Snapshot GetSnapshot() const;
+
+  static uint32_t GetBucket(uint64_t value);
+  // Return the highest value falling in the bucket.
+  static uint64_t GetBucketValue(uint32_t bucket);
+
+ private:
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+  std::atomic<uint64_t> sum_;
+};
+
+}  // namespace resdb
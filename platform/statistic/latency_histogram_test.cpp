@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/statistic/latency_histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace resdb {
+namespace {
+
+TEST(LatencyHistogramTest, BucketBound) {
+  for (uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull,
+                         ~0ull}) {
+    uint32_t bucket = LatencyHistogram::GetBucket(value);
+    EXPECT_LT(bucket, LatencyHistogram::kBucketNum);
+    uint64_t bound = LatencyHistogram::GetBucketValue(bucket);
+    EXPECT_GE(bound, value);
+    EXPECT_LE(bound - value, value / LatencyHistogram::kSubBucketNum);
+  }
+}
+
+TEST(LatencyHistogramTest, Percentile) {
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.Record(i * 100);
+  }
+  LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count, 1000);
+  EXPECT_NEAR(snapshot.GetMean(), 50050, 1);
+  EXPECT_NEAR(snapshot.GetPercentile(50), 50000, 50000 / 16);
+  EXPECT_NEAR(snapshot.GetPercentile(99), 99000, 99000 / 16);
+  EXPECT_NEAR(snapshot.GetPercentile(99.9), 99900, 99900 / 16);
+  EXPECT_NEAR(snapshot.GetPercentile(100), 100000, 100000 / 16);
+}
+
+TEST(LatencyHistogramTest, Interval) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 100; ++i) {
+    histogram.Record(10);
+  }
+  LatencyHistogram::Snapshot last = histogram.GetSnapshot();
+  for (int i = 0; i < 100; ++i) {
+    histogram.Record(5000);
+  }
+  LatencyHistogram::Snapshot diff = histogram.GetSnapshot() - last;
+  EXPECT_EQ(diff.count, 100);
+  EXPECT_NEAR(diff.GetPercentile(50), 5000, 5000 / 16);
+}
+
+TEST(LatencyHistogramTest, Buckets) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.GetSnapshot().GetBuckets(), "");
+  histogram.Record(10, 3);
+  histogram.Record(5000, 2);
+  EXPECT_EQ(histogram.GetSnapshot().GetBuckets(), "10:3 5119:2");
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecord) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 10000; ++i) {
+        histogram.Record(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.GetSnapshot().count, 40000);
+}
+
+}  // namespace
+}  // namespace resdb
@@ -51,7 +51,20 @@ std::map<MetricName, std::pair<TableName, std::string>> metric_names = {
     {EXECUTE, {CONSENSUS, "execute"}},
     {NUM_EXECUTE_TX, {CONSENSUS, "num_execute_tx"}}};
 
-PrometheusHandler::PrometheusHandler(const std::string& server_address) {
+std::map<LatencyName, std::string> latency_names = {
+    {CLIENT_LATENCY, "client"},   {PROPOSE_LATENCY, "propose"},
+    {PREPARE_LATENCY, "prepare"}, {COMMIT_LATENCY, "commit"},
+    {EXECUTE_LATENCY, "execute"},
+};
+
+// From 100us to 10s.
+const prometheus::Histogram::BucketBoundaries latency_buckets = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+    0.05,   0.1,     0.25,   0.5,   1,      2.5,   5,     10};
+
+PrometheusHandler::PrometheusHandler(const std::string& server_address,
+                                     const Labels& labels)
+    : labels_(labels) {
   exposer_ =
       prometheus::detail::make_unique<prometheus::Exposer>(server_address);
 
@@ -68,47 +81,79 @@ PrometheusHandler::~PrometheusHandler() {
 }
 
 void PrometheusHandler::Register() {
-  for (auto& table : table_names) {
-    RegisterTable(table.second);
-  }
-
   for (auto& metric_pair : metric_names) {
-    RegisterMetric(table_names[metric_pair.second.first],
-                   metric_pair.second.second);
+    const std::string& table_name = table_names[metric_pair.second.first];
+    counter_[metric_pair.first] =
+        RegisterCounter(table_name + "_total", table_name + " metrics",
+                        {{"metrics", metric_pair.second.second}});
+  }
+  for (auto& latency_pair : latency_names) {
+    histogram_[latency_pair.first] = RegisterHistogram(
+        "latency_seconds", "latency of each phase in seconds",
+        {{"phase", latency_pair.second}}, latency_buckets);
   }
 }
 
-void PrometheusHandler::RegisterTable(const std::string& name) {
-  gbuilder* gauge = &prometheus::BuildGauge()
-                         .Name(name)
-                         .Help(name + " metrics")
-                         .Register(*registry_);
-  gauge_[name] = gauge;
+prometheus::Counter* PrometheusHandler::RegisterCounter(
+    const std::string& name, const std::string& help, const Labels& labels) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = counter_family_.find(name);
+  if (it == counter_family_.end()) {
+    it = counter_family_
+             .insert({name, &prometheus::BuildCounter()
+                                 .Name(name)
+                                 .Help(help)
+                                 .Labels(labels_)
+                                 .Register(*registry_)})
+             .first;
+  }
+  return &it->second->Add(labels);
 }
 
-void PrometheusHandler::RegisterMetric(const std::string& table_name,
-                                       const std::string& metric_name) {
-  if (gauge_.find(table_name) == gauge_.end()) {
-    return;
+prometheus::Gauge* PrometheusHandler::RegisterGauge(const std::string& name,
+                                                    const std::string& help,
+                                                    const Labels& labels) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = gauge_family_.find(name);
+  if (it == gauge_family_.end()) {
+    it = gauge_family_
+             .insert({name, &prometheus::BuildGauge()
+                                 .Name(name)
+                                 .Help(help)
+                                 .Labels(labels_)
+                                 .Register(*registry_)})
+             .first;
   }
-  gmetric* metric = &gauge_[table_name]->Add({{"metrics", metric_name}});
-  metric_[metric_name] = metric;
+  return &it->second->Add(labels);
 }
 
-void PrometheusHandler::Set(MetricName name, double value) {
-  std::string metric_name_str = metric_names[name].second;
-  if (metric_.find(metric_name_str) == metric_.end()) {
-    return;
+prometheus::Histogram* PrometheusHandler::RegisterHistogram(
+    const std::string& name, const std::string& help, const Labels& labels,
+    const prometheus::Histogram::BucketBoundaries& buckets) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = histogram_family_.find(name);
+  if (it == histogram_family_.end()) {
+    it = histogram_family_
+             .insert({name, &prometheus::BuildHistogram()
+                                 .Name(name)
+                                 .Help(help)
+                                 .Labels(labels_)
+                                 .Register(*registry_)})
+             .first;
   }
-  metric_[metric_name_str]->Set(value);
+  return &it->second->Add(labels, buckets);
+}
+
+const std::string& PrometheusHandler::GetLatencyName(LatencyName name) {
+  return latency_names[name];
 }
 
 void PrometheusHandler::Inc(MetricName name, double value) {
-  std::string metric_name_str = metric_names[name].second;
-  if (metric_.find(metric_name_str) == metric_.end()) {
-    return;
-  }
-  metric_[metric_name_str]->Increment(value);
+  counter_[name]->Increment(value);
+}
+
+void PrometheusHandler::Observe(LatencyName name, uint64_t latency_us) {
+  histogram_[name]->Observe(latency_us / 1000000.0);
 }
 
 }  // namespace resdb
@@ -28,8 +28,12 @@
 #include <glog/logging.h>
 #include <prometheus/counter.h>
 #include <prometheus/exposer.h>
+#include <prometheus/gauge.h>
+#include <prometheus/histogram.h>
 #include <prometheus/registry.h>
 
+#include <mutex>
+
 namespace resdb {
 
 enum TableName {
@@ -54,32 +58,69 @@ enum MetricName {
   COMMIT,
   EXECUTE,
   NUM_EXECUTE_TX,
+  NUM_OF_METRIC,
+};
+
+enum LatencyName {
+  // From sending a client request to receiving its response.
+  CLIENT_LATENCY,
+  // From accepting the pre-prepare message to being prepared.
+  PROPOSE_LATENCY,
+  // From being prepared to being committed.
+  PREPARE_LATENCY,
+  // From being committed to being executed.
+  COMMIT_LATENCY,
+  // Executing a batch.
+  EXECUTE_LATENCY,
+  NUM_OF_LATENCY,
 };
 
 class PrometheusHandler {
  public:
-  PrometheusHandler(const std::string& server_address);
+  typedef std::map<std::string, std::string> Labels;
+
+  // The labels are added to every metric, like the id of the replica.
+  PrometheusHandler(const std::string& server_address,
+                    const Labels& labels = {});
   ~PrometheusHandler();
 
-  void Set(MetricName name, double value);
   void Inc(MetricName name, double value);
+  // Observe a latency in microseconds. It is exported in seconds.
+  void Observe(LatencyName name, uint64_t latency_us);
+
+  static const std::string& GetLatencyName(LatencyName name);
+
+  // Register a metric for a subsystem. The metrics with the same name are
+  // in one family and are told apart by the labels. The returned metric
+  // lives as long as the handler.
+  prometheus::Counter* RegisterCounter(const std::string& name,
+                                       const std::string& help,
+                                       const Labels& labels = {});
+  prometheus::Gauge* RegisterGauge(const std::string& name,
+                                   const std::string& help,
+                                   const Labels& labels = {});
+  prometheus::Histogram* RegisterHistogram(
+      const std::string& name, const std::string& help, const Labels& labels,
+      const prometheus::Histogram::BucketBoundaries& buckets);
 
  protected:
   void Register();
-  void RegisterTable(const std::string& name);
-  void RegisterMetric(const std::string& table_name,
-                      const std::string& metric_name);
 
  private:
-  typedef prometheus::Family<prometheus::Gauge> gbuilder;
-  typedef prometheus::Gauge gmetric;
-
   std::unique_ptr<prometheus::Exposer, std::default_delete<prometheus::Exposer>>
       exposer_;
   std::shared_ptr<prometheus::Registry> registry_;
+  Labels labels_;
+
+  std::mutex mutex_;
+  std::map<std::string, prometheus::Family<prometheus::Counter>*>
+      counter_family_;
+  std::map<std::string, prometheus::Family<prometheus::Gauge>*> gauge_family_;
+  std::map<std::string, prometheus::Family<prometheus::Histogram>*>
+      histogram_family_;
 
-  std::map<std::string, gbuilder*> gauge_;
-  std::map<std::string, gmetric*> metric_;
+  prometheus::Counter* counter_[NUM_OF_METRIC];
+  prometheus::Histogram* histogram_[NUM_OF_LATENCY];
 };
 
 }  // namespace resdb
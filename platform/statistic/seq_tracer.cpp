@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/statistic/seq_tracer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "common/utils/utils.h"
+
+namespace resdb {
+
+SeqTracer* SeqTracer::GetGlobalTracer() {
+  static SeqTracer tracer;
+  return &tracer;
+}
+
+SeqTracer::SeqTracer() : sample_rate_(0), stop_(false) {}
+
+SeqTracer::~SeqTracer() { Stop(); }
+
+void SeqTracer::Start(uint32_t sample_rate, const std::string& file,
+                      uint32_t id) {
+  if (sample_rate == 0 || thread_.joinable()) {
+    return;
+  }
+  file_.open(file, std::ofstream::trunc);
+  if (!file_.is_open()) {
+    LOG(ERROR) << "open trace file fail:" << file;
+    return;
+  }
+  file_ << "[";
+  id_ = id;
+  stop_ = false;
+  sample_rate_ = sample_rate;
+  thread_ = std::thread(&SeqTracer::FlushThread, this);
+  LOG(INFO) << "trace one in every " << sample_rate << " seqs to " << file;
+}
+
+void SeqTracer::Stop() {
+  sample_rate_ = 0;
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  Flush(0);
+  std::lock_guard<std::mutex> lk(file_mutex_);
+  file_ << "\n]\n";
+  file_.close();
+}
+
+void SeqTracer::AddEvent(uint64_t seq, const char* name) {
+  if (!IsSampled(seq)) {
+    return;
+  }
+  uint64_t time = GetCurrentTime();
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = events_.find(seq);
+  if (it == events_.end()) {
+    if (events_.size() >= kMaxPendingSeq) {
+      return;
+    }
+    it = events_.insert({seq, {}}).first;
+  }
+  it->second.push_back({name, time});
+}
+
+void SeqTracer::FlushThread() {
+  while (!stop_) {
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cv_.wait_for(lk, std::chrono::microseconds(kIdleTimeUs),
+                   [&] { return stop_.load(); });
+    }
+    Flush(kIdleTimeUs);
+  }
+}
+
+void SeqTracer::Flush(uint64_t idle_us) {
+  uint64_t current_time = GetCurrentTime();
+  std::map<uint64_t, std::vector<Event>> idle_events;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto it = events_.begin(); it != events_.end();) {
+      if (it->second.back().time + idle_us <= current_time) {
+        idle_events.insert(std::move(*it));
+        it = events_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (idle_events.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(file_mutex_);
+  for (auto& it : idle_events) {
+    Write(it.first, &it.second);
+  }
+  file_.flush();
+}
+
+void SeqTracer::Write(uint64_t seq, std::vector<Event>* events) {
+  std::stable_sort(
+      events->begin(), events->end(),
+      [](const Event& a, const Event& b) { return a.time < b.time; });
+  for (size_t i = 0; i < events->size(); ++i) {
+    const Event& event = (*events)[i];
+    file_ << (has_event_ ? ",\n" : "\n");
+    has_event_ = true;
+    file_ << "{\"name\":\"" << event.name << "\",\"cat\":\"seq\"";
+    if (i + 1 < events->size()) {
+      file_ << ",\"ph\":\"X\",\"dur\":" << (*events)[i + 1].time - event.time;
+    } else {
+      file_ << ",\"ph\":\"i\",\"s\":\"t\"";
+    }
+    file_ << ",\"ts\":" << event.time << ",\"pid\":" << id_
+          << ",\"tid\":" << seq << ",\"args\":{\"seq\":" << seq << "}}";
+  }
+}
+
+}  // namespace resdb
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace resdb {
+
+// SeqTracer records when a sampled seq reaches each stage of ordering and
+// execution. The events of a seq are written once the seq has been idle for
+// a while, as a Chrome trace (JSON array format) that Perfetto and
+// chrome://tracing can open. Each seq is a track and each stage is a span
+// lasting until the next stage.
+//
+// Seqs that are not sampled cost one check, so the calls can stay in the
+// hot paths.
+class SeqTracer {
+ public:
+  static SeqTracer* GetGlobalTracer();
+
+  SeqTracer();
+  ~SeqTracer();
+
+  // Trace one in every sample_rate seqs into the file, tagged by the replica
+  // id. 0 disables tracing.
+  void Start(uint32_t sample_rate, const std::string& file, uint32_t id);
+  void Stop();
+
+  bool IsSampled(uint64_t seq) const {
+    uint32_t sample_rate = sample_rate_.load(std::memory_order_relaxed);
+    return sample_rate > 0 && seq % sample_rate == 0;
+  }
+
+  // Record that seq reaches the stage now. The name must outlive the tracer,
+  // like a string literal.
+  void AddEvent(uint64_t seq, const char* name);
+
+  // Write the seqs idle for more than idle_us.
+  void Flush(uint64_t idle_us);
+
+ private:
+  struct Event {
+    const char* name;
+    uint64_t time;
+  };
+
+  void FlushThread();
+  void Write(uint64_t seq, std::vector<Event>* events);
+
+ private:
+  // Seqs with events beyond it are dropped to bound the memory.
+  static constexpr size_t kMaxPendingSeq = 4096;
+  // A seq is written after no event for it in this time.
+  static constexpr uint64_t kIdleTimeUs = 1000000;
+
+  std::atomic<uint32_t> sample_rate_;
+  uint32_t id_ = 0;
+  std::mutex mutex_, file_mutex_;
+  std::map<uint64_t, std::vector<Event>> events_;
+  std::ofstream file_;
+  bool has_event_ = false;
+
+  std::thread thread_;
+  std::atomic<bool> stop_;
+  std::condition_variable cv_;
+};
+
+}  // namespace resdb
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019-2022 ExpoLab, UC Davis
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "platform/statistic/seq_tracer.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace resdb {
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+TEST(SeqTracerTest, Sample) {
+  SeqTracer tracer;
+  EXPECT_FALSE(tracer.IsSampled(4));
+
+  std::string path = ::testing::TempDir() + "/seq_trace_sample.json";
+  tracer.Start(4, path, 1);
+  EXPECT_TRUE(tracer.IsSampled(4));
+  EXPECT_FALSE(tracer.IsSampled(5));
+  tracer.Stop();
+  EXPECT_FALSE(tracer.IsSampled(4));
+}
+
+TEST(SeqTracerTest, WriteChromeTrace) {
+  SeqTracer tracer;
+  std::string path = ::testing::TempDir() + "/seq_trace_write.json";
+  tracer.Start(2, path, 3);
+  for (uint64_t seq = 1; seq <= 4; ++seq) {
+    tracer.AddEvent(seq, "propose");
+    tracer.AddEvent(seq, "prepared");
+  }
+  tracer.Flush(0);
+  tracer.AddEvent(4, "executed");
+  tracer.Stop();
+
+  std::string trace = ReadFile(path);
+  EXPECT_EQ(trace.front(), '[');
+  EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+  EXPECT_NE(trace.find("{\"name\":\"propose\",\"cat\":\"seq\",\"ph\":\"X\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"tid\":2,"), std::string::npos);
+  EXPECT_NE(trace.find("\"tid\":4,"), std::string::npos);
+  EXPECT_EQ(trace.find("\"tid\":1,"), std::string::npos);
+  EXPECT_EQ(trace.find("\"tid\":3,"), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"executed\",\"cat\":\"seq\",\"ph\":\"i\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"pid\":3"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace resdb
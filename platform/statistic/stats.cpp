@@ -109,6 +109,8 @@ void Stats::MonitorGlobal() {
   uint64_t last_total_request = 0, last_total_geo_request = 0,
            last_geo_request = 0;
   uint64_t time = 0;
+  std::vector<LatencyHistogram::Snapshot> last_latency(NUM_OF_LATENCY);
+  std::map<std::string, QueueMonitor> queue_monitors;
 
   while (!stop_) {
     sleep(monitor_sleep_time_);
@@ -185,12 +187,44 @@ void Stats::MonitorGlobal() {
                << seq_fail - last_seq_fail << " time:" << time
                << " "
                   "\n--------------- monitor ------------";
+    {
+      std::lock_guard<std::mutex> lk(geo_mutex_);
+      if (!geo_region_lag_.empty()) {
+        std::string region_lag;
+        for (const auto& it : geo_region_lag_) {
+          region_lag += " region " + std::to_string(it.first) + ":" +
+                        std::to_string(it.second);
+        }
+        LOG(ERROR) << "  geo region lag:" << region_lag;
+      }
+    }
     if (run_req_num - last_run_req_num > 0) {
       LOG(ERROR) << "  req client latency:"
                  << static_cast<double>(run_req_run_time -
                                         last_run_req_run_time) /
                         (run_req_num - last_run_req_num) / 1000000000.0;
     }
+    for (int i = 0; i < NUM_OF_LATENCY; ++i) {
+      LatencyName name = static_cast<LatencyName>(i);
+      LatencyHistogram::Snapshot latency = GetLatency(name);
+      LatencyHistogram::Snapshot diff = latency - last_latency[i];
+      if (diff.count > 0) {
+        LOG(ERROR) << "  " << PrometheusHandler::GetLatencyName(name)
+                   << " latency(us) num:" << diff.count
+                   << " mean:" << diff.GetMean()
+                   << " p50:" << diff.GetPercentile(50)
+                   << " p90:" << diff.GetPercentile(90)
+                   << " p99:" << diff.GetPercentile(99)
+                   << " p999:" << diff.GetPercentile(99.9);
+        // The counts since the start, merged by the reports to compute the
+        // percentiles of a whole run.
+        LOG(ERROR) << "  " << PrometheusHandler::GetLatencyName(name)
+                   << " latency buckets(us) num:" << latency.count
+                   << " sum:" << latency.sum << " " << latency.GetBuckets();
+      }
+      last_latency[i] = std::move(latency);
+    }
+    MonitorQueues(&queue_monitors);
 
     last_seq_fail = seq_fail;
     last_socket_recv = socket_recv;
@@ -288,6 +322,11 @@ void Stats::IncTotalGeoRequest(uint32_t num) { total_geo_request_ += num; }
 
 void Stats::IncGeoRequest() { geo_request_++; }
 
+void Stats::SetGeoRegionLag(int region_id, uint64_t lag) {
+  std::lock_guard<std::mutex> lk(geo_mutex_);
+  geo_region_lag_[region_id] = lag;
+}
+
 void Stats::ServerCall() {
   if (prometheus_) {
     prometheus_->Inc(SERVER_CALL_NAME, 1);
@@ -307,10 +346,88 @@ void Stats::SeqGap(uint64_t seq_gap) { seq_gap_ = seq_gap; }
 void Stats::AddLatency(uint64_t run_time) {
   run_req_num_++;
   run_req_run_time_ += run_time;
+  AddLatency(CLIENT_LATENCY, run_time);
 }
 
-void Stats::SetPrometheus(const std::string& prometheus_address) {
-  prometheus_ = std::make_unique<PrometheusHandler>(prometheus_address);
+void Stats::AddLatency(LatencyName name, uint64_t latency_us) {
+  if (prometheus_) {
+    prometheus_->Observe(name, latency_us);
+  }
+  latency_[name].Record(latency_us);
 }
 
+void Stats::MonitorQueues(std::map<std::string, QueueMonitor>* monitors) {
+  for (QueueMetrics* metrics : QueueMetrics::GetAll()) {
+    const std::string& name = metrics->GetName();
+    auto it = monitors->find(name);
+    if (it == monitors->end()) {
+      it = monitors->insert(std::make_pair(name, QueueMonitor())).first;
+      if (prometheus_) {
+        PrometheusHandler::Labels labels = {{"queue", name}};
+        QueueMonitor& monitor = it->second;
+        monitor.depth = prometheus_->RegisterGauge(
+            "queue_depth", "items in the queue", labels);
+        monitor.max_depth = prometheus_->RegisterGauge(
+            "queue_max_depth", "max items in the queue in the last interval",
+            labels);
+        monitor.push = prometheus_->RegisterCounter(
+            "queue_push_total", "items pushed to the queue", labels);
+        monitor.pop = prometheus_->RegisterCounter(
+            "queue_pop_total", "items popped from the queue", labels);
+        monitor.full = prometheus_->RegisterCounter(
+            "queue_full_total", "pushes waiting for room in the queue",
+            labels);
+        monitor.wait_p50 = prometheus_->RegisterGauge(
+            "queue_wait_p50_seconds",
+            "median time in the queue in the last interval", labels);
+        monitor.wait_p99 = prometheus_->RegisterGauge(
+            "queue_wait_p99_seconds",
+            "p99 time in the queue in the last interval", labels);
+      }
+    }
+    QueueMonitor& monitor = it->second;
+
+    int64_t depth = metrics->GetDepth();
+    int64_t max_depth = metrics->GetMaxDepth();
+    uint64_t push_num = metrics->GetPushNum();
+    uint64_t pop_num = metrics->GetPopNum();
+    uint64_t full_num = metrics->GetFullNum();
+    LatencyHistogram::Snapshot wait_time = metrics->GetWaitTime();
+    LatencyHistogram::Snapshot diff = wait_time - monitor.wait_time;
+    if (push_num != monitor.push_num || depth > 0) {
+      LOG(ERROR) << "  queue " << name << " depth:" << depth
+                 << " max depth:" << max_depth
+                 << " push:" << push_num - monitor.push_num
+                 << " pop:" << pop_num - monitor.pop_num
+                 << " full:" << full_num - monitor.full_num
+                 << " wait(us) p50:" << diff.GetPercentile(50)
+                 << " p99:" << diff.GetPercentile(99);
+    }
+    if (monitor.depth) {
+      monitor.depth->Set(depth);
+      monitor.max_depth->Set(max_depth);
+      monitor.push->Increment(push_num - monitor.push_num);
+      monitor.pop->Increment(pop_num - monitor.pop_num);
+      monitor.full->Increment(full_num - monitor.full_num);
+      monitor.wait_p50->Set(diff.GetPercentile(50) / 1000000.0);
+      monitor.wait_p99->Set(diff.GetPercentile(99) / 1000000.0);
+    }
+    monitor.push_num = push_num;
+    monitor.pop_num = pop_num;
+    monitor.full_num = full_num;
+    monitor.wait_time = std::move(wait_time);
+  }
+}
+
+LatencyHistogram::Snapshot Stats::GetLatency(LatencyName name) const {
+  return latency_[name].GetSnapshot();
+}
+
+void Stats::SetPrometheus(const std::string& prometheus_address,
+                          const PrometheusHandler::Labels& labels) {
+  prometheus_ = std::make_unique<PrometheusHandler>(prometheus_address, labels);
+}
+
+PrometheusHandler* Stats::GetPrometheus() { return prometheus_.get(); }
+
 }  // namespace resdb
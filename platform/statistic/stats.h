@@ -27,7 +27,10 @@
 
 #include <chrono>
 #include <future>
+#include <map>
 
+#include "platform/common/queue/queue_metrics.h"
+#include "platform/statistic/latency_histogram.h"
 #include "platform/statistic/prometheus_handler.h"
 
 namespace resdb {
@@ -39,6 +42,9 @@ class Stats {
   void Stop();
 
   void AddLatency(uint64_t run_time);
+  // Record a latency in microseconds, reported as percentiles.
+  void AddLatency(LatencyName name, uint64_t latency_us);
+  LatencyHistogram::Snapshot GetLatency(LatencyName name) const;
 
   void Monitor();
   void MonitorGlobal();
@@ -62,17 +68,35 @@ class Stats {
   void IncTotalRequest(uint32_t num);
   void IncTotalGeoRequest(uint32_t num);
   void IncGeoRequest();
+  // How many seqs the region falls behind the fastest region.
+  void SetGeoRegionLag(int region_id, uint64_t lag);
 
   void SeqGap(uint64_t seq_gap);
   // Network in->worker
   void ServerCall();
   void ServerProcess();
-  void SetPrometheus(const std::string& prometheus_address);
+  // The labels are added to every metric, like the id of the replica.
+  void SetPrometheus(const std::string& prometheus_address,
+                     const PrometheusHandler::Labels& labels = {});
+  // Return nullptr if Prometheus is not enabled. Subsystems register their
+  // own metrics through it.
+  PrometheusHandler* GetPrometheus();
 
  protected:
   Stats(int sleep_time = 5);
   ~Stats();
 
+ private:
+  // The values of a queue at the last report and its exported metrics.
+  struct QueueMonitor {
+    uint64_t push_num = 0, pop_num = 0, full_num = 0;
+    LatencyHistogram::Snapshot wait_time;
+    prometheus::Gauge *depth = nullptr, *max_depth = nullptr;
+    prometheus::Gauge *wait_p50 = nullptr, *wait_p99 = nullptr;
+    prometheus::Counter *push = nullptr, *pop = nullptr, *full = nullptr;
+  };
+  void MonitorQueues(std::map<std::string, QueueMonitor>* monitors);
+
  private:
   std::string monitor_port_ = "default";
   std::string name_;
@@ -96,6 +120,9 @@ class Stats {
   std::atomic<uint64_t> run_req_run_time_;
   std::atomic<uint64_t> seq_gap_;
   std::atomic<uint64_t> total_request_, total_geo_request_, geo_request_;
+  std::mutex geo_mutex_;
+  std::map<int, uint64_t> geo_region_lag_;
+  LatencyHistogram latency_[NUM_OF_LATENCY];
   int monitor_sleep_time_ = 5;  // default 5s.
 
   std::unique_ptr<PrometheusHandler> prometheus_;
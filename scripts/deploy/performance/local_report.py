@@ -0,0 +1,166 @@
+import argparse
+import json
+import re
+import sys
+
+# The monitor log prints "latency(us)" lines for each phase, like
+#   client latency(us) num:10 mean:20 p50:18 p90:30 p99:40 p999:41
+LATENCY_RE = re.compile(
+    r"(\w+) latency\(us\) num:(\d+) mean:(\S+) p50:(\S+) p90:(\S+)"
+    r" p99:(\S+) p999:(\S+)")
+PERCENTILES = ["mean", "p50", "p90", "p99", "p999"]
+# It also prints the buckets counted since the start, like
+#   client latency buckets(us) num:10 sum:200 18:5 30:4 41:1
+# where each bucket is the highest value in it and the number of values.
+BUCKETS_RE = re.compile(
+    r"(\w+) latency buckets\(us\) num:(\d+) sum:(\d+)((?: \d+:\d+)*)")
+# The open-loop proxy prints a line for each rate, and one per step time for
+# the last rate, like
+#   load step rate:1000 offered:999 throughput:998 mean(us):20 p50(us):18 ...
+LOAD_STEP_RE = re.compile(
+    r"load step rate:(\d+) offered:(\S+) throughput:(\S+) mean\(us\):(\S+)"
+    r" p50\(us\):(\S+) p90\(us\):(\S+) p99\(us\):(\S+) p999\(us\):(\S+)")
+
+
+def read_log(file):
+    tps = []
+    latency = {}
+    buckets = {}
+    steps = []
+    with open(file, errors="ignore") as f:
+        for l in f.readlines():
+            for r in l.split():
+                if r.split(':')[0] == 'txn':
+                    tps.append(int(r.split(':')[1]))
+            m = LOAD_STEP_RE.search(l)
+            if m:
+                step = {"rate": int(m.group(1)),
+                        "offered": float(m.group(2)),
+                        "throughput": float(m.group(3))}
+                for i, name in enumerate(PERCENTILES):
+                    step[name + "_us"] = float(m.group(4 + i))
+                steps.append(step)
+                continue
+            m = BUCKETS_RE.search(l)
+            if m:
+                # The buckets are cumulative, so the last line has them all.
+                counts = {}
+                for b in m.group(4).split():
+                    value, count = b.split(':')
+                    counts[int(value)] = int(count)
+                buckets[m.group(1)] = (int(m.group(3)), counts)
+                continue
+            m = LATENCY_RE.search(l)
+            if m:
+                values = [float(v) for v in m.groups()[2:]]
+                latency.setdefault(m.group(1), []).append(
+                    (int(m.group(2)), values))
+    return tps, latency, buckets, steps
+
+
+def cal_tps(tps):
+    # Skip the intervals before the load starts and after it stops.
+    tps = [v for v in tps if v > 0]
+    if not tps:
+        return {"max": 0, "mean": 0}
+    return {"max": max(tps), "mean": sum(tps) / len(tps)}
+
+
+def merge_buckets(merged, buckets):
+    total, counts = merged
+    for value, count in buckets[1].items():
+        counts[value] = counts.get(value, 0) + count
+    return (total + buckets[0], counts)
+
+
+def get_percentile(counts, num, percentile):
+    # The same rank as LatencyHistogram::Snapshot::GetPercentile.
+    rank = max(int(percentile / 100 * num + 0.5), 1)
+    total = 0
+    for value in sorted(counts):
+        total += counts[value]
+        if total >= rank:
+            return value
+    return max(counts)
+
+
+def cal_latency(buckets, intervals):
+    # The percentiles of the run come from the buckets merged across the
+    # processes. Percentiles of the intervals cannot be combined.
+    total, counts = buckets
+    num = sum(counts.values())
+    result = {"num": num, "mean": total / num}
+    for name, percentile in [("p50", 50), ("p90", 90), ("p99", 99),
+                             ("p999", 99.9)]:
+        result[name] = get_percentile(counts, num, percentile)
+    if intervals:
+        result["max_p99"] = max(
+            v[PERCENTILES.index("p99")] for _, v in intervals)
+    return result
+
+
+def cal_resource(file, clock_ticks):
+    samples = {}
+    with open(file) as f:
+        for l in f.readlines():
+            s = l.split()
+            if len(s) != 4:
+                continue
+            samples.setdefault(int(s[1]), []).append(
+                (int(s[0]), int(s[2]), int(s[3])))
+
+    nodes = {}
+    for node, values in sorted(samples.items()):
+        first, last = values[0], values[-1]
+        run_time = last[0] - first[0]
+        cpu = 0
+        if run_time > 0:
+            cpu = 100.0 * (last[1] - first[1]) / clock_ticks / run_time
+        rss = [v[2] for v in values]
+        nodes[str(node)] = {
+            "cpu_percent": cpu,
+            "max_rss_mb": max(rss) / 1024.0,
+            "mean_rss_mb": sum(rss) / len(rss) / 1024.0,
+        }
+    return nodes
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(
+        description="summarize the logs of run_local_performance.sh")
+    parser.add_argument("--protocol", default="pbft")
+    parser.add_argument("--replica_num", type=int, default=4)
+    parser.add_argument("--clock_ticks", type=int, default=100)
+    parser.add_argument("--resource", help="the cpu and rss samples")
+    parser.add_argument("logs", nargs="+")
+    args = parser.parse_args()
+
+    tps = []
+    latency = {}
+    buckets = {}
+    steps = []
+    for f in args.logs:
+        t, l, b, s = read_log(f)
+        tps += t
+        steps += s
+        for name, intervals in l.items():
+            latency.setdefault(name, []).extend(intervals)
+        for name, value in b.items():
+            buckets[name] = merge_buckets(buckets.get(name, (0, {})), value)
+
+    report = {
+        "protocol": args.protocol,
+        "replica_num": args.replica_num,
+        "throughput": cal_tps(tps),
+        "latency_us": {
+            name: cal_latency(value, latency.get(name, []))
+            for name, value in buckets.items() if value[1]
+        },
+    }
+    if steps:
+        report["load_curve"] = steps
+    if args.resource:
+        report["resource"] = cal_resource(args.resource, args.clock_ticks)
+
+    json.dump(report, sys.stdout, indent=2)
+    print()
@@ -0,0 +1,172 @@
+#!/bin/bash
+#
+# Run the KV performance benchmark with all the replicas on this machine.
+#
+# usage: ./performance/run_local_performance.sh [-p pbft|poe] [-n replica_num]
+#            [-t seconds] [-c txn_num] [-w workload] [-o report]
+#            [-r rates] [-s seconds] [-a]
+#
+#  -p  the protocol, pbft by default.
+#  -n  the number of replicas, 4 by default. One more node runs as the proxy.
+#  -t  stop after the seconds, 60 by default.
+#  -c  stop earlier once the primary has executed the transactions.
+#  -w  the KVWorkloadConfig json, like
+#      benchmark/workload/workloads/workloada.json. Half reads and half
+#      updates of 1000 records by default.
+#  -o  the json report, local_result/report.json by default.
+#  -r  issue the requests open loop at the comma separated rates (requests/s)
+#      in turn, like 1000,2000,4000. The closed loop by default.
+#  -s  the seconds to hold each rate but the last one, 30 by default.
+#  -a  use Poisson arrivals instead of constant ones.
+
+protocol=pbft
+replica_num=4
+duration=60
+txn_num=0
+workload=
+report=
+rates=
+step_time=0
+poisson=false
+
+while getopts "p:n:t:c:w:o:r:s:a" opt; do
+  case $opt in
+    p) protocol=$OPTARG ;;
+    n) replica_num=$OPTARG ;;
+    t) duration=$OPTARG ;;
+    c) txn_num=$OPTARG ;;
+    w) workload=`realpath $OPTARG` ;;
+    o) report=$OPTARG ;;
+    r) rates=$OPTARG ;;
+    s) step_time=$OPTARG ;;
+    a) poisson=true ;;
+    *) echo "usage: $0 [-p pbft|poe] [-n replica_num] [-t seconds] [-c txn_num] [-w workload] [-o report] [-r rates] [-s seconds] [-a]"
+       exit 1 ;;
+  esac
+done
+
+case $protocol in
+  pbft) server=//benchmark/protocols/pbft:kv_server_performance ;;
+  poe) server=//benchmark/protocols/poe:kv_server_performance ;;
+  *) echo "unknown protocol:"$protocol; exit 1 ;;
+esac
+client_tools=//benchmark/protocols/pbft:kv_service_tools
+
+# load environment parameters
+. ./script/env.sh
+
+script_path=${BAZEL_WORKSPACE_PATH}/scripts
+output_path=${script_path}/deploy/local_out
+output_key_path=${output_path}/cert
+admin_key_path=${script_path}/deploy/data/cert
+result_path=${script_path}/deploy/local_result
+if [[ -z $report ]]; then
+  report=${result_path}/report.json
+fi
+
+server_path=`echo "$server" | sed 's/:/\//g'`
+server_bin=${BAZEL_WORKSPACE_PATH}/bazel-bin/${server_path:2}
+client_path=`echo "$client_tools" | sed 's/:/\//g'`
+client_bin=${BAZEL_WORKSPACE_PATH}/bazel-bin/${client_path:2}
+
+# The replicas and the proxy all listen on the local host.
+node_num=$((${replica_num}+1))
+iplist=()
+for _ in `seq 1 ${node_num}`; do
+  iplist+=(127.0.0.1)
+done
+
+echo "protocol:"${protocol}" replicas:"${replica_num}" duration:"${duration}"s txn:"${txn_num}
+
+bazel build ${server} ${client_tools}
+if [ $? != 0 ]; then
+  echo "Complile ${server} failed"
+  exit 1
+fi
+
+rm -rf ${output_path} ${result_path}
+mkdir -p ${output_path} ${result_path}
+
+cd ${script_path}
+deploy/script/generate_key.sh ${BAZEL_WORKSPACE_PATH} ${output_key_path} ${node_num}
+deploy/script/generate_config.sh ${BAZEL_WORKSPACE_PATH} ${output_key_path} ${output_key_path} ${output_path} ${admin_key_path} ${iplist[@]}
+
+if [[ -n $rates ]]; then
+  python3 - ${output_path}/server.config ${rates} ${step_time} ${poisson} <<'EOF'
+import json, sys
+config = json.load(open(sys.argv[1]))
+config["load_rates"] = [int(r) for r in sys.argv[2].split(",")]
+config["load_step_time_s"] = int(sys.argv[3])
+config["load_poisson_arrival"] = sys.argv[4] == "true"
+json.dump(config, open(sys.argv[1], "w"), indent=2)
+EOF
+fi
+
+# Start the replicas and the proxy.
+cd ${output_path}
+pids=()
+for idx in `seq 1 ${node_num}`; do
+  ${server_bin} server.config cert/node_${idx}.key.pri cert/cert_${idx}.cert "" ${workload} > ${result_path}/node_${idx}.log 2>&1 &
+  pids+=($!)
+done
+
+function stop_nodes(){
+  kill -9 ${pids[@]} > /dev/null 2>&1
+  wait > /dev/null 2>&1
+}
+trap "stop_nodes; exit 1" INT TERM
+
+# Wait until every node has received the keys of the others.
+for idx in `seq 1 ${node_num}`; do
+  wait_time=0
+  while ! grep -q "receive public size:${node_num}" ${result_path}/node_${idx}.log; do
+    if [ $wait_time -ge 60 ]; then
+      echo "node "${idx}" is not ready, see "${result_path}/node_${idx}.log
+      stop_nodes
+      exit 1
+    fi
+    sleep 1
+    wait_time=$(($wait_time+1))
+  done
+done
+echo "Servers are running....."
+
+${client_bin} ${output_path}/client.config
+
+# Sample the cpu ticks and the rss of each node every second.
+resource_file=${result_path}/resource.log
+start_time=`date +%s`
+while true; do
+  now=`date +%s`
+  idx=1
+  for pid in ${pids[@]}; do
+    if [ -f /proc/${pid}/stat ]; then
+      ticks=`awk '{print $14+$15}' /proc/${pid}/stat`
+      rss=`awk '/VmRSS/ {print $2}' /proc/${pid}/status`
+      echo "${now} ${idx} ${ticks} ${rss}" >> ${resource_file}
+    fi
+    idx=$(($idx+1))
+  done
+
+  if [ $(($now-$start_time)) -ge ${duration} ]; then
+    break
+  fi
+  if [ ${txn_num} -gt 0 ]; then
+    done_num=`grep -o "total request:[0-9]*" ${result_path}/node_1.log | awk -F':' '{s+=$2} END {print s+0}'`
+    if [ ${done_num} -ge ${txn_num} ]; then
+      break
+    fi
+  fi
+  sleep 1
+done
+
+echo "benchmark done"
+stop_nodes
+
+python3 ${script_path}/deploy/performance/local_report.py \
+  --protocol ${protocol} --replica_num ${replica_num} \
+  --clock_ticks `getconf CLK_TCK` --resource ${resource_file} \
+  ${result_path}/node_*.log > ${report}
+
+echo "save result to "${report}
+cat ${report}
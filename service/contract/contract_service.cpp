@@ -59,13 +59,15 @@ int main(int argc, char** argv) {
     logging_dir = argv[5];
   }
 
+  std::unique_ptr<ResDBConfig> config =
+      GenerateResDBConfig(config_file, private_key_file, cert_file);
+
   if (argc >= 6) {
     auto monitor_port = Stats::GetGlobalStats(5);
-    monitor_port->SetPrometheus(argv[4]);
+    monitor_port->SetPrometheus(
+        argv[4], {{"replica", std::to_string(config->GetSelfInfo().id())}});
   }
 
-  std::unique_ptr<ResDBConfig> config =
-      GenerateResDBConfig(config_file, private_key_file, cert_file);
   ResConfigData config_data = config->GetConfigData();
 
   auto server = CustomGenerateResDBServer<ConsensusManagerPBFT>(
@@ -40,7 +40,7 @@
 using namespace resdb;
 
 void ShowUsage() {
-  printf("<config> <private_key> <cert_file> [logging_dir]\n");
+  printf("<config> <private_key> <cert_file> [monitor_port]\n");
 }
 
 std::unique_ptr<ChainState> NewState(const std::string& cert_file,
@@ -70,25 +70,24 @@ int main(int argc, char** argv) {
   char* config_file = argv[1];
   char* private_key_file = argv[2];
   char* cert_file = argv[3];
-  char* logging_dir = nullptr;
 
-  if (argc >= 6) {
-    logging_dir = argv[5];
-  }
+  std::unique_ptr<ResDBConfig> config =
+      GenerateResDBConfig(config_file, private_key_file, cert_file);
 
   if (argc >= 5) {
     auto monitor_port = Stats::GetGlobalStats(5);
-    monitor_port->SetPrometheus(argv[4]);
+    monitor_port->SetPrometheus(
+        argv[4], {{"replica", std::to_string(config->GetSelfInfo().id())}});
     LOG(ERROR) << "prot:" << argv[4];
   }
 
-  std::unique_ptr<ResDBConfig> config =
-      GenerateResDBConfig(config_file, private_key_file, cert_file);
   ResConfigData config_data = config->GetConfigData();
 
-  auto server = GenerateResDBServer(
+  std::unique_ptr<ChainState> state = NewState(cert_file, config_data);
+  ChainState* state_ptr = state.get();
+  auto server = CustomGenerateResDBServer<ConsensusManagerPBFT>(
       config_file, private_key_file, cert_file,
-      std::make_unique<KVExecutor>(NewState(cert_file, config_data)),
-      logging_dir);
+      std::make_unique<KVExecutor>(std::move(state)),
+      std::make_unique<KVQuery>(state_ptr));
   server->Run();
 }
@@ -43,7 +43,7 @@ using resdb::ResDBConfig;
 int main(int argc, char** argv) {
   if (argc < 3) {
     printf(
-        "<config path> <cmd>(set/get/getvalues/getrange), [key] "
+        "<config path> <cmd>(set/get/readonlyget/getvalues/getrange), [key] "
         "[value/key2]\n");
     return 0;
   }
@@ -79,6 +79,14 @@ int main(int argc, char** argv) {
     } else {
       printf("client get value fail\n");
     }
+  } else if (cmd == "readonlyget") {
+    auto res = client.ReadOnlyGet(key);
+    if (res != nullptr) {
+      printf("client readonlyget value = %s seq = %lu\n", res->c_str(),
+             client.GetLastReadSeq());
+    } else {
+      printf("client readonlyget value fail\n");
+    }
   } else if (cmd == "getvalues") {
     auto res = client.GetValues();
     if (res != nullptr) {
@@ -77,15 +77,17 @@ int main(int argc, char** argv) {
 
   char* utxo_config_file = argv[4];
 
-  if (argc >= 6) {
-    auto monitor_port = Stats::GetGlobalStats(5);
-    monitor_port->SetPrometheus(argv[5]);
-  }
-
   resdb::utxo::Config utxo_config = ReadConfigFromFile(utxo_config_file);
 
   std::unique_ptr<ResDBConfig> config =
       GenerateResDBConfig(config_file, private_key_file, cert_file);
+
+  if (argc >= 6) {
+    auto monitor_port = Stats::GetGlobalStats(5);
+    monitor_port->SetPrometheus(
+        argv[5], {{"replica", std::to_string(config->GetSelfInfo().id())}});
+  }
+
   ResConfigData config_data = config->GetConfigData();
 
   std::unique_ptr<Wallet> wallet = std::make_unique<Wallet>();